@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib> // std::strtoull
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SyntheticProfiles.hpp"
+#include "domain/ProfileFormatter.hpp"
+#include "domain/StringPool.hpp"
+#include "persistence/CompressedSnapshot.hpp"
+#include "persistence/DeltaSegments.hpp"
+#include "persistence/IndexedSnapshot.hpp"
+#include "persistence/ProfileSerializer.hpp"
+#include "persistence/TextScan.hpp"
+#include "service/ConcurrentProfileStore.hpp"
+#include "service/ProfileStore.hpp"
+#include "util/ThreadPool.hpp"
+
+// ProfileManagerBench: times the store, serializer and formatting hot paths on synthetic data
+// and prints one JSON document, so results can be diffed or tracked per commit.
+
+namespace
+{
+    struct BenchResult
+    {
+        std::string name;
+        std::size_t ops = 0;
+        double seconds = 0.0;
+        std::size_t bytes = 0; // bytes moved, for I/O benchmarks (0 = not applicable)
+    };
+
+    struct BenchOptions
+    {
+        SyntheticConfig data;
+        unsigned repeat = 3; // each benchmark keeps its best run
+        std::string dir = std::filesystem::temp_directory_path().string();
+        std::string out;     // empty = stdout
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Benchmarks fold their results into this, so the optimiser cannot drop the measured work
+    volatile std::size_t bench_sink = 0;
+
+    // Arena usage after the arena-mode binary load (reported next to the results)
+    ArenaStats arena_after_load;
+
+    double seconds_since(Clock::time_point started)
+    {
+        return std::chrono::duration<double>(Clock::now() - started).count();
+    }
+
+    // Keeps the best (fastest) run of every benchmark, in first-seen order
+    void record(std::vector<BenchResult>& results, const BenchResult& run)
+    {
+        for (BenchResult& existing : results)
+        {
+            if (existing.name == run.name)
+            {
+                if (run.seconds < existing.seconds) existing = run;
+                return;
+            }
+        }
+        results.push_back(run);
+    }
+
+    std::size_t file_size(const std::string& path)
+    {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : static_cast<std::size_t>(size);
+    }
+
+    // One full pass over every benchmark. Order matters: later steps reuse the store built by create.
+    void run_suite(const SyntheticData& data, const BenchOptions& options, std::vector<BenchResult>& results)
+    {
+        const std::size_t n = data.specs().size();
+        const std::string text_path = options.dir + "/pmbench.txt";
+        const std::string binary_path = options.dir + "/pmbench.pmb";
+        const std::string compressed_path = options.dir + "/pmbench.pmz";
+        std::size_t sink = 0;
+
+        ProfileStore store;
+
+        // create_profile (+ add_hobby for each generated hobby)
+        {
+            const auto started = Clock::now();
+            data.fill(store);
+            record(results, {"store.create_profile", n, seconds_since(started), 0});
+        }
+
+        // find: random hits over the whole id range
+        {
+            std::vector<int> ids(n);
+            std::mt19937_64 rng(options.data.seed);
+            for (int& id : ids) id = static_cast<int>(rng() % (n == 0 ? 1 : n)) + 1;
+
+            const auto started = Clock::now();
+            for (int id : ids) sink += store.find(id) != nullptr;
+            record(results, {"store.find", n, seconds_since(started), 0});
+        }
+
+        // Hobby churn: drop each profile's first hobby and add it back (membership check, ordered
+        // erase, index update). Try --hobbies 200 to see the large-list path.
+        {
+            std::vector<int> ids = store.list_ids();
+            const auto started = Clock::now();
+            for (int id : ids)
+            {
+                Profile* p = store.find(id);
+                if (p->hobbies().empty()) continue;
+                const std::string hobby = p->hobbies()[0];
+                sink += p->remove_hobby(hobby);
+                sink += p->add_hobby(hobby);
+            }
+            record(results, {"profile.hobby_churn", n, seconds_since(started), 0});
+        }
+
+        // list_ids: one walk over the incrementally kept SortedIdIndex into a fresh vector (no sort),
+        // repeated so small stores still give a measurable time
+        {
+            const std::size_t rounds = 10;
+            const auto started = Clock::now();
+            for (std::size_t r = 0; r < rounds; ++r) sink += store.list_ids().size();
+            record(results, {"store.list_ids", rounds, seconds_since(started), 0});
+        }
+
+        // to_string for every profile
+        {
+            std::size_t bytes = 0;
+            const auto started = Clock::now();
+            store.for_each([&](const Profile& p) { bytes += p.to_string().size(); });
+            record(results, {"profile.to_string", n, seconds_since(started), bytes});
+        }
+
+        // The same three renderings into one reused buffer (no allocation after the first few profiles)
+        {
+            std::string buffer;
+            const struct
+            {
+                const char* name;
+                void (*render)(std::string&, const Profile&);
+            } renderers[] = {
+                {"formatter.text", ProfileFormatter::append_text},
+                {"formatter.json", ProfileFormatter::append_json},
+                {"formatter.csv", ProfileFormatter::append_csv},
+            };
+            for (const auto& renderer : renderers)
+            {
+                std::size_t bytes = 0;
+                const auto started = Clock::now();
+                store.for_each([&](const Profile& p)
+                {
+                    buffer.clear();
+                    renderer.render(buffer, p);
+                    bytes += buffer.size();
+                });
+                record(results, {renderer.name, n, seconds_since(started), bytes});
+            }
+        }
+
+        // Full-store scans in both storage layouts
+        for (StorageLayout layout : {StorageLayout::Rows, StorageLayout::Columnar})
+        {
+            store.set_layout(layout);
+            const std::size_t rounds = 20;
+            const auto started = Clock::now();
+            for (std::size_t r = 0; r < rounds; ++r) sink += store.scan_count_age_between(18, 40);
+            const char* name = layout == StorageLayout::Rows ? "store.scan_rows" : "store.scan_columnar";
+            record(results, {name, rounds * n, seconds_since(started), 0});
+        }
+        store.set_layout(StorageLayout::Rows);
+
+        // Filtered queries (age range + country) on the thread pool, then sequentially for comparison
+        {
+            ProfileQuery query;
+            query.min_age = 18;
+            query.max_age = 40;
+            query.country = data.specs().empty() ? std::string() : *data.specs().front().country;
+            for (unsigned threads : {0u, 1u})
+            {
+                const auto started = Clock::now();
+                sink += store.query_count(query, threads);
+                sink += store.query_ids(query, threads).size();
+                record(results, {threads == 1 ? "query.sequential" : "query.parallel", 2 * n, seconds_since(started), 0});
+            }
+        }
+
+        // Name search: top-10 searches for name parts (a prefix, an inner piece) and a misspelled name.
+        // The trigram index was filled along with the other indexes while the profiles were created.
+        {
+            std::vector<std::string> queries;
+            std::mt19937_64 rng(options.data.seed);
+            for (std::size_t q = 0; q < 100 && n > 0; ++q)
+            {
+                std::string name = data.specs()[rng() % n].name;
+                if (q % 3 == 0) name = name.substr(0, 4);
+                else if (q % 3 == 1 && name.size() > 5) name = name.substr(2, 4);
+                else if (name.size() > 3) name[name.size() / 2] = 'x';
+                queries.push_back(name);
+            }
+
+            const auto started = Clock::now();
+            for (const std::string& query : queries) sink += store.search_names(query, 10).size();
+            record(results, {"names.search", queries.size(), seconds_since(started), 0});
+        }
+
+        // set_age on random profiles, with every index on: each edit moves the id between two age lists
+        {
+            const std::size_t edits = std::min<std::size_t>(n, 100000);
+            std::vector<int> ids(edits);
+            std::mt19937_64 rng(options.data.seed + 4);
+            for (int& id : ids) id = static_cast<int>(rng() % (n == 0 ? 1 : n)) + 1;
+
+            const auto started = Clock::now();
+            for (int id : ids) sink += store.find(id)->set_age(static_cast<int>(rng() % 100));
+            sink += store.count_by_age(18, 40); // folds the logged changes into the lists read
+            record(results, {"store.set_age", edits, seconds_since(started), 0});
+        }
+
+        // set_name on random profiles, with every index on (the store default): each rename takes the
+        // old name out of the trigram index and puts the new one in
+        {
+            const std::size_t renames = std::min<std::size_t>(n, 100000);
+            std::vector<int> ids(renames);
+            std::mt19937_64 rng(options.data.seed + 3);
+            for (int& id : ids) id = static_cast<int>(rng() % (n == 0 ? 1 : n)) + 1;
+
+            const auto started = Clock::now();
+            for (std::size_t i = 0; i < renames; ++i)
+            {
+                sink += store.find(ids[i])->set_name(data.specs()[(i * 7919) % n].name);
+            }
+            record(results, {"store.set_name", renames, seconds_since(started), 0});
+        }
+
+        // Snapshots
+        {
+            auto started = Clock::now();
+            ProfileSerializer::save(store, text_path, SnapshotFormat::Text);
+            record(results, {"serializer.save_text", n, seconds_since(started), file_size(text_path)});
+
+            started = Clock::now();
+            ProfileSerializer::save(store, binary_path, SnapshotFormat::Binary);
+            record(results, {"serializer.save_binary", n, seconds_since(started), file_size(binary_path)});
+
+            started = Clock::now();
+            ProfileSerializer::save(store, compressed_path, SnapshotFormat::Compressed);
+            record(results, {"serializer.save_compressed", n, seconds_since(started), file_size(compressed_path)});
+        }
+        {
+            ProfileStore loaded;
+            LoadStats stats;
+
+            ProfileSerializer::load(loaded, text_path, &stats);
+            record(results, {"serializer.load_text", stats.profiles, stats.seconds, stats.bytes});
+
+            ProfileSerializer::load_parallel(loaded, text_path, 0, &stats);
+            record(results, {"serializer.load_text_parallel", stats.profiles, stats.seconds, stats.bytes});
+
+            ProfileSerializer::load(loaded, binary_path, &stats);
+            record(results, {"serializer.load_binary", stats.profiles, stats.seconds, stats.bytes});
+
+            ProfileSerializer::load(loaded, compressed_path, &stats);
+            record(results, {"serializer.load_compressed", stats.profiles, stats.seconds, stats.bytes});
+
+            ProfileSerializer::load_parallel(loaded, compressed_path, 0, &stats);
+            record(results, {"serializer.load_compressed_parallel", stats.profiles, stats.seconds, stats.bytes});
+            sink += loaded.size();
+        }
+
+        // Lazy open: the first open scans the text snapshot and writes its id index, the second only maps
+        // and hashes it;
+        // then random finds, each parsing its record on first access
+        {
+            std::filesystem::remove(IndexedSnapshot::index_path(text_path));
+            for (const char* name : {"serializer.open_lazy_build_index", "serializer.open_lazy"})
+            {
+                ProfileStore lazy;
+                LoadStats stats;
+                ProfileSerializer::open_lazy(lazy, text_path, &stats);
+                record(results, {name, stats.profiles, stats.seconds, stats.bytes});
+                sink += lazy.size();
+            }
+
+            ProfileStore lazy;
+            ProfileSerializer::open_lazy(lazy, text_path);
+            std::vector<int> ids = store.list_ids();
+            std::shuffle(ids.begin(), ids.end(), std::mt19937_64(options.data.seed));
+            ids.resize(std::min<std::size_t>(ids.size(), 1000));
+
+            const auto started = Clock::now();
+            for (int id : ids) sink += lazy.find(id) != nullptr;
+            record(results, {"store.find_lazy_first_access", ids.size(), seconds_since(started), 0});
+        }
+
+        // Delta save: 1000 edits appended as one segment (the full save above rewrites all n records),
+        // then the merge that folds the segment back into the snapshot
+        {
+            ProfileStore edited;
+            ProfileSerializer::load(edited, text_path);
+            std::vector<int> ids = edited.list_ids();
+            std::shuffle(ids.begin(), ids.end(), std::mt19937_64(options.data.seed));
+            ids.resize(std::min<std::size_t>(ids.size(), 1000));
+            for (int id : ids) edited.find(id)->set_age(edited.find(id)->age() + 1);
+
+            DeltaStats stats;
+            auto started = Clock::now();
+            ProfileSerializer::save_delta(edited, text_path, &stats);
+            record(results, {"serializer.save_delta", stats.written + stats.deleted, seconds_since(started),
+                             file_size(DeltaSegments::path_for(text_path))});
+
+            started = Clock::now();
+            ProfileSerializer::merge(text_path);
+            record(results, {"serializer.merge_delta", n, seconds_since(started), file_size(text_path)});
+        }
+
+        // Single-profile lookups in the compressed snapshot (one block inflated per fetch)
+        {
+            CompressedSnapshot::Reader reader;
+            if (reader.open(compressed_path))
+            {
+                std::vector<int> ids = store.list_ids();
+                std::shuffle(ids.begin(), ids.end(), std::mt19937_64(options.data.seed));
+                ids.resize(std::min<std::size_t>(ids.size(), 1000));
+
+                StringPool strings;
+                const auto started = Clock::now();
+                for (int id : ids) sink += reader.fetch(id, strings).has_value();
+                record(results, {"serializer.fetch_compressed", ids.size(), seconds_since(started), 0});
+            }
+        }
+
+        // Allocation modes: the same binary load into a heap store and an arena store, then clear()
+        for (AllocationMode mode : {AllocationMode::Heap, AllocationMode::Arena})
+        {
+            const bool arena = mode == AllocationMode::Arena;
+            ProfileStore loaded;
+            loaded.set_allocation_mode(mode);
+            LoadStats stats;
+
+            ProfileSerializer::load(loaded, binary_path, &stats);
+            record(results, {arena ? "serializer.load_binary_arena" : "serializer.load_binary_heap",
+                             stats.profiles, stats.seconds, stats.bytes});
+            if (arena) arena_after_load = loaded.arena_stats();
+
+            const auto started = Clock::now();
+            loaded.clear();
+            record(results, {arena ? "store.clear_arena" : "store.clear_heap", stats.profiles, seconds_since(started), 0});
+        }
+
+        // remove every profile, in random order (indexes on, so each removal also unindexes the profile)
+        {
+            std::vector<int> ids = store.list_ids();
+            std::shuffle(ids.begin(), ids.end(), std::mt19937_64(options.data.seed));
+
+            const auto started = Clock::now();
+            for (int id : ids) sink += store.remove(id);
+            record(results, {"store.remove", ids.size(), seconds_since(started), 0});
+        }
+
+        std::filesystem::remove(text_path);
+        std::filesystem::remove(IndexedSnapshot::index_path(text_path));
+        std::filesystem::remove(binary_path);
+        std::filesystem::remove(compressed_path);
+        bench_sink = bench_sink + sink;
+    }
+
+    // Read throughput of ConcurrentProfileStore as reader threads are added, then the same with
+    // one writer updating profiles the whole time.
+    void run_concurrency(const SyntheticData& data, const BenchOptions& options, std::vector<BenchResult>& results)
+    {
+        const std::size_t n = data.specs().size();
+        if (n == 0) return;
+
+        ConcurrentProfileStore store;
+        for (const ProfileSpec& spec : data.specs())
+        {
+            const int id = store.create_profile(spec.name, spec.age, *spec.city, *spec.country);
+            store.update(id, [&](Profile& p) { for (const std::string* hobby : spec.hobbies) p.add_hobby(*hobby); });
+        }
+
+        const unsigned max_threads = std::max(4u, ThreadPool::resolve_thread_count(0));
+        for (int with_writer = 0; with_writer < 2; ++with_writer)
+        {
+            for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+            {
+                std::atomic<bool> readers_done{false};
+                std::thread writer;
+                if (with_writer)
+                {
+                    writer = std::thread([&]()
+                    {
+                        std::mt19937_64 rng(options.data.seed + 1);
+                        while (!readers_done.load(std::memory_order_relaxed))
+                        {
+                            const int id = static_cast<int>(rng() % n) + 1;
+                            store.update(id, [&](Profile& p) { p.set_age(static_cast<int>(rng() % 100)); });
+                        }
+                    });
+                }
+
+                std::vector<std::thread> readers;
+                std::vector<std::size_t> sums(threads, 0);
+                const auto started = Clock::now();
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    readers.emplace_back([&, t]()
+                    {
+                        std::mt19937_64 rng(options.data.seed + 100 + t);
+                        std::size_t sum = 0;
+                        for (std::size_t i = 0; i < n; ++i)
+                        {
+                            store.read(static_cast<int>(rng() % n) + 1, [&](const Profile& p) { sum += p.age(); });
+                        }
+                        sums[t] = sum;
+                    });
+                }
+                for (std::thread& reader : readers) reader.join();
+                const double seconds = seconds_since(started);
+
+                readers_done = true;
+                if (writer.joinable()) writer.join();
+
+                std::size_t sink = 0;
+                for (std::size_t sum : sums) sink += sum;
+                bench_sink = bench_sink + sink;
+
+                std::string name = "concurrent.read_t" + std::to_string(threads);
+                if (with_writer) name += "_with_writer";
+                record(results, {name, threads * n, seconds, 0});
+            }
+        }
+
+        // Snapshot save while a writer keeps updating (copy-on-write, the writer is not blocked)
+        {
+            const std::string path = options.dir + "/pmbench_snapshot.txt";
+            std::atomic<bool> saved{false};
+            std::thread writer([&]()
+            {
+                std::mt19937_64 rng(options.data.seed + 2);
+                while (!saved.load(std::memory_order_relaxed))
+                {
+                    const int id = static_cast<int>(rng() % n) + 1;
+                    store.update(id, [&](Profile& p) { p.set_age(static_cast<int>(rng() % 100)); });
+                }
+            });
+
+            const auto started = Clock::now();
+            ProfileSerializer::save(store, path, SnapshotFormat::Text);
+            const double seconds = seconds_since(started);
+            saved = true;
+            writer.join();
+
+            record(results, {"concurrent.save_snapshot_with_writer", n, seconds, file_size(path)});
+            std::filesystem::remove(path);
+        }
+    }
+
+    void write_json(std::ostream& out, const BenchOptions& options, const std::vector<BenchResult>& results)
+    {
+        const SyntheticConfig& c = options.data;
+        out << "{\n"
+            << "  \"benchmark\": \"ProfileManagerBench\",\n"
+            << "  \"config\": {"
+            << "\"profiles\": " << c.profiles
+            << ", \"hobbies_per_profile\": " << c.hobbies_per_profile
+            << ", \"hobby_cardinality\": " << c.hobby_cardinality
+            << ", \"city_cardinality\": " << c.city_cardinality
+            << ", \"country_cardinality\": " << c.country_cardinality
+            << ", \"name_length\": " << c.name_length
+            << ", \"text_length\": " << c.text_length
+            << ", \"escape_percent\": " << c.escape_percent
+            << ", \"seed\": " << c.seed
+            << ", \"repeat\": " << options.repeat
+            << ", \"threads\": " << ThreadPool::resolve_thread_count(0)
+            << ", \"text_scan\": \"" << text_scan::level_name(text_scan::active_level()) << "\"},\n"
+            << "  \"results\": [\n";
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult& r = results[i];
+            const double ns_per_op = r.ops ? r.seconds * 1e9 / r.ops : 0.0;
+            const double ops_per_sec = r.seconds > 0 ? r.ops / r.seconds : 0.0;
+
+            out << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+                << ", \"ns_per_op\": " << ns_per_op << ", \"ops_per_sec\": " << ops_per_sec;
+            if (r.bytes) out << ", \"bytes\": " << r.bytes << ", \"mb_per_sec\": " << (r.seconds > 0 ? r.bytes / r.seconds / 1e6 : 0.0);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n"
+            << "  \"arena\": {"
+            << "\"slabs\": " << arena_after_load.slabs
+            << ", \"reserved_bytes\": " << arena_after_load.reserved_bytes
+            << ", \"used_bytes\": " << arena_after_load.used_bytes
+            << ", \"allocations\": " << arena_after_load.allocations << "}\n"
+            << "}\n";
+    }
+
+    void print_usage()
+    {
+        std::cerr << "Usage: ProfileManagerBench [options]\n"
+                  << "  --profiles N           profiles to generate (default 100000)\n"
+                  << "  --hobbies N            average hobbies per profile (default 3)\n"
+                  << "  --hobby-cardinality N  distinct hobbies (default 500)\n"
+                  << "  --cities N             distinct cities (default 1000)\n"
+                  << "  --countries N          distinct countries (default 50)\n"
+                  << "  --name-length N        name length (default 12)\n"
+                  << "  --text-length N        city/country/hobby length (default 10)\n"
+                  << "  --escape-percent N     strings containing an escaped char, in % (default 1)\n"
+                  << "  --seed N               generator seed (default 42)\n"
+                  << "  --repeat N             runs per benchmark, best is reported (default 3)\n"
+                  << "  --text-scan LEVEL      force scalar|sse2|avx2 text kernels\n"
+                  << "  --dir PATH             where snapshot files are written (default: temp dir)\n"
+                  << "  --out FILE             write the JSON there instead of stdout\n";
+    }
+
+    bool parse_number(const char* text, std::uint64_t& value)
+    {
+        char* end = nullptr;
+        value = std::strtoull(text, &end, 10);
+        return end != text && *end == '\0';
+    }
+
+    bool parse_options(int argc, char* argv[], BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string flag = argv[i];
+            if (i + 1 >= argc) return false; // every option takes a value
+            const char* value = argv[++i];
+
+            if (flag == "--dir") { options.dir = value; continue; }
+            if (flag == "--out") { options.out = value; continue; }
+            if (flag == "--text-scan")
+            {
+                const std::string level = value;
+                if (level == "scalar") text_scan::set_level(text_scan::Level::Scalar);
+                else if (level == "sse2") text_scan::set_level(text_scan::Level::SSE2);
+                else if (level == "avx2") text_scan::set_level(text_scan::Level::AVX2);
+                else return false;
+                continue;
+            }
+
+            std::uint64_t number = 0;
+            if (!parse_number(value, number)) return false;
+            SyntheticConfig& c = options.data;
+            if (flag == "--profiles") c.profiles = number;
+            else if (flag == "--hobbies") c.hobbies_per_profile = number;
+            else if (flag == "--hobby-cardinality") c.hobby_cardinality = number;
+            else if (flag == "--cities") c.city_cardinality = number;
+            else if (flag == "--countries") c.country_cardinality = number;
+            else if (flag == "--name-length") c.name_length = number;
+            else if (flag == "--text-length") c.text_length = number;
+            else if (flag == "--escape-percent") c.escape_percent = static_cast<unsigned>(number);
+            else if (flag == "--seed") c.seed = number;
+            else if (flag == "--repeat") options.repeat = number == 0 ? 1 : static_cast<unsigned>(number);
+            else return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 2;
+    }
+
+    const SyntheticData data(options.data);
+    std::vector<BenchResult> results;
+    for (unsigned r = 0; r < options.repeat; ++r)
+    {
+        run_suite(data, options, results);
+        run_concurrency(data, options, results);
+    }
+
+    if (options.out.empty())
+    {
+        write_json(std::cout, options, results);
+        return 0;
+    }
+
+    std::ofstream out(options.out);
+    if (!out)
+    {
+        std::cerr << "Failed to open " << options.out << "\n";
+        return 1;
+    }
+    write_json(out, options, results);
+    return 0;
+}
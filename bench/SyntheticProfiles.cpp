@@ -0,0 +1,69 @@
+#include "SyntheticProfiles.hpp"
+
+#include <random>
+
+// SyntheticData: seeded generator for benchmark profiles
+
+namespace
+{
+    // Letters plus, with probability escape_percent, one of the bytes PMCLI1 has to escape
+    std::string random_text(std::mt19937_64& rng, std::size_t length, unsigned escape_percent)
+    {
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+        static const char specials[] = {'\\', '\t', '\n', '|'};
+
+        std::string text(length == 0 ? 1 : length, 'a');
+        for (char& ch : text) ch = letters[rng() % (sizeof(letters) - 1)];
+        if (rng() % 100 < escape_percent) text[rng() % text.size()] = specials[rng() % sizeof(specials)];
+        return text;
+    }
+
+    std::vector<std::string> vocabulary(std::mt19937_64& rng, std::size_t count, std::size_t length,
+                                        unsigned escape_percent)
+    {
+        std::vector<std::string> words;
+        words.reserve(count == 0 ? 1 : count);
+        for (std::size_t i = 0; i < (count == 0 ? 1 : count); ++i)
+        {
+            // Suffix the index so the vocabulary really has `count` distinct entries
+            words.push_back(random_text(rng, length, escape_percent) + std::to_string(i));
+        }
+        return words;
+    }
+}
+
+SyntheticData::SyntheticData(const SyntheticConfig& config)
+{
+    std::mt19937_64 rng(config.seed);
+    cities_ = vocabulary(rng, config.city_cardinality, config.text_length, config.escape_percent);
+    countries_ = vocabulary(rng, config.country_cardinality, config.text_length, config.escape_percent);
+    hobbies_ = vocabulary(rng, config.hobby_cardinality, config.text_length, config.escape_percent);
+
+    specs_.resize(config.profiles);
+    for (ProfileSpec& spec : specs_)
+    {
+        spec.name = random_text(rng, config.name_length, config.escape_percent);
+        spec.age = static_cast<int>(rng() % 100);
+        spec.city = &cities_[rng() % cities_.size()];
+        spec.country = &countries_[rng() % countries_.size()];
+
+        const std::size_t hobby_count = rng() % (2 * config.hobbies_per_profile + 1);
+        spec.hobbies.reserve(hobby_count);
+        for (std::size_t h = 0; h < hobby_count; ++h) spec.hobbies.push_back(&hobbies_[rng() % hobbies_.size()]);
+    }
+}
+
+const std::vector<ProfileSpec>& SyntheticData::specs() const
+{
+    return specs_;
+}
+
+void SyntheticData::fill(ProfileStore& store) const
+{
+    for (const ProfileSpec& spec : specs_)
+    {
+        const int id = store.create_profile(spec.name, spec.age, *spec.city, *spec.country);
+        Profile* p = store.find(id);
+        for (const std::string* hobby : spec.hobbies) p->add_hobby(*hobby);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef PROFILEMANAGERCLI_SYNTHETICPROFILES_HPP
+#define PROFILEMANAGERCLI_SYNTHETICPROFILES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "service/ProfileStore.hpp"
+
+// Knobs for the generated data set
+struct SyntheticConfig
+{
+    std::size_t profiles = 100000;
+    std::size_t hobbies_per_profile = 3;  // average; each profile gets 0..2x this many
+    std::size_t hobby_cardinality = 500;  // distinct hobbies
+    std::size_t city_cardinality = 1000;  // distinct cities
+    std::size_t country_cardinality = 50; // distinct countries
+    std::size_t name_length = 12;
+    std::size_t text_length = 10;         // length of city/country/hobby strings
+    unsigned escape_percent = 1;          // chance that a generated string contains a char the text format escapes
+    std::uint64_t seed = 42;
+};
+
+// One profile's worth of input for ProfileStore::create_profile + add_hobby
+struct ProfileSpec
+{
+    std::string name;
+    int age = 0;
+    const std::string* city = nullptr;    // points into SyntheticData's vocabularies
+    const std::string* country = nullptr;
+    std::vector<const std::string*> hobbies;
+};
+
+// Deterministic (seeded) profile data: fixed vocabularies for cities, countries and hobbies,
+// and one ProfileSpec per profile. Generated up front so benchmarks time only the code under test.
+class SyntheticData
+{
+private:
+    std::vector<std::string> cities_;
+    std::vector<std::string> countries_;
+    std::vector<std::string> hobbies_;
+    std::vector<ProfileSpec> specs_;
+
+public:
+    explicit SyntheticData(const SyntheticConfig& config);
+
+    // Non-copyable: specs point into the vocabularies
+    SyntheticData(const SyntheticData&) = delete;
+    SyntheticData& operator=(const SyntheticData&) = delete;
+
+    const std::vector<ProfileSpec>& specs() const;
+
+    // Creates every spec in `store` (ids 1..N on an empty store)
+    void fill(ProfileStore& store) const;
+};
+
+#endif //PROFILEMANAGERCLI_SYNTHETICPROFILES_HPP
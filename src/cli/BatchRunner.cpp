@@ -0,0 +1,268 @@
+#include "BatchRunner.hpp"
+#include "../persistence/ProfileSerializer.hpp"
+
+#include <algorithm> // std::find
+#include <charconv> // std::from_chars
+#include <chrono>
+#include <istream>
+#include <ostream>
+
+// BatchRunner: scripted commands without prompts (see BatchRunner.hpp for the language)
+
+namespace
+{
+    // Flush pending results once they reach this size
+    constexpr std::size_t flush_threshold = 1 << 16;
+
+    // Whole-word integer: "12" is fine, "12abc" or "" is not
+    bool parse_int(const std::string& word, int& value)
+    {
+        const char* first = word.data();
+        const char* last = first + word.size();
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        return ec == std::errc() && ptr == last && ptr != first;
+    }
+}
+
+BatchRunner::BatchRunner(ProfileStore& store) : store_(store){}
+
+BatchStats BatchRunner::run(std::istream& in, std::ostream& out)
+{
+    out_ = &out;
+    BatchStats stats;
+    const auto started = std::chrono::steady_clock::now();
+
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(in, line))
+    {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') line.pop_back(); // Windows CRLF fix
+
+        if (!tokenize(line))
+        {
+            ++stats.commands;
+            ++stats.failed;
+            fail(line_number, "unterminated quote");
+            continue;
+        }
+        if (words_.empty() || words_[0][0] == '#') continue; // blank line or comment
+
+        ++stats.commands;
+        if (!execute(line_number)) ++stats.failed;
+    }
+
+    flush_results();
+    out.flush();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    out_ = nullptr;
+    return stats;
+}
+
+// Splits `line` into words_. Returns false on an unterminated quote.
+bool BatchRunner::tokenize(const std::string& line)
+{
+    words_.clear();
+    std::size_t i = 0;
+    while (true)
+    {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        if (i >= line.size()) return true;
+
+        std::string word;
+        if (line[i] == '"')
+        {
+            // Quoted word: runs to the closing quote, \" and \\ are the only escapes
+            ++i;
+            while (true)
+            {
+                if (i >= line.size()) return false;
+                const char ch = line[i++];
+                if (ch == '"') break;
+                if (ch == '\\' && i < line.size() && (line[i] == '"' || line[i] == '\\')) word += line[i++];
+                else word += ch;
+            }
+        }
+        else
+        {
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t') word += line[i++];
+        }
+        words_.push_back(std::move(word));
+    }
+}
+
+bool BatchRunner::execute(std::size_t line_number)
+{
+    const std::string& command = words_[0];
+    if (command == "create") return create(line_number);
+    if (command == "update") return update(line_number);
+    if (command == "hobby") return hobby(line_number);
+    if (command == "delete") return remove(line_number);
+    if (command == "save") return save(line_number);
+    if (command == "load") return load(line_number);
+    if (command == "merge") return merge(line_number);
+    return fail(line_number, "unknown command");
+}
+
+bool BatchRunner::fail(std::size_t line_number, const char* message)
+{
+    emit("error line " + std::to_string(line_number) + ": " + message);
+    return false;
+}
+
+void BatchRunner::emit(const std::string& text)
+{
+    results_ += text;
+    results_ += '\n';
+    if (results_.size() >= flush_threshold) flush_results();
+}
+
+void BatchRunner::flush_results()
+{
+    if (results_.empty() || !out_) return;
+    out_->write(results_.data(), static_cast<std::streamsize>(results_.size()));
+    results_.clear();
+}
+
+bool BatchRunner::create(std::size_t line_number)
+{
+    // create <name> <age> <city> <country> [hobby...]
+    if (words_.size() < 5) return fail(line_number, "usage: create <name> <age> <city> <country> [hobby...]");
+
+    int age = 0;
+    if (!parse_int(words_[2], age)) return fail(line_number, "age is not a number");
+
+    // Checked up front, so a line that fails creates nothing (same rules as Profile::add_hobby)
+    const auto hobbies = words_.begin() + 5;
+    for (auto it = hobbies; it != words_.end(); ++it)
+    {
+        const bool repeated = store_.unique_hobbies() && std::find(hobbies, it, *it) != it;
+        if (it->empty() || repeated) return fail(line_number, "hobby not added (empty, or listed twice)");
+    }
+
+    const int id = store_.create_profile(words_[1], age, words_[3], words_[4]);
+    Profile* p = store_.find(id);
+    for (std::size_t i = 5; i < words_.size(); ++i) p->add_hobby(words_[i]);
+
+    emit("created " + std::to_string(id));
+    return true;
+}
+
+bool BatchRunner::update(std::size_t line_number)
+{
+    // update <id> <field> <value>
+    if (words_.size() != 4) return fail(line_number, "usage: update <id> <name|age|city|country> <value>");
+
+    int id = 0;
+    if (!parse_int(words_[1], id)) return fail(line_number, "id is not a number");
+    Profile* p = store_.find(id);
+    if (!p) return fail(line_number, "no such profile");
+
+    const std::string& field = words_[2];
+    const std::string& value = words_[3];
+    bool ok = false;
+    if (field == "name") ok = p->set_name(value);
+    else if (field == "city") ok = p->set_city(value);
+    else if (field == "country") ok = p->set_country(value);
+    else if (field == "age")
+    {
+        int age = 0;
+        if (!parse_int(value, age)) return fail(line_number, "age is not a number");
+        ok = p->set_age(age);
+    }
+    else return fail(line_number, "unknown field");
+
+    // Same validation as the interactive update (non-empty text, age 0...130)
+    if (!ok) return fail(line_number, "invalid value");
+    return true;
+}
+
+bool BatchRunner::hobby(std::size_t line_number)
+{
+    // hobby add|remove <id> <hobby>
+    if (words_.size() != 4 || (words_[1] != "add" && words_[1] != "remove"))
+    {
+        return fail(line_number, "usage: hobby add|remove <id> <hobby>");
+    }
+
+    int id = 0;
+    if (!parse_int(words_[2], id)) return fail(line_number, "id is not a number");
+    Profile* p = store_.find(id);
+    if (!p) return fail(line_number, "no such profile");
+
+    if (words_[1] == "add")
+    {
+        if (!p->add_hobby(words_[3])) return fail(line_number, "hobby not added (empty, or already present)");
+        return true;
+    }
+    if (!p->remove_hobby(words_[3])) return fail(line_number, "hobby not found");
+    return true;
+}
+
+bool BatchRunner::remove(std::size_t line_number)
+{
+    // delete <id>
+    if (words_.size() != 2) return fail(line_number, "usage: delete <id>");
+
+    int id = 0;
+    if (!parse_int(words_[1], id)) return fail(line_number, "id is not a number");
+    if (!store_.remove(id)) return fail(line_number, "no such profile");
+    return true;
+}
+
+bool BatchRunner::save(std::size_t line_number)
+{
+    // save <path> [text|binary|compressed|delta]
+    if (words_.size() != 2 && words_.size() != 3)
+    {
+        return fail(line_number, "usage: save <path> [text|binary|compressed|delta]");
+    }
+
+    if (words_.size() == 3 && words_[2] == "delta")
+    {
+        DeltaStats stats;
+        if (!ProfileSerializer::save_delta(store_, words_[1], &stats)) return fail(line_number, "save failed");
+        if (stats.full_save) emit("saved " + std::to_string(store_.size()) + " profiles to " + words_[1]);
+        else emit("saved changes to " + words_[1] + " (" + std::to_string(stats.written) + " written, " +
+                  std::to_string(stats.deleted) + " deleted)");
+        return true;
+    }
+
+    SnapshotFormat format = SnapshotFormat::Text;
+    if (words_.size() == 3)
+    {
+        if (words_[2] == "binary") format = SnapshotFormat::Binary;
+        else if (words_[2] == "compressed") format = SnapshotFormat::Compressed;
+        else if (words_[2] != "text") return fail(line_number, "format must be text, binary, compressed or delta");
+    }
+
+    if (!ProfileSerializer::save(store_, words_[1], format)) return fail(line_number, "save failed");
+    store_.mark_clean(words_[1]); // later delta saves to this file build on it
+    emit("saved " + std::to_string(store_.size()) + " profiles to " + words_[1]);
+    return true;
+}
+
+bool BatchRunner::merge(std::size_t line_number)
+{
+    // merge <path>
+    if (words_.size() != 2) return fail(line_number, "usage: merge <path>");
+
+    if (!ProfileSerializer::merge(words_[1])) return fail(line_number, "merge failed (missing file, invalid format or damaged delta)");
+    emit("merged " + words_[1] + ".delta into " + words_[1]);
+    return true;
+}
+
+bool BatchRunner::load(std::size_t line_number)
+{
+    // load <path>
+    if (words_.size() != 2) return fail(line_number, "usage: load <path>");
+
+    LoadStats stats;
+    if (!ProfileSerializer::load_parallel(store_, words_[1], 0, &stats))
+    {
+        return fail(line_number, "load failed (missing file or invalid format)");
+    }
+    emit("loaded " + std::to_string(stats.profiles) + " profiles from " + words_[1]);
+    if (stats.delta_ignored) emit("warning: " + words_[1] + ".delta is damaged and was not applied");
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef PROFILEMANAGERCLI_BATCHRUNNER_HPP
+#define PROFILEMANAGERCLI_BATCHRUNNER_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "../service/ProfileStore.hpp"
+
+// Throughput numbers for one batch run
+struct BatchStats
+{
+    std::size_t commands = 0; // non-blank, non-comment lines
+    std::size_t failed = 0;
+    double seconds = 0.0;
+
+    double commands_per_sec() const { return seconds > 0 ? commands / seconds : 0.0; }
+};
+
+// Non-interactive driver: executes one command per line, no prompts.
+// Words are separated by spaces or tabs; wrap text in double quotes to keep spaces
+// ("New York") and use \" or \\ inside quotes. Lines starting with '#' are comments.
+//
+//   create <name> <age> <city> <country> [hobby...]
+//   update <id> <name|age|city|country> <value>
+//   hobby add <id> <hobby>                      fails if empty, or already there with unique hobbies on
+//   hobby remove <id> <hobby>
+//   delete <id>
+//   save <path> [text|binary|compressed|delta]   delta: append only the changes since <path> was loaded/saved
+//   load <path>
+//   merge <path>                                 fold <path>.delta into <path>
+//
+// Results ("created 42", errors with their line number, ...) are collected in a buffer and written
+// to `out` in large chunks instead of one flush per command.
+class BatchRunner
+{
+public:
+    explicit BatchRunner(ProfileStore& store);
+
+    BatchStats run(std::istream& in, std::ostream& out);
+
+private:
+    ProfileStore& store_;
+    std::vector<std::string> words_; // current command, reused between lines
+    std::string results_;            // pending output
+    std::ostream* out_ = nullptr;
+
+    bool tokenize(const std::string& line);
+    bool execute(std::size_t line_number);
+    bool fail(std::size_t line_number, const char* message);
+    void emit(const std::string& text);
+    void flush_results();
+
+    // Commands (words_ holds the arguments)
+    bool create(std::size_t line_number);
+    bool update(std::size_t line_number);
+    bool hobby(std::size_t line_number);
+    bool remove(std::size_t line_number);
+    bool save(std::size_t line_number);
+    bool merge(std::size_t line_number);
+    bool load(std::size_t line_number);
+};
+
+#endif //PROFILEMANAGERCLI_BATCHRUNNER_HPP
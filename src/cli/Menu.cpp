@@ -2,6 +2,7 @@
 #include <iostream>
 #include <limits> // needed to discard input safely std::numeric_limits<std::streamsize>::max()
 #include "../persistence/ProfileSerializer.hpp"
+#include "ProfileListing.hpp"
 
 // Menu: input/output + command loop (no business logic)
 
@@ -21,6 +22,8 @@ void Menu::run()
                   << "7) Save to file\n"
                   << "8) Load from file\n"
                   << "9) Update profile\n"
+                  << "10) Search profiles\n"
+                  << "11) Find by name\n"
                   << "0) Exit\n";
         int choice = read_int("Select option: ");
 
@@ -34,6 +37,8 @@ void Menu::run()
             case 7: save_to_file(); break;
             case 8: load_from_file(); break;
             case 9: update_profile(); break;
+            case 10: query_profiles(); break;
+            case 11: search_names(); break;
             case 0:
                 std::cout << "Goodbye.\n";
                 return;
@@ -68,22 +73,68 @@ void Menu::view_profile()
     std::cout << "\n" << p->to_string();
 }
 
-void Menu::list_profiles() // list all profiles (ID and name) for quick browsing
+void Menu::list_profiles() // page through profiles (ID and name) for quick browsing
 {
-    auto ids = store_.list_ids(); // list_ids() returns all IDs sorted for stable otuput
-    if (ids.empty())
+    if (store_.size() == 0)
     {
         std::cout << "No profiles yet.\n";
         return;
     }
-    std::cout << "Profiles ( " << store_.size() << "):\n";
-    for (int id : ids)
+
+    // Page size: blank keeps the default
+    std::size_t page_size = 20;
+    std::string size_line = read_line("Page size (blank = 20): ");
+    if (!size_line.empty())
+    {
+        try
+        {
+            int requested = std::stoi(size_line);
+            if (requested > 0) page_size = static_cast<std::size_t>(requested);
+        } catch (...)
+        {
+            std::cout << "Invalid page size, using 20.\n";
+        }
+    }
+
+    // The cursor is the first id of the current page; the store hands out pages in id order
+    // straight from its ordered index, so nothing is copied or sorted up front.
+    int first = store_.ordered().begin().id();
+    while (true)
     {
-        const Profile* p = store_.find(id);
-        // p should never be null here, but we keep it defensive
-        if (p)
+        int last = first;
+        std::cout << "\nProfiles ( " << store_.size() << " total):\n";
+        std::size_t shown = store_.for_each_from(first, page_size, [&](const Profile& p)
+        {
+            std::cout << "- [" << p.id() << "] " << p.name() << "\n";
+            last = p.id();
+        });
+        if (shown == 0) std::cout << "No profiles at or after id " << first << ".\n";
+
+        std::string command = read_line("[n]ext, [p]rev, [j]ump to id, [a]ll, [q]uit: ");
+        if (command == "n")
+        {
+            // Only move if something follows the last row shown
+            if (shown > 0 && last < std::numeric_limits<int>::max() &&
+                store_.for_each_from(last + 1, 1, [](const Profile&) {}) > 0)
+            {
+                first = last + 1;
+            } else
+            {
+                std::cout << "Already on the last page.\n";
+            }
+        } else if (command == "p")
+        {
+            first = store_.id_before(first, page_size);
+        } else if (command == "j")
+        {
+            first = read_int("Jump to id: ");
+        } else if (command == "a")
         {
-            std::cout << "- [" << p->id() << "] " << p->name() << "\n";
+            write_listing(store_, std::cout); // everything, through one large buffer
+            return;
+        } else
+        {
+            return;
         }
     }
 }
@@ -112,8 +163,13 @@ void Menu::add_hobby()
     }
 
     std::string hobby = read_line("Hobby to add: ");
-    p->add_hobby(hobby);
-    std::cout << "Hobby added.\n";
+    if (p->add_hobby(hobby))
+    {
+        std::cout << "Hobby added.\n";
+    } else
+    {
+        std::cout << "Hobby not added (empty, or the profile already has it).\n";
+    }
 }
 
 void Menu::remove_hobby()
@@ -168,8 +224,34 @@ std::string Menu::read_line(const char* prompt)
 void Menu::save_to_file()
 {
     std::string path = read_line("Enter file path to save (ex: profiles.txt) ");
-    if (ProfileSerializer::save(store_, path))
+    // Blank keeps the default human-readable text format
+    std::string format = read_line("Format: text, binary, compressed or delta (blank = text) ");
+
+    // Delta appends only what changed since the last load/save of this file
+    if (format == "delta")
+    {
+        DeltaStats stats;
+        if (!ProfileSerializer::save_delta(store_, path, &stats))
+        {
+            std::cout << "Failed to save to " << path << "\n";
+        } else if (stats.full_save)
+        {
+            std::cout << "Saved to " << path << " (full save: no earlier load/save of this file to build on)\n";
+        } else
+        {
+            std::cout << "Saved changes to " << path << " (" << stats.written << " written, "
+                      << stats.deleted << " deleted)\n";
+        }
+        return;
+    }
+
+    SnapshotFormat snapshot_format = SnapshotFormat::Text;
+    if (format == "binary") snapshot_format = SnapshotFormat::Binary;
+    else if (format == "compressed") snapshot_format = SnapshotFormat::Compressed;
+
+    if (ProfileSerializer::save(store_, path, snapshot_format))
     {
+        store_.mark_clean(path); // later delta saves to this file build on it
         std::cout << "Saved to " << path << "\n";
     } else
     {
@@ -180,9 +262,16 @@ void Menu::save_to_file()
 void Menu::load_from_file()
 {
     std::string path = read_line("Enter file path to load (ex: profiles.txt) ");
-    if (ProfileSerializer::load(store_, path))
+    LoadStats stats;
+    if (ProfileSerializer::load_parallel(store_, path, 0, &stats))
     {
-        std::cout << "Loaded from " << path << "\n";
+        std::cout << "Loaded from " << path << " (" << stats.profiles << " profiles, "
+                  << stats.mb_per_sec() << " MB/s, " << stats.profiles_per_sec() << " profiles/s)\n";
+        if (stats.delta_ignored)
+        {
+            std::cout << "Warning: " << path << ".delta is damaged and was not applied; "
+                      << "a full save replaces it\n";
+        }
     } else
     {
         std::cout << "Failed to load from " << path << " (missing file or invalid format) \n";
@@ -244,4 +333,87 @@ void Menu::update_profile()
     }
 
     std::cout << "\nUpdated profile:\n" << p->to_string();
-}
\ No newline at end of file
+}
+
+// Filtered search: every answered question narrows the result
+void Menu::query_profiles()
+{
+    ProfileQuery query;
+    std::string min_age = read_line("Min age (blank = any): ");
+    std::string max_age = read_line("Max age (blank = any): ");
+    try
+    {
+        if (!min_age.empty()) query.min_age = std::stoi(min_age);
+        if (!max_age.empty()) query.max_age = std::stoi(max_age);
+    } catch (...)
+    {
+        std::cout << "Invalid age.\n";
+        return;
+    }
+    query.city = read_line("City (blank = any): ");
+    query.country = read_line("Country (blank = any): ");
+    query.name_prefix = read_line("Name starts with (blank = any): ");
+    query.hobby = read_line("Has hobby (blank = any): ");
+
+    std::string mode = read_line("[l]ist, [c]ount, or [g]roup by country (blank = list): ");
+    if (mode == "c")
+    {
+        std::cout << store_.query_count(query) << " matching profiles.\n";
+        return;
+    }
+    if (mode == "g")
+    {
+        const std::vector<CountryCount> groups = store_.query_count_by_country(query);
+        if (groups.empty()) std::cout << "No matching profiles.\n";
+        for (const CountryCount& group : groups) std::cout << "- " << group.country << ": " << group.profiles << "\n";
+        return;
+    }
+
+    // Listing: id and name only unless details are asked for
+    const bool details = read_line("Show all fields? (y/N): ") == "y";
+    const unsigned fields = details ? query_fields::all : (query_fields::id | query_fields::name);
+    const std::vector<QueryRow> rows = store_.query(query, fields);
+    if (rows.empty())
+    {
+        std::cout << "No matching profiles.\n";
+        return;
+    }
+
+    std::cout << rows.size() << " matching profiles:\n";
+    for (const QueryRow& row : rows)
+    {
+        std::cout << "- [" << row.id << "] " << row.name;
+        if (details)
+        {
+            std::cout << ", " << row.age << ", " << row.city << ", " << row.country;
+            for (std::size_t i = 0; i < row.hobbies.size(); ++i) std::cout << (i == 0 ? " | " : ", ") << row.hobbies[i];
+        }
+        std::cout << "\n";
+    }
+}
+
+// Partial / misspelled names, best matches first
+void Menu::search_names()
+{
+    const std::string query = read_line("Name (or part of it): ");
+    const int limit = read_int("How many results? ");
+    if (limit <= 0)
+    {
+        std::cout << "Invalid count.\n";
+        return;
+    }
+
+    const std::vector<NameMatch> matches = store_.search_names(query, static_cast<std::size_t>(limit));
+    if (matches.empty())
+    {
+        std::cout << "No matching names.\n";
+        return;
+    }
+
+    static const char* const kinds[] = {"exact", "prefix", "word prefix", "contains", "similar"};
+    for (const NameMatch& match : matches)
+    {
+        const Profile* p = store_.find(match.id);
+        std::cout << "- [" << match.id << "] " << p->name() << " (" << kinds[static_cast<int>(match.kind)] << ")\n";
+    }
+}
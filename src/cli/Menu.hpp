@@ -26,6 +26,8 @@ private:
     void save_to_file();
     void load_from_file();
     void update_profile();
+    void query_profiles();
+    void search_names();
 
     // Input helpers
     int read_int(const char* prompt);
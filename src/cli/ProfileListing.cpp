@@ -0,0 +1,35 @@
+#include "ProfileListing.hpp"
+
+#include <charconv> // std::to_chars
+#include <ostream>
+#include <string>
+
+// write_listing: bulk "- [id] name" dump
+
+void write_listing(const ProfileStore& store, std::ostream& out)
+{
+    constexpr std::size_t flush_at = 1 << 20; // 1 MiB
+
+    std::string buffer;
+    buffer.reserve(flush_at + 256);
+
+    for (const Profile& p : store.ordered())
+    {
+        char id_text[16];
+        const auto result = std::to_chars(id_text, id_text + sizeof(id_text), p.id());
+
+        buffer += "- [";
+        buffer.append(id_text, static_cast<std::size_t>(result.ptr - id_text));
+        buffer += "] ";
+        buffer += p.name();
+        buffer += '\n';
+
+        if (buffer.size() >= flush_at)
+        {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+}
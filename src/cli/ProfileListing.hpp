@@ -0,0 +1,13 @@
+#ifndef PROFILEMANAGERCLI_PROFILELISTING_HPP
+#define PROFILEMANAGERCLI_PROFILELISTING_HPP
+
+#include <iosfwd>
+
+#include "../service/ProfileStore.hpp"
+
+// Writes "- [id] name" for every profile in id order.
+// Lines are assembled in one large buffer and handed to `out` in big writes,
+// so dumping millions of profiles costs a handful of stream calls instead of one per field.
+void write_listing(const ProfileStore& store, std::ostream& out);
+
+#endif //PROFILEMANAGERCLI_PROFILELISTING_HPP
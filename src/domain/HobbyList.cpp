@@ -0,0 +1,237 @@
+#include "HobbyList.hpp"
+
+#include <algorithm> // std::copy, std::find
+#include <utility>   // std::swap
+
+// HobbyList: small-buffer hobby storage with a flat hashed membership table for large lists
+
+namespace
+{
+    std::uint32_t hash_handle(std::uint32_t h)
+    {
+        // Handles are small consecutive integers; mix them so neighbours spread over the table
+        h ^= h >> 16;
+        h *= 0x45d9f3bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    template <typename T>
+    T* allocate_in(Arena* arena, std::size_t n)
+    {
+        return ArenaAllocator<T>(arena).allocate(n);
+    }
+
+    template <typename T>
+    void release_in(Arena* arena, T* p, std::size_t n)
+    {
+        if (p) ArenaAllocator<T>(arena).deallocate(p, n);
+    }
+}
+
+HobbyList::HobbyList(const HobbyList& other) : unique_(other.unique_)
+{
+    if (other.size_ > inline_capacity) reserve_exact(other.size_);
+    std::copy(other.begin(), other.end(), data_mut());
+    size_ = other.size_;
+    if (other.table_) table_rebuild(other.table_capacity_);
+}
+
+HobbyList& HobbyList::operator=(const HobbyList& other)
+{
+    if (this == &other) return *this;
+
+    // Reuse our own buffers (and arena) where they are big enough
+    if (other.size_ > capacity_) reserve_exact(other.size_);
+    std::copy(other.begin(), other.end(), data_mut());
+    size_ = other.size_;
+    unique_ = other.unique_;
+    if (table_ || other.table_) table_rebuild(std::max(table_capacity_, other.table_capacity_));
+    return *this;
+}
+
+HobbyList::HobbyList(HobbyList&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+HobbyList& HobbyList::operator=(HobbyList&& other) noexcept
+{
+    if (this == &other) return *this;
+    free_buffers();
+
+    std::copy(other.inline_, other.inline_ + inline_capacity, inline_);
+    heap_ = std::exchange(other.heap_, nullptr);
+    table_ = std::exchange(other.table_, nullptr);
+    arena_ = other.arena_;
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, static_cast<std::uint32_t>(inline_capacity));
+    table_capacity_ = std::exchange(other.table_capacity_, 0);
+    table_used_ = std::exchange(other.table_used_, 0);
+    unique_ = other.unique_;
+    return *this;
+}
+
+HobbyList::~HobbyList()
+{
+    free_buffers();
+}
+
+void HobbyList::free_buffers()
+{
+    release_in(arena_, heap_, capacity_);
+    release_in(arena_, table_, table_capacity_);
+    heap_ = nullptr;
+    table_ = nullptr;
+    capacity_ = inline_capacity;
+    table_capacity_ = 0;
+    table_used_ = 0;
+}
+
+HobbyList::Handle* HobbyList::data_mut()
+{
+    return heap_ ? heap_ : inline_;
+}
+
+void HobbyList::reserve_exact(std::uint32_t capacity)
+{
+    Handle* grown = allocate_in<Handle>(arena_, capacity);
+    std::copy(begin(), end(), grown);
+    release_in(arena_, heap_, capacity_);
+    heap_ = grown;
+    capacity_ = capacity;
+}
+
+HobbyList::Count* HobbyList::table_slot(Handle hobby) const
+{
+    const std::uint32_t mask = table_capacity_ - 1;
+    for (std::uint32_t i = hash_handle(hobby) & mask;; i = (i + 1) & mask) // linear probing
+    {
+        if (table_[i].hobby == hobby || table_[i].hobby == StringPool::npos) return &table_[i];
+    }
+}
+
+void HobbyList::table_rebuild(std::uint32_t capacity)
+{
+    // Keep the table at most half full
+    if (capacity == 0) capacity = 2 * hashed_threshold;
+    while (capacity < 2 * size_ || capacity < 2 * hashed_threshold) capacity *= 2;
+
+    release_in(arena_, table_, table_capacity_);
+    table_ = allocate_in<Count>(arena_, capacity);
+    table_capacity_ = capacity;
+    table_used_ = 0;
+    std::fill(table_, table_ + capacity, Count{StringPool::npos, 0});
+    for (Handle hobby : *this) table_add(hobby);
+}
+
+void HobbyList::table_add(Handle hobby)
+{
+    Count* slot = table_slot(hobby);
+    if (slot->hobby == StringPool::npos)
+    {
+        *slot = Count{hobby, 0};
+        ++table_used_;
+    }
+    ++slot->count;
+}
+
+void HobbyList::table_erase(Count* slot)
+{
+    // Backward-shift deletion: pull later entries of the probe run into the hole, so lookups
+    // never need tombstones
+    const std::uint32_t mask = table_capacity_ - 1;
+    auto hole = static_cast<std::uint32_t>(slot - table_);
+    for (std::uint32_t i = (hole + 1) & mask; table_[i].hobby != StringPool::npos; i = (i + 1) & mask)
+    {
+        const std::uint32_t home = hash_handle(table_[i].hobby) & mask;
+        // Move the entry back only if its home slot is not between the hole and its current slot
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            table_[hole] = table_[i];
+            hole = i;
+        }
+    }
+    table_[hole] = Count{StringPool::npos, 0};
+    --table_used_;
+}
+
+std::size_t HobbyList::size() const{return size_;}
+bool HobbyList::empty() const{return size_ == 0;}
+const HobbyList::Handle* HobbyList::data() const{return heap_ ? heap_ : inline_;}
+const HobbyList::Handle* HobbyList::begin() const{return data();}
+const HobbyList::Handle* HobbyList::end() const{return data() + size_;}
+
+bool HobbyList::contains(Handle hobby) const
+{
+    if (table_) return table_slot(hobby)->hobby == hobby;
+    return std::find(begin(), end(), hobby) != end(); // at most hashed_threshold integer compares
+}
+
+bool HobbyList::add(Handle hobby)
+{
+    if (unique_ && contains(hobby)) return false;
+
+    if (size_ == capacity_) reserve_exact(capacity_ * 2);
+    data_mut()[size_++] = hobby;
+
+    if (table_)
+    {
+        if (2 * (table_used_ + 1) > table_capacity_) table_rebuild(table_capacity_ * 2);
+        else table_add(hobby);
+    }
+    else if (size_ > hashed_threshold)
+    {
+        table_rebuild(2 * hashed_threshold);
+    }
+    return true;
+}
+
+bool HobbyList::remove(Handle hobby)
+{
+    if (table_)
+    {
+        // O(1) answer for hobbies the profile does not have
+        Count* slot = table_slot(hobby);
+        if (slot->hobby != hobby) return false;
+        if (--slot->count == 0) table_erase(slot);
+    }
+
+    Handle* handles = data_mut();
+    Handle* found = std::find(handles, handles + size_, hobby);
+    if (found == handles + size_) return false;
+
+    std::copy(found + 1, handles + size_, found); // keep insertion order
+    --size_;
+    return true;
+}
+
+bool HobbyList::unique() const
+{
+    return unique_;
+}
+
+void HobbyList::set_unique(bool unique)
+{
+    unique_ = unique;
+}
+
+void HobbyList::set_arena(Arena* arena)
+{
+    if (arena == arena_) return;
+
+    // Re-home the buffers: copy into the new arena, then let the old owner go
+    HobbyList moved;
+    moved.arena_ = arena;
+    moved.unique_ = unique_;
+    if (size_ > inline_capacity) moved.reserve_exact(size_);
+    std::copy(begin(), end(), moved.data_mut());
+    moved.size_ = size_;
+    if (table_) moved.table_rebuild(table_capacity_);
+    *this = std::move(moved);
+}
+
+Arena* HobbyList::arena() const
+{
+    return arena_;
+}
@@ -0,0 +1,89 @@
+#ifndef PROFILEMANAGERCLI_HOBBYLIST_HPP
+#define PROFILEMANAGERCLI_HOBBYLIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "StringPool.hpp"
+#include "../util/Arena.hpp"
+
+// A profile's hobbies (interned handles) in insertion order.
+// Small-buffer storage: up to inline_capacity hobbies live inside the object, so the common
+// profile with a handful of hobbies never allocates. Larger lists move to a separate buffer, and
+// once a list passes hashed_threshold a flat handle -> count table makes membership checks O(1)
+// (duplicate detection, removing a hobby the profile does not have). Removing a hobby that is
+// present keeps the order by shifting the handles behind it (one memmove of 4-byte handles).
+// In unique mode add() refuses a hobby that is already on the list.
+// Both buffers come from an Arena when one is set, otherwise from the global heap.
+class HobbyList
+{
+public:
+    using Handle = StringPool::Handle;
+
+    static constexpr std::size_t inline_capacity = 4;
+    static constexpr std::size_t hashed_threshold = 16;
+
+private:
+    // Membership table slot; hobby == StringPool::npos marks an empty slot
+    struct Count
+    {
+        Handle hobby;
+        std::uint32_t count;
+    };
+
+    Handle inline_[inline_capacity] = {};
+    Handle* heap_ = nullptr;  // capacity_ handles, once the list outgrew inline_ (and from then on)
+    Count* table_ = nullptr;  // table_capacity_ slots (a power of two), only for large lists
+    Arena* arena_ = nullptr;  // where heap_ and table_ come from; nullptr = global heap
+    std::uint32_t size_ = 0;
+    std::uint32_t capacity_ = inline_capacity;
+    std::uint32_t table_capacity_ = 0;
+    std::uint32_t table_used_ = 0; // distinct hobbies in table_
+    bool unique_ = false;
+
+    Handle* data_mut();
+    void reserve_exact(std::uint32_t capacity);
+    void free_buffers();
+
+    Count* table_slot(Handle hobby) const; // slot holding `hobby`, or the empty slot it would go in
+    void table_rebuild(std::uint32_t capacity);
+    void table_add(Handle hobby);
+    void table_erase(Count* slot);
+
+public:
+    HobbyList() = default;
+    HobbyList(const HobbyList& other);            // the copy uses the global heap
+    HobbyList& operator=(const HobbyList& other); // keeps this list's arena
+    HobbyList(HobbyList&& other) noexcept;
+    HobbyList& operator=(HobbyList&& other) noexcept;
+    ~HobbyList();
+
+    std::size_t size() const;
+    bool empty() const;
+    const Handle* data() const;
+    const Handle* begin() const;
+    const Handle* end() const;
+
+    bool contains(Handle hobby) const;
+    bool add(Handle hobby);    // false if unique mode already has it
+    bool remove(Handle hobby); // removes the first occurrence; false if absent
+
+    bool unique() const;
+    void set_unique(bool unique); // only affects later add() calls; existing duplicates stay
+
+    // Move the buffers into `arena` (nullptr = global heap). The arena must outlive the list
+    // unless the list is abandoned together with the arena's reset.
+    void set_arena(Arena* arena);
+    Arena* arena() const;
+
+    // Rewrite every handle (e.g. re-interning into another pool)
+    template <typename Fn>
+    void remap(Fn&& fn)
+    {
+        Handle* handles = data_mut();
+        for (std::size_t i = 0; i < size_; ++i) handles[i] = fn(handles[i]);
+        if (table_) table_rebuild(table_capacity_);
+    }
+};
+
+#endif //PROFILEMANAGERCLI_HOBBYLIST_HPP
@@ -1,76 +1,164 @@
 #include "Profile.hpp"
-#include <algorithm>
-#include <sstream> // streams that behave like std::cout, but write into memory (a string) instead of the terminal.
+#include "ProfileFormatter.hpp"
 #include <cstddef> // not super required but in strict env you might want it (for size_t)
 
 // domain model + methods (add/remove hobby, view string)
 
-Profile::Profile(int id, const std::string& name, int age, const std::string& city, const std::string& country)
-                : id_(id), name_(name), age_(age), city_(city), country_(country){} // <-- initializer list
+Profile::Profile(int id, std::string_view name, int age, const std::string& city, const std::string& country,
+                 StringPool& strings)
+                : id_(id), name_(name.data(), name.size()), age_(age), strings_(&strings),
+                  city_(strings.intern(city)), country_(strings.intern(country)){} // <-- initializer list
+
+Profile::Profile(int id, std::string_view name, int age, StringPool::Handle city, StringPool::Handle country,
+                 StringPool& strings)
+                : id_(id), name_(name.data(), name.size()), age_(age), strings_(&strings), city_(city), country_(country){}
 
 // Getters
 int Profile::id() const{return id_;}
-const std::string& Profile::name() const{return name_;} // const - avoids copying the str every time & more efficient
+std::string_view Profile::name() const{return std::string_view(name_.data(), name_.size());} // no copy
+std::string Profile::name_string() const{return std::string(name_.data(), name_.size());}
 int Profile::age() const{return age_;}
-const std::string& Profile::city() const{return city_;}
-const std::string& Profile::country() const{return country_;}
-const std::vector<std::string>& Profile::hobbies() const{return hobbies_;}
+const std::string& Profile::city() const{return strings_->str(city_);}
+const std::string& Profile::country() const{return strings_->str(country_);}
+HobbyView Profile::hobbies() const{return HobbyView(hobbies_.data(), hobbies_.data() + hobbies_.size(), strings_);}
+
+StringPool::Handle Profile::city_handle() const{return city_;}
+StringPool::Handle Profile::country_handle() const{return country_;}
+const StringPool& Profile::strings() const{return *strings_;}
+
+bool Profile::has_hobby(StringPool::Handle hobby) const{
+    return hobbies_.contains(hobby); // hashed once the profile has many hobbies
+}
 
 // Not const because of object mutation
-void Profile::add_hobby(const std::string& hobby){
-    if (hobby.empty()) return; // validation for MVP
-    hobbies_.push_back(hobby);
+bool Profile::add_hobby(const std::string& hobby){
+    if (hobby.empty()) return false; // validation for MVP
+    return add_hobby(strings_->intern(hobby));
+}
+
+bool Profile::add_hobby(StringPool::Handle hobby){
+    if (strings_->str(hobby).empty()) return false;
+    if (hobbies_.unique() && hobbies_.contains(hobby)) return false; // checked first so observers hear nothing
+    notify_changing(ProfileField::HobbyAdded);
+    hobbies_.add(hobby);
+    notify_changed(ProfileField::HobbyAdded, strings_->str(hobby));
+    return true;
 }
 
 bool Profile::remove_hobby(const std::string& hobby){
-    auto it = std::find(hobbies_.begin(), hobbies_.end(), hobby);
-    if (it == hobbies_.end()) return false;
-    hobbies_.erase(it); // if found remove the element from the vector
+    // A string that was never interned cannot be one of our hobbies
+    const StringPool::Handle handle = strings_->find(hobby);
+    if (handle == StringPool::npos) return false;
+
+    if (!hobbies_.contains(handle)) return false;
+    notify_changing(ProfileField::HobbyRemoved);
+    hobbies_.remove(handle); // first occurrence; the rest keep their order
+    notify_changed(ProfileField::HobbyRemoved, strings_->str(handle));
     return true;
 }
 
 std::string Profile::to_string() const{
-    std::ostringstream out; // output string stream
-    out << "Id: " << id_ << "\n"
-        << "Name: " << name_ << "\n"
-        << "Age: " << age_ << "\n"
-        << "City: " << city_ << "\n"
-        << "Country: " << country_ << "\n"
-        << "Hobbies: ";
-
-    for (size_t i = 0; i < hobbies_.size(); ++i){
-        out << hobbies_[i];
-        if (i + 1 < hobbies_.size()) out << ", ";
-    }
-    out << "\n";
-    return out.str(); // str() returns the accumulated contents of the stream as a std::string
+    // Formatting lives in ProfileFormatter; callers rendering many profiles should use it directly
+    // with one reused buffer instead of getting a fresh string back each time.
+    std::string out;
+    ProfileFormatter::append_text(out, *this);
+    return out;
 }
 
 // bool return so that UI can report validation failures instead of silently accepting bad values.
 bool Profile::set_name(const std::string& name)
 {
     if (name.empty()) return false;
-    name_ = name;
+    notify_changing(ProfileField::Name);
+    name_.assign(name.data(), name.size()); // keeps the name's allocator (arena or heap)
+    notify_changed(ProfileField::Name);
     return true;
 }
 
 bool Profile::set_age(int age)
 {
     if (age < 0 || age > 130) return false;
+    notify_changing(ProfileField::Age);
     age_ = age;
+    notify_changed(ProfileField::Age);
     return true;
 }
 
 bool Profile::set_city(const std::string& city)
 {
     if (city.empty()) return false;
-    city_ = city;
+    notify_changing(ProfileField::City);
+    city_ = strings_->intern(city);
+    notify_changed(ProfileField::City);
     return true;
 }
 
 bool Profile::set_country(const std::string& country)
 {
     if (country.empty()) return false;
-    country_ = country;
+    notify_changing(ProfileField::Country);
+    country_ = strings_->intern(country);
+    notify_changed(ProfileField::Country);
     return true;
 }
+
+void Profile::set_unique_hobbies(bool unique)
+{
+    hobbies_.set_unique(unique);
+}
+
+bool Profile::unique_hobbies() const
+{
+    return hobbies_.unique();
+}
+
+void Profile::set_arena(Arena* arena)
+{
+    if (name_.get_allocator().arena() != arena)
+    {
+        name_ = NameString(name_.data(), name_.size(), ArenaAllocator<char>(arena));
+    }
+    hobbies_.set_arena(arena);
+}
+
+void Profile::set_observer(ProfileObserver* observer)
+{
+    observer_.set(observer);
+}
+
+void Profile::rebind(StringPool& strings)
+{
+    if (&strings == strings_) return;
+    city_ = strings.intern(strings_->str(city_));
+    country_ = strings.intern(strings_->str(country_));
+    hobbies_.remap([&](StringPool::Handle hobby) { return strings.intern(strings_->str(hobby)); });
+    strings_ = &strings;
+}
+
+void Profile::rebind(StringPool& strings, std::vector<StringPool::Handle>& remap)
+{
+    if (&strings == strings_) return;
+    if (remap.size() < strings_->size()) remap.resize(strings_->size(), StringPool::npos);
+
+    // Each distinct source string is looked up in the target pool only once
+    auto translate = [&](StringPool::Handle handle)
+    {
+        StringPool::Handle& mapped = remap[handle];
+        if (mapped == StringPool::npos) mapped = strings.intern(strings_->str(handle));
+        return mapped;
+    };
+    city_ = translate(city_);
+    country_ = translate(country_);
+    hobbies_.remap(translate);
+    strings_ = &strings;
+}
+
+void Profile::notify_changing(ProfileField field) const
+{
+    if (ProfileObserver* observer = observer_.get()) observer->profile_changing(*this, field);
+}
+
+void Profile::notify_changed(ProfileField field, const std::string& hobby) const
+{
+    if (ProfileObserver* observer = observer_.get()) observer->profile_changed(*this, field, hobby);
+}
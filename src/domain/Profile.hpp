@@ -1,43 +1,143 @@
 #ifndef PROFILEMANAGERCLI_PROFILE_H
 #define PROFILEMANAGERCLI_PROFILE_H
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "HobbyList.hpp"
+#include "ProfileObserver.hpp"
+#include "StringPool.hpp"
+#include "../util/Arena.hpp"
+
+// Read-only view over a profile's hobbies: iterates interned handles but yields const std::string&,
+// so callers can keep treating hobbies like a container of strings.
+class HobbyView
+{
+private:
+    const StringPool::Handle* first_;
+    const StringPool::Handle* last_;
+    const StringPool* strings_;
+
+public:
+    class iterator
+    {
+    private:
+        const StringPool::Handle* pos_;
+        const StringPool* strings_;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string*;
+        using reference = const std::string&;
+
+        iterator(const StringPool::Handle* pos, const StringPool* strings) : pos_(pos), strings_(strings) {}
+
+        reference operator*() const { return strings_->str(*pos_); }
+        pointer operator->() const { return &strings_->str(*pos_); }
+        iterator& operator++() { ++pos_; return *this; }
+        iterator operator++(int) { iterator old = *this; ++pos_; return old; }
+        bool operator==(const iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const iterator& other) const { return pos_ != other.pos_; }
+    };
+
+    HobbyView(const StringPool::Handle* first, const StringPool::Handle* last, const StringPool* strings)
+        : first_(first), last_(last), strings_(strings) {}
+
+    iterator begin() const { return iterator(first_, strings_); }
+    iterator end() const { return iterator(last_, strings_); }
+    std::size_t size() const { return static_cast<std::size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+    const std::string& operator[](std::size_t i) const { return strings_->str(first_[i]); }
+
+    // Raw handles, for integer comparisons against other interned values
+    const StringPool::Handle* handles() const { return first_; }
+};
+
 class Profile{
     private:
+        // Heap-allocated normally; in a store's arena once the profile lives in an arena-mode store
+        using NameString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
         int id_;
-        std::string name_;
+        NameString name_;
         int age_;
-        std::string city_;
-        std::string country_;
-        std::vector<std::string> hobbies_;
+        // city, country and hobbies are interned in the owning store's pool; we only keep handles
+        StringPool* strings_;
+        StringPool::Handle city_;
+        StringPool::Handle country_;
+        HobbyList hobbies_; // insertion order; inline for up to 4 hobbies
+        ObserverLink observer_; // owner to notify on mutation (not copied with the profile)
+
+        void notify_changing(ProfileField field) const;
+        void notify_changed(ProfileField field, const std::string& hobby = std::string()) const;
 
     public: // public interface (API) : requires the core data for valid Profile creation
+        // `strings` is the pool the text fields are interned in (normally ProfileStore::strings());
+        // it must outlive the profile.
         Profile(int id,
-                const std::string& name,
+                std::string_view name,
                 int age,
                 const std::string& city,
-                const std::string& country);
+                const std::string& country,
+                StringPool& strings);
+        // Same, with city/country already interned in `strings` (bulk loaders)
+        Profile(int id,
+                std::string_view name,
+                int age,
+                StringPool::Handle city,
+                StringPool::Handle country,
+                StringPool& strings);
         // Read-only accessors
         // We add const to the end to imply that this method does not modify the object
         int id() const;
-        const std::string& name() const;
+        // The name buffer may live in the store's arena, so this is a view rather than a
+        // const std::string& (changed with arena allocation): copy it to keep it past the profile,
+        // or use name_string() where a std::string is needed.
+        std::string_view name() const;
+        std::string name_string() const; // owned copy of name()
         int age() const;
         const std::string& city() const;
         const std::string& country() const;
-        const std::vector<std::string>& hobbies() const;
+        HobbyView hobbies() const;
+
+        // Interned handles (compare these instead of strings when filtering)
+        StringPool::Handle city_handle() const;
+        StringPool::Handle country_handle() const;
+        const StringPool& strings() const;
+        bool has_hobby(StringPool::Handle hobby) const;
 
         //Mutators
-        void add_hobby(const std::string& hobby);
+        // false if the hobby is empty, or already present while unique hobbies are on
+        bool add_hobby(const std::string& hobby);
+        bool add_hobby(StringPool::Handle hobby); // already interned in this profile's pool
         bool remove_hobby(const std::string& hobby);
         bool set_name(const std::string& name);
         bool set_age(int age);
         bool set_city(const std::string& city);
         bool set_country(const std::string& country);
 
+        // Unique mode: add_hobby refuses duplicates (off by default; existing duplicates are kept)
+        void set_unique_hobbies(bool unique);
+        bool unique_hobbies() const;
+
+        // Move the name and hobby buffers into `arena` (nullptr = global heap). Copies of a
+        // profile always use the global heap, so they are safe to keep after the arena resets.
+        void set_arena(Arena* arena);
+
+        // Attach the owner that should hear about mutations (nullptr detaches)
+        void set_observer(ProfileObserver* observer);
+        // Re-intern city/country/hobbies into another pool (used when a profile moves between stores)
+        void rebind(StringPool& strings);
+        // Same, memoising old handle -> new handle in `remap` (shared by every profile of one source pool)
+        void rebind(StringPool& strings, std::vector<StringPool::Handle>& remap);
+
     std::string to_string() const; // presentation
 
 };
 
-#endif //PROFILEMANAGERCLI_PROFILE_H
\ No newline at end of file
+#endif //PROFILEMANAGERCLI_PROFILE_H
@@ -0,0 +1,187 @@
+#include "ProfileFormatter.hpp"
+#include "Profile.hpp"
+
+#include <charconv> // std::to_chars
+#include <string_view>
+
+// ProfileFormatter: text / JSON / CSV rendering into caller buffers
+
+namespace
+{
+    void append_int(std::string& out, int value)
+    {
+        char digits[16];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+    }
+
+    // JSON string body: '"', '\' and control characters are escaped, everything else is copied in runs
+    void append_json_string(std::string& out, std::string_view s)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        out += '"';
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            const auto ch = static_cast<unsigned char>(s[i]);
+            if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (ch)
+            {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                case '\r': out += "\\r"; break;
+                default:
+                {
+                    const char escaped[6] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF]};
+                    out.append(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+
+    bool needs_csv_quotes(std::string_view s)
+    {
+        for (char ch : s)
+        {
+            if (ch == ',' || ch == '"' || ch == '\r' || ch == '\n') return true;
+        }
+        return false;
+    }
+
+    // CSV field: quoted only when it contains a separator, quote or line break; quotes are doubled
+    void append_csv_field(std::string& out, std::string_view s)
+    {
+        if (!needs_csv_quotes(s))
+        {
+            out.append(s.data(), s.size());
+            return;
+        }
+
+        out += '"';
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] != '"') continue;
+            out.append(s.data() + run, i + 1 - run); // copy up to and including the quote...
+            out += '"';                              // ...and double it
+            run = i + 1;
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+
+    // Hobby inside the joined CSV hobby field: '|' and '\' get a backslash
+    void append_hobby_escaped(std::string& out, std::string_view s)
+    {
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] != '|' && s[i] != '\\') continue;
+            out.append(s.data() + run, i - run);
+            out += '\\';
+            run = i; // the special char itself is copied with the next run
+        }
+        out.append(s.data() + run, s.size() - run);
+    }
+}
+
+void ProfileFormatter::append_text(std::string& out, const Profile& p)
+{
+    out += "Id: ";
+    append_int(out, p.id());
+    out += "\nName: ";
+    out += p.name();
+    out += "\nAge: ";
+    append_int(out, p.age());
+    out += "\nCity: ";
+    out += p.city();
+    out += "\nCountry: ";
+    out += p.country();
+    out += "\nHobbies: ";
+
+    const HobbyView hobbies = p.hobbies();
+    for (std::size_t i = 0; i < hobbies.size(); ++i)
+    {
+        out += hobbies[i];
+        if (i + 1 < hobbies.size()) out += ", ";
+    }
+    out += '\n';
+}
+
+void ProfileFormatter::append_json(std::string& out, const Profile& p)
+{
+    out += "{\"id\":";
+    append_int(out, p.id());
+    out += ",\"name\":";
+    append_json_string(out, p.name());
+    out += ",\"age\":";
+    append_int(out, p.age());
+    out += ",\"city\":";
+    append_json_string(out, p.city());
+    out += ",\"country\":";
+    append_json_string(out, p.country());
+    out += ",\"hobbies\":[";
+
+    const HobbyView hobbies = p.hobbies();
+    for (std::size_t i = 0; i < hobbies.size(); ++i)
+    {
+        if (i > 0) out += ',';
+        append_json_string(out, hobbies[i]);
+    }
+    out += "]}";
+}
+
+void ProfileFormatter::append_csv(std::string& out, const Profile& p)
+{
+    append_int(out, p.id());
+    out += ',';
+    append_csv_field(out, p.name());
+    out += ',';
+    append_int(out, p.age());
+    out += ',';
+    append_csv_field(out, p.city());
+    out += ',';
+    append_csv_field(out, p.country());
+    out += ',';
+
+    // Join the hobbies first (in the tail of `out`), then quote the joined field if it needs it
+    const std::size_t start = out.size();
+    const HobbyView hobbies = p.hobbies();
+    for (std::size_t i = 0; i < hobbies.size(); ++i)
+    {
+        if (i > 0) out += '|';
+        append_hobby_escaped(out, hobbies[i]);
+    }
+    const std::size_t length = out.size() - start;
+    if (needs_csv_quotes(std::string_view(out.data() + start, length)))
+    {
+        // Rare: quote the joined field in place, walking backwards so nothing is overwritten early
+        std::size_t quotes = 0;
+        for (std::size_t i = start; i < start + length; ++i) quotes += out[i] == '"';
+
+        out.resize(start + length + quotes + 2);
+        std::size_t dst = out.size() - 1;
+        out[dst] = '"';
+        for (std::size_t i = start + length; i-- > start;)
+        {
+            out[--dst] = out[i];
+            if (out[i] == '"') out[--dst] = '"';
+        }
+        out[start] = '"';
+    }
+    out += '\n';
+}
+
+void ProfileFormatter::append_csv_header(std::string& out)
+{
+    out += "id,name,age,city,country,hobbies\n";
+}
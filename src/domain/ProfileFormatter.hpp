@@ -0,0 +1,27 @@
+#ifndef PROFILEMANAGERCLI_PROFILEFORMATTER_HPP
+#define PROFILEMANAGERCLI_PROFILEFORMATTER_HPP
+
+#include <string>
+
+class Profile;
+
+// Renders profiles by appending to a caller-owned std::string.
+// Numbers go through std::to_chars and text is copied in runs, so once the caller's buffer has
+// grown to fit (reuse it and clear() between calls) rendering does no heap allocation at all.
+class ProfileFormatter
+{
+    public:
+        // The multi-line "Id: ...\nName: ..." block shown by the menu (what Profile::to_string returns)
+        static void append_text(std::string& out, const Profile& p);
+
+        // One JSON object: {"id":1,"name":"...","age":30,"city":"...","country":"...","hobbies":["..."]}
+        static void append_json(std::string& out, const Profile& p);
+
+        // One CSV row (RFC 4180 quoting, '\n' terminated): id,name,age,city,country,hobbies
+        // Hobbies share one field, separated by '|'; a '|' or '\' inside a hobby is backslash-escaped
+        // like in the PMCLI1 format.
+        static void append_csv(std::string& out, const Profile& p);
+        static void append_csv_header(std::string& out);
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEFORMATTER_HPP
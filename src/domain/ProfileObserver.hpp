@@ -0,0 +1,50 @@
+#ifndef PROFILEMANAGERCLI_PROFILEOBSERVER_HPP
+#define PROFILEMANAGERCLI_PROFILEOBSERVER_HPP
+
+#include <string>
+
+class Profile;
+
+// Which part of a Profile a mutator touched
+enum class ProfileField
+{
+    Name,
+    Age,
+    City,
+    Country,
+    HobbyAdded,
+    HobbyRemoved
+};
+
+// Gets told about every successful mutation of a Profile it is attached to.
+// Profiles are edited directly through the Profile* that ProfileStore::find() hands out,
+// so this is how the owner keeps derived state (logs, indexes, ...) in sync.
+class ProfileObserver
+{
+    public:
+        virtual ~ProfileObserver() = default;
+
+        // Right before a validated change is applied: the profile still holds its old value
+        virtual void profile_changing(const Profile& profile, ProfileField field) = 0;
+
+        // Right after the change. For HobbyAdded/HobbyRemoved `hobby` is the hobby text, otherwise it is empty
+        virtual void profile_changed(const Profile& profile, ProfileField field, const std::string& hobby) = 0;
+};
+
+// Observer pointer that is deliberately NOT carried over by copies/moves:
+// a copy of a stored profile is a detached value and must not report changes to the store.
+class ObserverLink
+{
+    private:
+        ProfileObserver* observer_ = nullptr;
+
+    public:
+        ObserverLink() = default;
+        ObserverLink(const ObserverLink&) {}
+        ObserverLink& operator=(const ObserverLink&) { return *this; }
+
+        void set(ProfileObserver* observer) { observer_ = observer; }
+        ProfileObserver* get() const { return observer_; }
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEOBSERVER_HPP
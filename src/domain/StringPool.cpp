@@ -0,0 +1,74 @@
+#include "StringPool.hpp"
+
+// StringPool: string <-> handle mapping
+
+namespace
+{
+    // Position (0-63) of the highest set bit of a non-zero word
+    unsigned highest_bit(std::uint64_t bits)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(bits));
+#else
+        unsigned position = 0;
+        for (unsigned shift = 32; shift > 0; shift /= 2)
+        {
+            if (bits >> shift)
+            {
+                bits >>= shift;
+                position += shift;
+            }
+        }
+        return position;
+#endif
+    }
+}
+
+std::string& StringPool::slot(std::size_t handle) const
+{
+    // Offsetting by the first chunk's size makes chunk k start at (first_chunk << k) - first_chunk
+    const std::uint64_t index = static_cast<std::uint64_t>(handle) + (std::uint64_t(1) << first_chunk_bits);
+    const unsigned chunk = highest_bit(index) - first_chunk_bits;
+    return chunks_[chunk][index - (std::uint64_t(1) << (chunk + first_chunk_bits))];
+}
+
+StringPool::Handle StringPool::intern(std::string_view s)
+{
+    auto it = lookup_.find(s);
+    if (it != lookup_.end()) return it->second;
+
+    const std::size_t handle = size_.load(std::memory_order_relaxed);
+    const std::uint64_t index = static_cast<std::uint64_t>(handle) + (std::uint64_t(1) << first_chunk_bits);
+    const unsigned chunk = highest_bit(index) - first_chunk_bits;
+    // A chunk is allocated when its first string arrives; existing chunks are never touched
+    if (!chunks_[chunk]) chunks_[chunk].reset(new std::string[std::size_t(1) << (chunk + first_chunk_bits)]);
+
+    std::string& stored = slot(handle);
+    stored.assign(s.data(), s.size());
+    lookup_.emplace(std::string_view(stored), static_cast<Handle>(handle)); // key must view the pooled copy
+    size_.store(handle + 1, std::memory_order_release);
+    return static_cast<Handle>(handle);
+}
+
+StringPool::Handle StringPool::find(std::string_view s) const
+{
+    auto it = lookup_.find(s);
+    return it == lookup_.end() ? npos : it->second;
+}
+
+const std::string& StringPool::str(Handle handle) const
+{
+    return slot(handle);
+}
+
+std::size_t StringPool::size() const
+{
+    return size_.load(std::memory_order_acquire);
+}
+
+void StringPool::clear()
+{
+    lookup_.clear();
+    for (std::unique_ptr<std::string[]>& chunk : chunks_) chunk.reset();
+    size_.store(0, std::memory_order_release);
+}
@@ -0,0 +1,51 @@
+#ifndef PROFILEMANAGERCLI_STRINGPOOL_HPP
+#define PROFILEMANAGERCLI_STRINGPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interning pool: every distinct string is stored once and identified by a small integer handle.
+// Profiles keep handles for their city, country and hobbies, so millions of profiles share a few
+// thousand strings and equality checks become integer compares.
+// Strings live in chunks that are never moved or reallocated (chunk k holds first_chunk << k strings),
+// so references returned by str() stay valid while new strings are added, and str()/size() may run
+// while one other thread interns (a lazy store reading records in). The handle itself must reach the
+// reader through the lock that guarded its intern. intern() and find() still need the caller to
+// serialise them.
+class StringPool
+{
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle npos = std::numeric_limits<Handle>::max(); // "not in the pool"
+
+private:
+    static constexpr unsigned first_chunk_bits = 8; // 256 strings in chunk 0
+    static constexpr std::size_t chunk_count = 25;  // enough for every handle below npos
+
+    std::unique_ptr<std::string[]> chunks_[chunk_count];
+    std::atomic<std::size_t> size_{0};
+    std::unordered_map<std::string_view, Handle> lookup_; // keys view into the chunks
+
+    std::string& slot(std::size_t handle) const;
+
+public:
+    StringPool() = default;
+    // lookup_ points into the chunks, so the pool is pinned in place
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    Handle intern(std::string_view s);      // existing handle, or adds the string
+    Handle find(std::string_view s) const;  // npos if the string was never interned
+    const std::string& str(Handle handle) const;
+
+    std::size_t size() const; // distinct strings
+    void clear();             // invalidates every handle
+};
+
+#endif //PROFILEMANAGERCLI_STRINGPOOL_HPP
@@ -1,13 +1,310 @@
+#include <chrono>
+#include <cstdlib> // std::atoi
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "domain/StringPool.hpp"
 #include "service/ProfileStore.hpp"
+#include "persistence/CompressedSnapshot.hpp"
+#include "persistence/DeltaSegments.hpp"
+#include "persistence/ProfileExporter.hpp"
+#include "persistence/ProfileSerializer.hpp"
+#include "persistence/WriteAheadLog.hpp"
+#include "cli/BatchRunner.hpp"
 #include "cli/Menu.hpp"
+#include "cli/ProfileListing.hpp"
 
-int main()
+namespace
 {
+    void print_usage()
+    {
+        std::cerr << "Usage:\n"
+                  << "  ProfileManagerCLI                                   interactive menu\n"
+                  << "  ProfileManagerCLI --unique-hobbies                  interactive menu; a profile cannot list a hobby twice\n"
+                  << "  ProfileManagerCLI --convert <in> <out> <text|binary|compressed>\n"
+                  << "                                                      rewrite a snapshot in another format\n"
+                  << "  ProfileManagerCLI --fetch <file> <id>               print one profile of a compressed snapshot\n"
+                  << "  ProfileManagerCLI --merge <file>                    fold <file>.delta (delta saves) into <file>\n"
+                  << "  ProfileManagerCLI --wal <log>                       interactive menu; every change is appended to <log>\n"
+                  << "  ProfileManagerCLI --open <file>                     interactive menu on a snapshot read lazily (records parsed on first use)\n"
+                  << "  ProfileManagerCLI --export <in> <out> <json|csv>    write a snapshot as JSON or CSV\n"
+                  << "  ProfileManagerCLI --list <file>                     print \"- [id] name\" for every profile in a snapshot\n"
+                  << "  ProfileManagerCLI --batch <file|->                  run commands from a file (- = stdin) without prompts\n"
+                  << "  ProfileManagerCLI --scan-bench <file> <rows|columnar> [rounds]\n"
+                  << "                                                      time full-store scans in one storage layout\n";
+    }
+
+    // Non-interactive conversion between PMCLI1 (text), PMCLI2 (binary) and PMCLI3 (compressed) snapshots
+    int run_convert(const std::string& input, const std::string& output, const std::string& format_name)
+    {
+        SnapshotFormat format;
+        if (format_name == "text") format = SnapshotFormat::Text;
+        else if (format_name == "binary") format = SnapshotFormat::Binary;
+        else if (format_name == "compressed") format = SnapshotFormat::Compressed;
+        else
+        {
+            print_usage();
+            return 2;
+        }
+
+        if (!ProfileSerializer::convert(input, output, format))
+        {
+            std::cerr << "Failed to convert " << input << " to " << output << "\n";
+            return 1;
+        }
+        std::cout << "Converted " << input << " -> " << output << " (" << format_name << ")\n";
+        return 0;
+    }
+
+    // Looks up one profile in a PMCLI3 snapshot; only the block whose id range covers it is inflated
+    int run_fetch(const std::string& path, const std::string& id_text)
+    {
+        CompressedSnapshot::Reader reader;
+        if (!reader.open(path))
+        {
+            std::cerr << "Failed to open " << path << " (not a compressed snapshot?)\n";
+            return 1;
+        }
+
+        StringPool strings;
+        const std::optional<Profile> profile = reader.fetch(std::atoi(id_text.c_str()), strings);
+        if (!profile)
+        {
+            std::cerr << "Profile " << id_text << " not found in " << path << "\n";
+            return 1;
+        }
+
+        std::cout << profile->to_string();
+        return 0;
+    }
+
+    // Rewrites a snapshot with its delta segments applied, so the next load reads one file again
+    int run_merge(const std::string& path)
+    {
+        if (!ProfileSerializer::merge(path))
+        {
+            std::cerr << "Failed to merge " << path << " (missing file, invalid format or damaged delta)\n";
+            return 1;
+        }
+        std::cout << "Merged " << DeltaSegments::path_for(path) << " into " << path << "\n";
+        return 0;
+    }
+
+    // Snapshot (any format) -> JSON or CSV export
+    int run_export(const std::string& input, const std::string& output, const std::string& format_name)
+    {
+        ExportFormat format;
+        if (format_name == "json") format = ExportFormat::Json;
+        else if (format_name == "csv") format = ExportFormat::Csv;
+        else
+        {
+            print_usage();
+            return 2;
+        }
+
+        ProfileStore store;
+        store.set_indexing(false); // only passes through
+        store.set_allocation_mode(AllocationMode::Arena); // loaded once, never edited
+        if (!ProfileSerializer::load_parallel(store, input))
+        {
+            std::cerr << "Failed to load " << input << "\n";
+            return 1;
+        }
+        if (!ProfileExporter::write(store, output, format))
+        {
+            std::cerr << "Failed to write " << output << "\n";
+            return 1;
+        }
+        std::cout << "Exported " << store.size() << " profiles to " << output << " (" << format_name << ")\n";
+        return 0;
+    }
+
+    // Non-interactive listing of a snapshot, written through one large buffer
+    int run_list(const std::string& path)
+    {
+        std::ios::sync_with_stdio(false);
+
+        ProfileStore store;
+        store.set_indexing(false); // listing only
+        store.set_allocation_mode(AllocationMode::Arena); // loaded once, never edited
+        if (!ProfileSerializer::load_parallel(store, path))
+        {
+            std::cerr << "Failed to load " << path << "\n";
+            return 1;
+        }
+        write_listing(store, std::cout);
+        return 0;
+    }
+
+    // Runs a command script against an empty store. Results go to stdout, the throughput summary to stderr
+    int run_batch(const std::string& path)
+    {
+        std::ios::sync_with_stdio(false); // no interleaving with C stdio here, so skip the per-call sync
+
+        std::ifstream file;
+        if (path != "-")
+        {
+            file.open(path);
+            if (!file)
+            {
+                std::cerr << "Failed to open " << path << "\n";
+                return 1;
+            }
+        }
+        std::istream& in = (path == "-") ? std::cin : file;
+
+        ProfileStore store;
+        BatchRunner runner(store);
+        const BatchStats stats = runner.run(in, std::cout);
+
+        std::cerr << "Batch: " << stats.commands << " commands (" << stats.failed << " failed) in "
+                  << stats.seconds << " s (" << stats.commands_per_sec() << " commands/s)\n";
+        return stats.failed == 0 ? 0 : 1;
+    }
+
+    // Loads a snapshot and times analytics-style full scans (age ranges, per-country counts)
+    // against the chosen storage layout, so the two layouts can be compared on the same data.
+    int run_scan_bench(const std::string& path, const std::string& layout_name, int rounds)
+    {
+        StorageLayout layout;
+        if (layout_name == "rows") layout = StorageLayout::Rows;
+        else if (layout_name == "columnar") layout = StorageLayout::Columnar;
+        else
+        {
+            print_usage();
+            return 2;
+        }
+        if (rounds <= 0) rounds = 1;
+
+        ProfileStore store;
+        store.set_indexing(false); // scans only; the indexes would just cost load time
+        if (!ProfileSerializer::load_parallel(store, path))
+        {
+            std::cerr << "Failed to load " << path << "\n";
+            return 1;
+        }
+        store.set_layout(layout);
+
+        // Scan the most common country, so the filtered scan actually finds rows
+        const std::vector<std::size_t> initial = store.scan_country_counts();
+        std::string country;
+        std::size_t best = 0;
+        for (std::size_t h = 0; h < initial.size(); ++h)
+        {
+            if (initial[h] > best)
+            {
+                best = initial[h];
+                country = store.strings().str(static_cast<StringPool::Handle>(h));
+            }
+        }
+
+        std::size_t checksum = 0; // keeps the optimiser from dropping the scans
+        const auto started = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+        {
+            const int low = (r * 7) % 60;
+            checksum += store.scan_count_age_between(low, low + 20);
+            checksum += store.scan_count_in_country(country, low, low + 40);
+            checksum += store.scan_country_counts().size();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        const double scans = 3.0 * rounds;
+        std::cout << "Layout: " << layout_name << "\n"
+                  << "Profiles: " << store.size() << "\n"
+                  << "Scans: " << static_cast<long long>(scans) << " in " << seconds << " s ("
+                  << (seconds > 0 ? scans * store.size() / seconds / 1e6 : 0.0) << " M rows/s)\n"
+                  << "Checksum: " << checksum << "\n";
+        return 0;
+    }
+
+    // Interactive session on a lazily opened snapshot: the menu is ready as soon as the id index is mapped,
+    // and only the profiles that are actually looked at get parsed
+    int run_open(const std::string& path)
+    {
+        ProfileStore store;
+        LoadStats stats;
+        if (!ProfileSerializer::open_lazy(store, path, &stats))
+        {
+            std::cerr << "Failed to open " << path << "\n";
+            return 1;
+        }
+        std::cout << "Opened " << path << ": " << stats.profiles << " profiles in " << stats.seconds << " s"
+                  << (store.lazy() ? " (records are read on first access)" : "") << "\n";
+        if (stats.delta_ignored)
+        {
+            std::cerr << "Warning: " << DeltaSegments::path_for(path) << " is damaged and was not applied\n";
+        }
+
+        Menu menu(store);
+        menu.run();
+        return 0;
+    }
+
+    // Interactive session backed by a write-ahead log: the state is recovered from the log on start,
+    // every edit is appended as it happens, and the log is compacted into a snapshot in the background.
+    int run_with_wal(const std::string& log_path)
+    {
+        ProfileStore store;
+        WriteAheadLog wal;
+        if (!wal.open(log_path, store))
+        {
+            std::cerr << "Failed to open write-ahead log " << log_path << "\n";
+            return 1;
+        }
+        std::cout << "Recovered " << store.size() << " profiles from " << log_path
+                  << " (" << wal.replayed_records() << " log records replayed)\n";
+
+        Menu menu(store);
+        menu.run();
+
+        const bool durable = wal.sync();
+        wal.close();
+        if (!durable)
+        {
+            std::cerr << "Warning: some changes could not be written to " << log_path << "\n";
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        const std::string command = argv[1];
+        if (command == "--unique-hobbies" && argc == 2)
+        {
+            ProfileStore store;
+            store.set_unique_hobbies(true);
+            Menu menu(store);
+            menu.run();
+            return 0;
+        }
+        if (command == "--convert" && argc == 5) return run_convert(argv[2], argv[3], argv[4]);
+        if (command == "--fetch" && argc == 4) return run_fetch(argv[2], argv[3]);
+        if (command == "--merge" && argc == 3) return run_merge(argv[2]);
+        if (command == "--wal" && argc == 3) return run_with_wal(argv[2]);
+        if (command == "--open" && argc == 3) return run_open(argv[2]);
+        if (command == "--export" && argc == 5) return run_export(argv[2], argv[3], argv[4]);
+        if (command == "--list" && argc == 3) return run_list(argv[2]);
+        if (command == "--batch" && argc == 3) return run_batch(argv[2]);
+        if (command == "--scan-bench" && (argc == 4 || argc == 5))
+        {
+            return run_scan_bench(argv[2], argv[3], argc == 5 ? std::atoi(argv[4]) : 20);
+        }
+
+        print_usage();
+        return 2;
+    }
+
     ProfileStore store;
 
     Menu menu(store);
     menu.run();
     return 0;
 
-}
\ No newline at end of file
+}
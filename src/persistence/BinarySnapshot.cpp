@@ -0,0 +1,247 @@
+#include "BinarySnapshot.hpp"
+#include "../service/ProfileStore.hpp"
+#include "../domain/Profile.hpp"
+#include "BufferedWriter.hpp"
+#include "ByteOrder.hpp"
+
+#include <cstdint>
+#include <cstring> // std::memcmp, std::memcpy
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// BinarySnapshot: PMCLI2 writer/reader (layout documented in the header)
+
+namespace
+{
+    using namespace byte_order;
+
+    constexpr char magic[8] = {'P', 'M', 'C', 'L', 'I', '2', '\n', '\0'};
+    constexpr std::uint32_t layout_version = 1;
+
+    constexpr std::size_t header_size = 40;        // magic + version + string count + record count + table offset + string bytes
+    constexpr std::size_t record_fixed_size = 24;  // id, age, name, city, country, hobby count
+
+    // Assigns table indices to distinct strings in first-seen order.
+    // Profiles are only guaranteed to live while they are being visited (a concurrent snapshot may
+    // hand out a profile that is changed right afterwards), so each new string is copied into
+    // large blocks owned by the table and the keys view those copies.
+    class StringTable
+    {
+    private:
+        static constexpr std::size_t block_size = 1 << 16;
+
+        std::unordered_map<std::string_view, std::uint32_t> index_;
+        std::vector<std::string_view> strings_;
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        std::size_t block_used_ = block_size;
+
+        std::string_view keep(std::string_view s)
+        {
+            if (s.size() >= block_size)
+            {
+                // Oversized strings get a block of their own; the next string starts a fresh block
+                blocks_.push_back(std::make_unique<char[]>(s.size()));
+                block_used_ = block_size;
+                std::memcpy(blocks_.back().get(), s.data(), s.size());
+                return std::string_view(blocks_.back().get(), s.size());
+            }
+            if (blocks_.empty() || s.size() > block_size - block_used_)
+            {
+                blocks_.push_back(std::make_unique<char[]>(block_size));
+                block_used_ = 0;
+            }
+            char* dst = blocks_.back().get() + block_used_;
+            std::memcpy(dst, s.data(), s.size());
+            block_used_ += s.size();
+            return std::string_view(dst, s.size());
+        }
+
+    public:
+        std::uint32_t intern(std::string_view s)
+        {
+            auto it = index_.find(s);
+            if (it != index_.end()) return it->second;
+
+            const auto index = static_cast<std::uint32_t>(strings_.size());
+            const std::string_view kept = keep(s);
+            index_.emplace(kept, index);
+            strings_.push_back(kept);
+            return index;
+        }
+
+        const std::vector<std::string_view>& strings() const { return strings_; }
+    };
+}
+
+bool BinarySnapshot::matches(std::string_view data)
+{
+    return data.size() >= sizeof(magic) && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+bool BinarySnapshot::save(const ProfileSource& source, const std::string& path)
+{
+    BufferedWriter out;
+    if (!out.open(path)) return false;
+
+    // Records are streamed first and the string table is appended afterwards,
+    // so we never hold the whole file in memory. The header is patched at the end.
+    out.append(std::string(header_size, '\0'));
+    StringTable table;
+    std::uint64_t record_count = 0;
+    std::string record; // reused scratch for one encoded record
+
+    auto write_record = [&](const Profile& p)
+    {
+        const auto& hobbies = p.hobbies();
+        record.clear();
+        put_u32(record, static_cast<std::uint32_t>(record_fixed_size + 4 * hobbies.size()));
+        put_u32(record, static_cast<std::uint32_t>(p.id()));
+        put_u32(record, static_cast<std::uint32_t>(p.age()));
+        put_u32(record, table.intern(p.name()));
+        put_u32(record, table.intern(p.city()));
+        put_u32(record, table.intern(p.country()));
+        put_u32(record, static_cast<std::uint32_t>(hobbies.size()));
+        for (const auto& hobby : hobbies)
+        {
+            put_u32(record, table.intern(hobby));
+        }
+        out.append(record);
+        ++record_count;
+    };
+
+    source(write_record);
+
+    const std::uint64_t table_offset = out.bytes_written();
+    const auto& strings = table.strings();
+
+    // Offsets table: string i spans [offsets[i], offsets[i + 1]) inside the string bytes
+    std::string offsets;
+    std::uint64_t offset = 0;
+    for (std::string_view s : strings)
+    {
+        put_u64(offsets, offset);
+        offset += s.size();
+    }
+    put_u64(offsets, offset);
+    out.append(offsets);
+
+    for (std::string_view s : strings)
+    {
+        out.append(s);
+    }
+
+    // Now that all counts are known, fill in the header
+    std::string header(magic, sizeof(magic));
+    put_u32(header, layout_version);
+    put_u32(header, static_cast<std::uint32_t>(strings.size()));
+    put_u64(header, record_count);
+    put_u64(header, table_offset);
+    put_u64(header, offset);
+
+    if (!out.patch(0, header)) return false;
+    return out.close();
+}
+
+bool BinarySnapshot::load(ProfileStore& store, std::string_view data, std::size_t& loaded)
+{
+    loaded = 0;
+    if (data.size() < header_size || !matches(data)) return false;
+
+    const char* base = data.data();
+    if (get_u32(base + 8) != layout_version) return false;
+
+    const std::uint64_t string_count = get_u32(base + 12);
+    const std::uint64_t record_count = get_u64(base + 16);
+    const std::uint64_t table_offset = get_u64(base + 24);
+    const std::uint64_t string_bytes = get_u64(base + 32);
+
+    // Validate the string table bounds (written so that none of the additions can overflow)
+    if (table_offset < header_size || table_offset > data.size()) return false;
+    const std::uint64_t offsets_size = (string_count + 1) * 8;
+    if (offsets_size > data.size() - table_offset) return false;
+    if (string_bytes != data.size() - table_offset - offsets_size) return false;
+
+    const char* offsets = base + table_offset;
+    const char* blob = offsets + offsets_size;
+
+    std::vector<std::string_view> strings;
+    strings.reserve(string_count);
+    std::uint64_t previous = get_u64(offsets);
+    if (previous != 0) return false;
+    for (std::uint64_t i = 1; i <= string_count; ++i)
+    {
+        const std::uint64_t next = get_u64(offsets + i * 8);
+        if (next < previous || next > string_bytes) return false;
+        strings.emplace_back(blob + previous, next - previous);
+        previous = next;
+    }
+    if (previous != string_bytes) return false;
+
+    // First pass: walk every record and check lengths and string references,
+    // so a corrupt file is rejected before we clear the in-memory store.
+    const char* records_end = base + table_offset;
+    {
+        const char* cursor = base + header_size;
+        for (std::uint64_t r = 0; r < record_count; ++r)
+        {
+            if (records_end - cursor < 4) return false;
+            const std::uint32_t payload = get_u32(cursor);
+            cursor += 4;
+            if (payload < record_fixed_size || payload > static_cast<std::uint64_t>(records_end - cursor)) return false;
+
+            const std::uint32_t hobby_count = get_u32(cursor + 20);
+            if (hobby_count > (payload - record_fixed_size) / 4) return false;
+
+            for (std::uint64_t field = 0; field < 3 + static_cast<std::uint64_t>(hobby_count); ++field)
+            {
+                // name/city/country live at +8..+16, hobbies start at +24
+                const char* ref = field < 3 ? cursor + 8 + field * 4 : cursor + record_fixed_size + (field - 3) * 4;
+                if (get_u32(ref) >= string_count) return false;
+            }
+            cursor += payload;
+        }
+        if (cursor != records_end) return false;
+    }
+
+    // Replace in-memory data with disk data
+    store.clear();
+
+    // Table strings are interned into the store's pool on first use, so every distinct
+    // city/country/hobby costs one hash lookup per file instead of one per record.
+    StringPool& pool = store.strings();
+    std::vector<StringPool::Handle> handles(string_count, StringPool::npos);
+    auto handle_of = [&](std::uint32_t index)
+    {
+        StringPool::Handle& handle = handles[index];
+        if (handle == StringPool::npos) handle = pool.intern(strings[index]);
+        return handle;
+    };
+
+    store.reserve(static_cast<std::size_t>(record_count));
+
+    const char* cursor = base + header_size;
+    for (std::uint64_t r = 0; r < record_count; ++r)
+    {
+        const std::uint32_t payload = get_u32(cursor);
+        const char* rec = cursor + 4;
+        cursor = rec + payload;
+
+        const auto id = static_cast<int>(get_u32(rec));
+        const auto age = static_cast<int>(get_u32(rec + 4));
+        const std::string_view name = strings[get_u32(rec + 8)]; // copied once, straight into the Profile
+
+        Profile p(id, name, age, handle_of(get_u32(rec + 12)), handle_of(get_u32(rec + 16)), pool);
+
+        const std::uint32_t hobby_count = get_u32(rec + 20);
+        for (std::uint32_t h = 0; h < hobby_count; ++h)
+        {
+            p.add_hobby(handle_of(get_u32(rec + record_fixed_size + h * 4)));
+        }
+
+        // Moved straight into its table slot; duplicate ids are skipped
+        if (store.insert_profile(std::move(p))) ++loaded;
+    }
+
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef PROFILEMANAGERCLI_BINARYSNAPSHOT_HPP
+#define PROFILEMANAGERCLI_BINARYSNAPSHOT_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "ProfileSerializer.hpp" // ProfileSource
+
+class ProfileStore;
+
+// PMCLI2: binary snapshot format (all integers little-endian)
+//
+//   header       "PMCLI2\n\0" | u32 layout version | u32 string count | u64 record count
+//                | u64 string table offset | u64 string bytes
+//   records      u32 payload length | i32 id | i32 age | u32 name | u32 city | u32 country
+//                | u32 hobby count | u32 hobby[hobby count]
+//   string table u64 offsets[string count + 1] followed by the concatenated string bytes
+//
+// Every text value is stored once in the string table and referenced by index, so nothing is escaped
+// and loading is mostly bounds checks plus copies. The payload length lets newer writers append fields
+// that older readers simply skip. The string table comes last so records can be streamed while saving.
+class BinarySnapshot
+{
+    public:
+        // True if the bytes start with the PMCLI2 magic
+        static bool matches(std::string_view data);
+
+        // Write every profile `source` visits as PMCLI2. Return true on success
+        static bool save(const ProfileSource& source, const std::string& path);
+
+        // Parse a PMCLI2 image into store (overwrites existing in-memory store).
+        // The image is validated completely before the store is touched; returns false if it is corrupt.
+        // `loaded` receives the number of profiles inserted.
+        static bool load(ProfileStore& store, std::string_view data, std::size_t& loaded);
+};
+
+#endif //PROFILEMANAGERCLI_BINARYSNAPSHOT_HPP
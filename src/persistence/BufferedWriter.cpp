@@ -0,0 +1,85 @@
+#include "BufferedWriter.hpp"
+
+#include <charconv> // std::to_chars
+#include <cstring>  // std::memcpy
+
+// BufferedWriter: big-buffer file output used by the serializers
+
+BufferedWriter::BufferedWriter(std::size_t capacity) : buffer_(capacity > 0 ? capacity : default_capacity) {}
+
+bool BufferedWriter::open(const std::string& path, bool append)
+{
+    out_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    used_ = 0;
+    flushed_ = 0;
+    return static_cast<bool>(out_);
+}
+
+char* BufferedWriter::reserve(std::size_t n)
+{
+    if (buffer_.size() - used_ < n)
+    {
+        flush();
+        // A single value larger than the whole buffer: grow once rather than failing
+        if (buffer_.size() < n) buffer_.resize(n);
+    }
+    return buffer_.data() + used_;
+}
+
+void BufferedWriter::commit(std::size_t n)
+{
+    used_ += n;
+}
+
+void BufferedWriter::append(std::string_view s)
+{
+    char* dst = reserve(s.size());
+    std::memcpy(dst, s.data(), s.size());
+    commit(s.size());
+}
+
+void BufferedWriter::append(char ch)
+{
+    *reserve(1) = ch;
+    commit(1);
+}
+
+void BufferedWriter::append_int(long long value)
+{
+    constexpr std::size_t max_digits = 20; // sign + 19 digits of a 64-bit value
+    char* dst = reserve(max_digits);
+    auto result = std::to_chars(dst, dst + max_digits, value);
+    commit(static_cast<std::size_t>(result.ptr - dst));
+}
+
+bool BufferedWriter::patch(std::uint64_t offset, std::string_view bytes)
+{
+    if (!flush()) return false;
+    out_.seekp(static_cast<std::streamoff>(offset));
+    out_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out_.seekp(0, std::ios::end);
+    return static_cast<bool>(out_);
+}
+
+std::uint64_t BufferedWriter::bytes_written() const
+{
+    return flushed_ + used_;
+}
+
+bool BufferedWriter::flush()
+{
+    if (used_ > 0)
+    {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        flushed_ += used_;
+        used_ = 0;
+    }
+    return static_cast<bool>(out_);
+}
+
+bool BufferedWriter::close()
+{
+    const bool ok = flush();
+    out_.close();
+    return ok && !out_.fail();
+}
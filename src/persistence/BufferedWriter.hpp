@@ -0,0 +1,50 @@
+#ifndef PROFILEMANAGERCLI_BUFFEREDWRITER_HPP
+#define PROFILEMANAGERCLI_BUFFEREDWRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Output file with one large, reusable buffer in front of it.
+// Callers append (or reserve space and write directly into the buffer), and the bytes reach the file
+// in a few big write() calls instead of one stream insertion per field.
+class BufferedWriter
+{
+private:
+    std::ofstream out_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t flushed_ = 0; // bytes already handed to the file
+
+public:
+    static constexpr std::size_t default_capacity = 1 << 20; // 1 MiB
+
+    explicit BufferedWriter(std::size_t capacity = default_capacity);
+
+    // Opens (truncates) the file in binary mode. Returns false if it cannot be created.
+    // With append = true existing contents are kept and every write goes to the end
+    // (bytes_written() counts appended bytes only, and patch() cannot be used).
+    bool open(const std::string& path, bool append = false);
+
+    // Returns a pointer where at least n bytes may be written; follow with commit(bytes actually written).
+    // Flushes (or grows the buffer for oversized requests) when the free space is too small.
+    char* reserve(std::size_t n);
+    void commit(std::size_t n);
+
+    void append(std::string_view s);
+    void append(char ch);
+    void append_int(long long value); // decimal, via std::to_chars
+
+    // Overwrite bytes that were already written earlier (e.g. a header whose counts are known only at the end)
+    bool patch(std::uint64_t offset, std::string_view bytes);
+
+    std::uint64_t bytes_written() const; // flushed + buffered
+
+    bool flush();
+    bool close(); // flush and close; returns false if any write failed
+};
+
+#endif //PROFILEMANAGERCLI_BUFFEREDWRITER_HPP
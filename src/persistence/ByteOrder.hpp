@@ -0,0 +1,38 @@
+#ifndef PROFILEMANAGERCLI_BYTEORDER_HPP
+#define PROFILEMANAGERCLI_BYTEORDER_HPP
+
+#include <cstdint>
+#include <string>
+
+// Little-endian integer encoding shared by the binary file formats.
+// Done with shifts so the on-disk layout does not depend on the host;
+// compilers turn these into plain loads/stores on little-endian machines.
+namespace byte_order
+{
+    inline void put_u32(std::string& out, std::uint32_t v)
+    {
+        const char bytes[4] = {static_cast<char>(v), static_cast<char>(v >> 8),
+                               static_cast<char>(v >> 16), static_cast<char>(v >> 24)};
+        out.append(bytes, 4);
+    }
+
+    inline void put_u64(std::string& out, std::uint64_t v)
+    {
+        put_u32(out, static_cast<std::uint32_t>(v));
+        put_u32(out, static_cast<std::uint32_t>(v >> 32));
+    }
+
+    inline std::uint32_t get_u32(const char* p)
+    {
+        const auto* b = reinterpret_cast<const unsigned char*>(p);
+        return static_cast<std::uint32_t>(b[0]) | (static_cast<std::uint32_t>(b[1]) << 8) |
+               (static_cast<std::uint32_t>(b[2]) << 16) | (static_cast<std::uint32_t>(b[3]) << 24);
+    }
+
+    inline std::uint64_t get_u64(const char* p)
+    {
+        return static_cast<std::uint64_t>(get_u32(p)) | (static_cast<std::uint64_t>(get_u32(p + 4)) << 32);
+    }
+}
+
+#endif //PROFILEMANAGERCLI_BYTEORDER_HPP
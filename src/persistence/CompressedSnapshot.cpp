@@ -0,0 +1,317 @@
+#include "CompressedSnapshot.hpp"
+#include "../service/ProfileStore.hpp"
+#include "../domain/StringPool.hpp"
+#include "BufferedWriter.hpp"
+#include "ByteOrder.hpp"
+#include "Lz.hpp"
+#include "TextRecords.hpp"
+#include "../util/ThreadPool.hpp"
+
+#include <algorithm> // std::min, std::max, std::partition_point
+#include <cstring> // std::memcmp
+#include <future>
+
+// CompressedSnapshot: PMCLI3 writer/reader (layout documented in the header)
+
+namespace
+{
+    using namespace byte_order;
+    using Block = CompressedSnapshot::Block;
+
+    constexpr char magic[8] = {'P', 'M', 'C', 'L', 'I', '3', '\n', '\0'};
+    constexpr std::uint32_t layout_version = 1;
+
+    constexpr std::size_t header_size = 32;      // magic + version + block count + record count + index offset
+    constexpr std::size_t index_entry_size = 28; // offset, compressed size, raw size, records, min id, max id
+
+    // Reads and validates the header and block index, so callers can trust every block's bounds
+    bool read_index(std::string_view data, std::vector<Block>& blocks, std::uint64_t& record_count)
+    {
+        if (data.size() < header_size || std::memcmp(data.data(), magic, sizeof(magic)) != 0) return false;
+
+        const char* base = data.data();
+        if (get_u32(base + 8) != layout_version) return false;
+
+        const std::uint64_t block_count = get_u32(base + 12);
+        record_count = get_u64(base + 16);
+        const std::uint64_t index_offset = get_u64(base + 24);
+
+        // The index is the last thing in the file (written so that none of the checks can overflow)
+        if (index_offset < header_size || index_offset > data.size()) return false;
+        if (block_count * index_entry_size != data.size() - index_offset) return false;
+
+        blocks.clear();
+        blocks.reserve(block_count);
+        std::uint64_t records = 0;
+        const char* entry = base + index_offset;
+        for (std::uint64_t i = 0; i < block_count; ++i, entry += index_entry_size)
+        {
+            Block block;
+            block.offset = get_u64(entry);
+            block.compressed_size = get_u32(entry + 8);
+            block.raw_size = get_u32(entry + 12);
+            block.records = get_u32(entry + 16);
+            block.min_id = static_cast<int>(get_u32(entry + 20));
+            block.max_id = static_cast<int>(get_u32(entry + 24));
+
+            if (block.offset < header_size || block.offset > index_offset) return false;
+            if (block.compressed_size > index_offset - block.offset) return false;
+            // A token can expand to at most ~255 output bytes per input byte; anything larger is corrupt
+            // and would only make us allocate a huge buffer before failing.
+            if (block.raw_size > static_cast<std::uint64_t>(block.compressed_size) * 255 + 64) return false;
+            if (block.min_id > block.max_id) return false;
+
+            records += block.records;
+            blocks.push_back(block);
+        }
+        return records == record_count;
+    }
+
+    bool inflate(std::string_view data, const Block& block, std::string& raw)
+    {
+        raw.resize(block.raw_size);
+        return lz::decompress(data.substr(block.offset, block.compressed_size), raw.data(), raw.size());
+    }
+
+    // Blocks [first, last) inflated and parsed in file order, interned into a pool of their own
+    struct ParsedRange
+    {
+        StringPool strings;
+        std::vector<Profile> profiles;
+        bool ok = false;
+    };
+
+    void parse_range(std::string_view data, const std::vector<Block>& blocks, std::size_t first, std::size_t last,
+                     ParsedRange& out)
+    {
+        std::size_t expected = 0;
+        for (std::size_t b = first; b < last; ++b) expected += blocks[b].records;
+        out.profiles.reserve(expected);
+
+        std::string raw; // reused for every block of the range
+        text_records::RecordScratch scratch;
+        for (std::size_t b = first; b < last; ++b)
+        {
+            if (!inflate(data, blocks[b], raw)) return;
+            text_records::parse_lines(raw, scratch, out.strings, [&](Profile& p) { out.profiles.push_back(std::move(p)); });
+        }
+        // Every saved line is a well-formed record, so a short count means the block was damaged
+        out.ok = out.profiles.size() == expected;
+    }
+}
+
+bool CompressedSnapshot::matches(std::string_view data)
+{
+    return data.size() >= sizeof(magic) && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+bool CompressedSnapshot::save(const ProfileSource& source, const std::string& path)
+{
+    BufferedWriter out;
+    if (!out.open(path)) return false;
+
+    // Blocks are streamed as they fill up and the index is appended afterwards;
+    // the header is patched at the end once the counts are known.
+    out.append(std::string(header_size, '\0'));
+
+    std::vector<Block> blocks;
+    Block current;
+    std::uint64_t record_count = 0;
+    std::string raw;    // record lines of the block being filled
+    std::string packed; // its compressed form
+    raw.reserve(block_size + block_size / 4);
+    packed.reserve(lz::max_compressed_size(raw.capacity()));
+
+    auto finish_block = [&]()
+    {
+        if (current.records == 0) return;
+        packed.clear();
+        lz::compress(raw, packed);
+
+        current.offset = out.bytes_written();
+        current.compressed_size = static_cast<std::uint32_t>(packed.size());
+        current.raw_size = static_cast<std::uint32_t>(raw.size());
+        out.append(packed);
+
+        blocks.push_back(current);
+        current = Block();
+        raw.clear();
+    };
+
+    source([&](const Profile& p)
+    {
+        if (current.records == 0)
+        {
+            current.min_id = current.max_id = p.id();
+        }
+        else
+        {
+            current.min_id = std::min(current.min_id, p.id());
+            current.max_id = std::max(current.max_id, p.id());
+        }
+        text_records::append_record(raw, p);
+        ++current.records;
+        ++record_count;
+
+        if (raw.size() >= block_size) finish_block();
+    });
+    finish_block();
+
+    const std::uint64_t index_offset = out.bytes_written();
+    std::string index;
+    index.reserve(blocks.size() * index_entry_size);
+    for (const Block& block : blocks)
+    {
+        put_u64(index, block.offset);
+        put_u32(index, block.compressed_size);
+        put_u32(index, block.raw_size);
+        put_u32(index, block.records);
+        put_u32(index, static_cast<std::uint32_t>(block.min_id));
+        put_u32(index, static_cast<std::uint32_t>(block.max_id));
+    }
+    out.append(index);
+
+    std::string header(magic, sizeof(magic));
+    put_u32(header, layout_version);
+    put_u32(header, static_cast<std::uint32_t>(blocks.size()));
+    put_u64(header, record_count);
+    put_u64(header, index_offset);
+
+    if (!out.patch(0, header)) return false;
+    return out.close();
+}
+
+bool CompressedSnapshot::load(ProfileStore& store, std::string_view data, std::size_t& loaded, unsigned thread_count)
+{
+    loaded = 0;
+    std::vector<Block> blocks;
+    std::uint64_t record_count = 0;
+    if (!read_index(data, blocks, record_count)) return false;
+
+    // Contiguous block ranges, a few per thread so that uneven blocks still keep every worker busy
+    const unsigned threads = ThreadPool::resolve_thread_count(thread_count);
+    const std::size_t range_count = std::max<std::size_t>(1, std::min<std::size_t>(blocks.size(), threads * 4));
+    std::vector<ParsedRange> ranges(range_count);
+    auto range_begin = [&](std::size_t r) { return blocks.size() * r / range_count; };
+
+    if (threads == 1 || range_count == 1)
+    {
+        for (std::size_t r = 0; r < range_count; ++r) parse_range(data, blocks, range_begin(r), range_begin(r + 1), ranges[r]);
+    }
+    else
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> pending;
+        pending.reserve(range_count);
+        for (std::size_t r = 0; r < range_count; ++r)
+        {
+            pending.push_back(pool.submit([&, r]()
+            {
+                parse_range(data, blocks, range_begin(r), range_begin(r + 1), ranges[r]);
+            }));
+        }
+        for (auto& f : pending) f.get();
+    }
+
+    // Reject a damaged file before the store is touched
+    for (const ParsedRange& range : ranges)
+    {
+        if (!range.ok) return false;
+    }
+
+    // Merge in file order so duplicate ids resolve to the first occurrence, as in the text loader
+    store.clear();
+    store.reserve(static_cast<std::size_t>(record_count));
+
+    std::vector<StringPool::Handle> remap;
+    for (ParsedRange& range : ranges)
+    {
+        remap.assign(range.strings.size(), StringPool::npos);
+        for (Profile& p : range.profiles) p.rebind(store.strings(), remap);
+        loaded += store.insert_batch(range.profiles);
+        std::vector<Profile>().swap(range.profiles); // free each range as soon as it is merged
+        range.strings.clear();
+    }
+    return true;
+}
+
+bool CompressedSnapshot::Reader::open(const std::string& path)
+{
+    blocks_.clear();
+    record_count_ = 0;
+    if (!file_.open(path)) return false;
+    if (!read_index(file_.view(), blocks_, record_count_))
+    {
+        blocks_.clear();
+        return false;
+    }
+
+    ordered_ = true;
+    for (std::size_t i = 1; i < blocks_.size() && ordered_; ++i)
+    {
+        ordered_ = blocks_[i].min_id > blocks_[i - 1].max_id;
+    }
+    return true;
+}
+
+std::uint64_t CompressedSnapshot::Reader::record_count() const
+{
+    return record_count_;
+}
+
+const std::vector<CompressedSnapshot::Block>& CompressedSnapshot::Reader::blocks() const
+{
+    return blocks_;
+}
+
+std::optional<Profile> CompressedSnapshot::Reader::fetch(int id, StringPool& strings) const
+{
+    std::string raw;
+    text_records::RecordScratch scratch;
+
+    // Inflates one block and scans its lines; only the matching record becomes a Profile
+    auto search = [&](const Block& block) -> std::optional<Profile>
+    {
+        if (!inflate(file_.view(), block, raw)) return std::nullopt;
+
+        std::string_view text = raw;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            const size_t eol = text.find('\n', pos);
+            const std::string_view line = text.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+            pos = (eol == std::string_view::npos) ? text.size() : eol + 1;
+
+            // Only the id is read until the right line turns up
+            int line_id = 0;
+            if (!text_records::parse_id(line, line_id) || line_id != id) continue;
+
+            int age = 0;
+            std::string_view hobbies;
+            if (!text_records::decode_line(line, scratch, line_id, age, hobbies)) continue;
+
+            Profile p(line_id, scratch.name, age, scratch.city, scratch.country, strings);
+            text_records::add_hobbies(hobbies, scratch, p);
+            return p;
+        }
+        return std::nullopt;
+    };
+
+    if (ordered_)
+    {
+        // Ranges are disjoint and ascending: the first block ending at or after id is the only candidate
+        const auto it = std::partition_point(blocks_.begin(), blocks_.end(),
+                                             [id](const Block& block) { return block.max_id < id; });
+        if (it == blocks_.end() || it->min_id > id) return std::nullopt;
+        return search(*it);
+    }
+
+    // Unordered saves can overlap: try every block whose range covers id, in file order
+    for (const Block& block : blocks_)
+    {
+        if (id < block.min_id || id > block.max_id) continue;
+        std::optional<Profile> found = search(block);
+        if (found) return found;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,79 @@
+#ifndef PROFILEMANAGERCLI_COMPRESSEDSNAPSHOT_HPP
+#define PROFILEMANAGERCLI_COMPRESSEDSNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "ProfileSerializer.hpp" // ProfileSource
+#include "../domain/Profile.hpp"
+
+class ProfileStore;
+class StringPool;
+
+// PMCLI3: compressed snapshot container (all integers little-endian)
+//
+//   header  "PMCLI3\n\0" | u32 layout version | u32 block count | u64 record count | u64 index offset
+//   blocks  each block is ~64 KiB of PMCLI1 record lines (see TextRecords.hpp), compressed on its own (Lz.hpp)
+//   index   per block: u64 file offset | u32 compressed size | u32 raw size | u32 record count
+//           | i32 min id | i32 max id
+//
+// Blocks never share state, so a load can inflate them on several threads, and the index (written last,
+// like the PMCLI2 string table) tells a reader which blocks can hold a given id without touching the rest.
+// Saving in id order (the default) gives disjoint, ascending block ranges and a binary-searchable index.
+class CompressedSnapshot
+{
+    public:
+        // Records are cut into a new block once this many raw bytes have been collected.
+        // Small enough that fetching one profile inflates little, large enough to compress well.
+        static constexpr std::size_t block_size = 64 * 1024;
+
+        // One block index entry
+        struct Block
+        {
+            std::uint64_t offset = 0;
+            std::uint32_t compressed_size = 0;
+            std::uint32_t raw_size = 0;
+            std::uint32_t records = 0;
+            int min_id = 0;
+            int max_id = 0;
+        };
+
+        // True if the bytes start with the PMCLI3 magic
+        static bool matches(std::string_view data);
+
+        // Write every profile `source` visits as PMCLI3. Return true on success
+        static bool save(const ProfileSource& source, const std::string& path);
+
+        // Parse a PMCLI3 image into store (overwrites existing in-memory store).
+        // Blocks are inflated and parsed on `thread_count` threads (0 = all hardware threads), then merged
+        // in file order. Every block is checked before the store is touched; returns false if one is corrupt.
+        static bool load(ProfileStore& store, std::string_view data, std::size_t& loaded, unsigned thread_count = 0);
+
+        // Random access to one PMCLI3 file: the index is read once, every fetch() inflates a single block
+        class Reader
+        {
+            private:
+                MappedFile file_;
+                std::vector<Block> blocks_;
+                std::uint64_t record_count_ = 0;
+                bool ordered_ = false; // block id ranges ascending and disjoint (saved in id order)
+
+            public:
+                // Maps the file and validates its index. Returns false if it is missing or not a valid PMCLI3 file
+                bool open(const std::string& path);
+
+                std::uint64_t record_count() const;
+                const std::vector<Block>& blocks() const;
+
+                // The first record with this id (as load() would keep it), with its text interned into `strings`.
+                // Only blocks whose id range covers `id` are inflated. Empty if absent or the block is corrupt.
+                std::optional<Profile> fetch(int id, StringPool& strings) const;
+        };
+};
+
+#endif //PROFILEMANAGERCLI_COMPRESSEDSNAPSHOT_HPP
@@ -0,0 +1,59 @@
+#include "ContentHash.hpp"
+#include "ByteOrder.hpp"
+
+// content_hash: multiply-rotate lanes over little-endian words, then a final avalanche
+
+namespace
+{
+    constexpr std::uint64_t prime1 = 0x9e3779b185ebca87ull;
+    constexpr std::uint64_t prime2 = 0xc2b2ae3d27d4eb4full;
+    constexpr std::uint64_t prime3 = 0x165667b19e3779f9ull;
+
+    std::uint64_t rotate(std::uint64_t v, unsigned bits)
+    {
+        return (v << bits) | (v >> (64 - bits));
+    }
+
+    std::uint64_t mix(std::uint64_t lane, std::uint64_t word)
+    {
+        return rotate(lane + word * prime2, 31) * prime1;
+    }
+}
+
+std::uint64_t content_hash::of(std::string_view data)
+{
+    using byte_order::get_u64;
+
+    const char* p = data.data();
+    const char* const end = p + data.size();
+    std::uint64_t hash = 0;
+
+    if (data.size() >= 32)
+    {
+        std::uint64_t lanes[4] = {prime1 + prime2, prime2, 0, 0 - prime1};
+        for (; end - p >= 32; p += 32)
+        {
+            lanes[0] = mix(lanes[0], get_u64(p));
+            lanes[1] = mix(lanes[1], get_u64(p + 8));
+            lanes[2] = mix(lanes[2], get_u64(p + 16));
+            lanes[3] = mix(lanes[3], get_u64(p + 24));
+        }
+        hash = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+        for (std::uint64_t lane : lanes) hash = (hash ^ mix(0, lane)) * prime1 + prime3;
+    }
+    else
+    {
+        hash = prime3;
+    }
+    hash += static_cast<std::uint64_t>(data.size());
+
+    for (; end - p >= 8; p += 8) hash = rotate(hash ^ mix(0, get_u64(p)), 27) * prime1 + prime3;
+    for (; p < end; ++p) hash = rotate(hash ^ (static_cast<unsigned char>(*p) * prime3), 11) * prime1;
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,16 @@
+#ifndef PROFILEMANAGERCLI_CONTENTHASH_HPP
+#define PROFILEMANAGERCLI_CONTENTHASH_HPP
+
+#include <cstdint>
+#include <string_view>
+
+// 64-bit hash of a whole file's contents, used by the sidecar files (.idx, .delta) to recognise the
+// exact snapshot they were made for. A rewrite with the same size (and even the same mtime) changes it.
+// Not cryptographic. Reads 32 bytes per step in four independent lanes, so hashing runs at close to
+// memory speed; the result does not depend on the host's byte order.
+namespace content_hash
+{
+    std::uint64_t of(std::string_view data);
+}
+
+#endif //PROFILEMANAGERCLI_CONTENTHASH_HPP
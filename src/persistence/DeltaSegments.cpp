@@ -0,0 +1,277 @@
+#include "DeltaSegments.hpp"
+#include "../service/ProfileStore.hpp"
+#include "../domain/Profile.hpp"
+#include "BufferedWriter.hpp"
+#include "ContentHash.hpp"
+#include "FileSync.hpp"
+#include "MappedFile.hpp"
+#include "TextRecords.hpp"
+
+#include <algorithm> // std::sort
+#include <charconv> // std::from_chars, std::to_chars
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// DeltaSegments: append-only change segments next to a snapshot (format in the header)
+
+namespace
+{
+    constexpr std::string_view magic = "PMDELTA1";
+
+    // "<size>\t<hash>" of the snapshot. The hash covers every byte (ContentHash.hpp): a rewrite of the
+    // same size that only differs in the middle is still told apart from the snapshot the segments
+    // were made for. Hashing runs at close to memory speed, far below the cost of a full save.
+    bool fingerprint(const std::string& snapshot_path, std::string& out)
+    {
+        MappedFile file;
+        if (!file.open(snapshot_path)) return false;
+        const std::string_view data = file.view();
+        const std::uint64_t hash = content_hash::of(data);
+
+        char buffer[48];
+        char* end = std::to_chars(buffer, buffer + 24, static_cast<unsigned long long>(data.size())).ptr;
+        *end++ = '\t';
+        end = std::to_chars(end, buffer + sizeof(buffer), hash, 16).ptr;
+        out.assign(buffer, end);
+        return true;
+    }
+
+    // Next '\n'-terminated line starting at pos. A final line without '\n' is incomplete (torn write)
+    bool next_line(std::string_view data, std::size_t& pos, std::string_view& line)
+    {
+        const std::size_t eol = data.find('\n', pos);
+        if (eol == std::string_view::npos) return false;
+        line = data.substr(pos, eol - pos);
+        pos = eol + 1;
+        return true;
+    }
+
+    bool parse_count(std::string_view s, std::size_t& value)
+    {
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc() && ptr == s.data() + s.size() && ptr != s.data();
+    }
+
+    // One complete segment: its deleted ids and record lines (without the "U\t" prefix)
+    struct Segment
+    {
+        std::vector<int> deleted;
+        std::vector<std::string_view> records;
+    };
+
+    enum class SegmentRead
+    {
+        Complete,
+        Torn,    // the file ends inside it: an append that did not finish, ignored
+        Damaged  // a complete line that is not what the format allows: the file is corrupt
+    };
+
+    // Reads the segment starting at pos; pos moves past it only if it is complete.
+    // Appends only ever stop short at the end of the file, so running out of lines means torn,
+    // while a malformed line that is there in full means damage.
+    SegmentRead read_segment(std::string_view data, std::size_t& pos, Segment& segment,
+                             text_records::RecordScratch& scratch)
+    {
+        std::size_t cursor = pos;
+        std::string_view line;
+        if (!next_line(data, cursor, line)) return SegmentRead::Torn;
+        if (line.size() < 2 || line.substr(0, 2) != "S\t") return SegmentRead::Damaged;
+
+        const std::string_view counts = line.substr(2);
+        const std::size_t tab = counts.find('\t');
+        std::size_t deleted = 0;
+        std::size_t records = 0;
+        if (tab == std::string_view::npos || !parse_count(counts.substr(0, tab), deleted) ||
+            !parse_count(counts.substr(tab + 1), records))
+        {
+            return SegmentRead::Damaged;
+        }
+
+        segment.deleted.clear();
+        segment.records.clear();
+        for (std::size_t i = 0; i < deleted; ++i)
+        {
+            int id = 0;
+            if (!next_line(data, cursor, line)) return SegmentRead::Torn;
+            if (line.substr(0, 2) != "D\t" || !text_records::parse_id(line.substr(2), id)) return SegmentRead::Damaged;
+            segment.deleted.push_back(id);
+        }
+        for (std::size_t i = 0; i < records; ++i)
+        {
+            int id = 0;
+            int age = 0;
+            std::string_view hobbies;
+            if (!next_line(data, cursor, line)) return SegmentRead::Torn;
+            if (line.substr(0, 2) != "U\t" || !text_records::decode_line(line.substr(2), scratch, id, age, hobbies))
+            {
+                return SegmentRead::Damaged;
+            }
+            segment.records.push_back(line.substr(2));
+        }
+
+        pos = cursor;
+        return SegmentRead::Complete;
+    }
+
+    bool header_matches(std::string_view header, const std::string& fingerprint)
+    {
+        return header.substr(0, magic.size()) == magic && header.size() > magic.size() &&
+               header.substr(magic.size() + 1) == fingerprint;
+    }
+
+    // Reads every complete segment after the header. False if one of them is damaged; otherwise
+    // `end` is where the complete segments stop (anything after it is a torn append).
+    bool read_segments(std::string_view data, std::size_t pos, std::vector<Segment>& segments, std::size_t& end)
+    {
+        text_records::RecordScratch scratch;
+        Segment segment;
+        SegmentRead state;
+        while ((state = read_segment(data, pos, segment, scratch)) == SegmentRead::Complete)
+        {
+            segments.push_back(std::move(segment));
+        }
+        end = pos;
+        return state == SegmentRead::Torn;
+    }
+}
+
+std::string DeltaSegments::path_for(const std::string& snapshot_path)
+{
+    return snapshot_path + ".delta";
+}
+
+bool DeltaSegments::append(const ProfileStore& store, const std::string& snapshot_path,
+                           std::size_t& deleted, std::size_t& written)
+{
+    deleted = 0;
+    written = 0;
+
+    std::string print;
+    if (!fingerprint(snapshot_path, print)) return false;
+
+    // An existing delta must belong to this snapshot and be intact. A torn segment at its end is cut
+    // off first, otherwise the new segment would be glued onto half a line.
+    const std::string path = path_for(snapshot_path);
+    bool fresh = true;
+    {
+        MappedFile existing;
+        if (existing.open(path) && existing.size() > 0)
+        {
+            const std::string_view data = existing.view();
+            std::size_t pos = 0;
+            std::string_view header;
+            std::vector<Segment> segments;
+            std::size_t end = 0;
+            if (!next_line(data, pos, header) || !header_matches(header, print) ||
+                !read_segments(data, pos, segments, end))
+            {
+                return false;
+            }
+            fresh = false;
+            if (end != existing.size())
+            {
+                existing = MappedFile(); // unmap before truncating
+                std::error_code ec;
+                std::filesystem::resize_file(path, end, ec);
+                if (ec) return false;
+            }
+        }
+    }
+
+    // Sorted, so segments are stable and diff-friendly
+    const ChangeSet& changes = store.changes();
+    std::vector<int> removed(changes.deleted().begin(), changes.deleted().end());
+    std::vector<int> dirty(changes.dirty().begin(), changes.dirty().end());
+    std::sort(removed.begin(), removed.end());
+    std::sort(dirty.begin(), dirty.end());
+
+    BufferedWriter out;
+    if (!out.open(path, true)) return false;
+    if (fresh)
+    {
+        out.append(magic);
+        out.append('\t');
+        out.append(print);
+        out.append('\n');
+    }
+
+    out.append("S\t");
+    out.append_int(static_cast<long long>(removed.size()));
+    out.append('\t');
+    out.append_int(static_cast<long long>(dirty.size()));
+    out.append('\n');
+    for (int id : removed)
+    {
+        out.append("D\t");
+        out.append_int(id);
+        out.append('\n');
+    }
+    for (int id : dirty)
+    {
+        // Dirty ids always belong to stored profiles (remove() moves an id over to the deleted set)
+        const Profile* profile = store.find(id);
+        if (!profile) return false;
+        out.append("U\t");
+        text_records::write_record(out, *profile);
+    }
+
+    // On disk before the caller marks the store clean: the segment is the only copy of these changes
+    if (!out.close() || !file_sync::sync_existing_file(path)) return false;
+    if (fresh) file_sync::sync_directory(std::filesystem::path(path).parent_path());
+    deleted = removed.size();
+    written = dirty.size();
+    return true;
+}
+
+bool DeltaSegments::apply(ProfileStore& store, const std::string& snapshot_path, std::size_t& segments)
+{
+    segments = 0;
+
+    MappedFile file;
+    if (!file.open(path_for(snapshot_path)) || file.size() == 0) return true; // nothing saved incrementally
+
+    std::string print;
+    if (!fingerprint(snapshot_path, print)) return false;
+
+    const std::string_view data = file.view();
+    std::size_t pos = 0;
+    std::string_view header;
+    if (!next_line(data, pos, header) || !header_matches(header, print))
+    {
+        // Written for an older version of the snapshot: a full save or a merge replaced it and stopped
+        // before deleting the delta. Its changes are already in the snapshot, so it is dropped.
+        file = MappedFile();
+        std::error_code ec;
+        std::filesystem::remove(path_for(snapshot_path), ec);
+        return true;
+    }
+
+    // Everything is read and checked before the store changes, so a damaged file is never half applied
+    std::vector<Segment> pending;
+    std::size_t end = 0;
+    if (!read_segments(data, pos, pending, end)) return false;
+
+    text_records::RecordScratch scratch;
+    for (const Segment& segment : pending)
+    {
+        for (int id : segment.deleted) store.remove(id);
+
+        for (std::string_view line : segment.records)
+        {
+            int id = 0;
+            int age = 0;
+            std::string_view hobbies;
+            text_records::decode_line(line, scratch, id, age, hobbies); // checked by read_segment
+
+            Profile profile(id, scratch.name, age, scratch.city, scratch.country, store.strings());
+            text_records::add_hobbies(hobbies, scratch, profile);
+            store.remove(id); // the record replaces the stored one
+            store.insert_profile(std::move(profile));
+        }
+        ++segments;
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef PROFILEMANAGERCLI_DELTASEGMENTS_HPP
+#define PROFILEMANAGERCLI_DELTASEGMENTS_HPP
+
+#include <cstddef>
+#include <string>
+
+class ProfileStore;
+
+// Incremental saves: the changes since the last load/save are appended to "<snapshot>.delta" instead of
+// rewriting the snapshot. The file is text, one entry per line:
+//
+//   PMDELTA1\t<snapshot size>\t<snapshot fingerprint>   header, ties the segments to one snapshot file
+//   S\t<deleted count>\t<record count>                  segment header, then exactly that many lines of:
+//   D\t<id>                                             id removed
+//   U\t<PMCLI1 record>                                  id created or changed: its whole current record
+//
+// The fingerprint is the snapshot's size and a hash of all of its bytes. Loading applies complete
+// segments in order on top of the snapshot. A segment cut short by a crash during the append is
+// ignored (it never became part of the file's state); a malformed line anywhere else means the file
+// is damaged, and then none of it is applied. A full save or a merge writes a new snapshot and deletes
+// the delta file.
+class DeltaSegments
+{
+    public:
+        static std::string path_for(const std::string& snapshot_path);
+
+        // Appends one segment with store.changes() (deleted ids, then the current records of dirty ids).
+        // Fails if the snapshot is missing or the existing delta file is damaged or belongs to a different
+        // snapshot. The segment is synced to disk before this returns true.
+        // `deleted` / `written` receive the entry counts.
+        static bool append(const ProfileStore& store, const std::string& snapshot_path,
+                           std::size_t& deleted, std::size_t& written);
+
+        // Applies every complete segment on top of store (which must hold the snapshot's contents).
+        // No delta file is fine (segments = 0). A delta written for a different version of the snapshot
+        // (left behind by a full save that was interrupted before deleting it) is deleted unread.
+        // Returns false, with store untouched and the file left in place, if the delta is damaged or
+        // the snapshot cannot be read.
+        static bool apply(ProfileStore& store, const std::string& snapshot_path, std::size_t& segments);
+};
+
+#endif //PROFILEMANAGERCLI_DELTASEGMENTS_HPP
@@ -0,0 +1,46 @@
+#include "FileSync.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PMCLI_HAS_FSYNC 1
+    #include <fcntl.h>  // open (directory sync)
+    #include <unistd.h> // fsync, fdatasync
+#endif
+
+// file_sync: fsync/fdatasync wrappers
+
+bool file_sync::sync_file(std::FILE* file)
+{
+    if (std::fflush(file) != 0) return false;
+#ifdef PMCLI_HAS_FSYNC
+    #if defined(__linux__)
+    return fdatasync(fileno(file)) == 0;
+    #else
+    return fsync(fileno(file)) == 0;
+    #endif
+#else
+    return true;
+#endif
+}
+
+bool file_sync::sync_existing_file(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb+");
+    if (!file) return false;
+    const bool ok = sync_file(file);
+    return (std::fclose(file) == 0) && ok;
+}
+
+void file_sync::sync_directory(const std::filesystem::path& directory)
+{
+#ifdef PMCLI_HAS_FSYNC
+    const std::string dir = directory.empty() ? std::string(".") : directory.string();
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)directory;
+#endif
+}
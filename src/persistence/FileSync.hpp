@@ -0,0 +1,21 @@
+#ifndef PROFILEMANAGERCLI_FILESYNC_HPP
+#define PROFILEMANAGERCLI_FILESYNC_HPP
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+// Durability helpers shared by the write-ahead log and the delta files: push written bytes through
+// to the disk, and make a rename or a newly created file survive a crash. Without fsync support
+// (non-POSIX builds) they only flush.
+namespace file_sync
+{
+    // Flushes stdio buffers, then fdatasync (fsync outside Linux)
+    bool sync_file(std::FILE* file);
+    // Same for a file that was written through some other handle and closed
+    bool sync_existing_file(const std::string& path);
+    // Makes a rename, creation or removal inside `directory` durable (best effort)
+    void sync_directory(const std::filesystem::path& directory);
+}
+
+#endif //PROFILEMANAGERCLI_FILESYNC_HPP
@@ -0,0 +1,203 @@
+#include "IndexedSnapshot.hpp"
+#include "../domain/StringPool.hpp"
+#include "BufferedWriter.hpp"
+#include "ByteOrder.hpp"
+#include "ContentHash.hpp"
+#include "TextRecords.hpp"
+
+#include <algorithm> // std::stable_sort, std::unique
+#include <cstring> // std::memcmp
+#include <filesystem>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// IndexedSnapshot: lazily parsed PMCLI1 snapshot plus its id -> offset sidecar (layout in the header)
+
+namespace
+{
+    using namespace byte_order;
+
+    constexpr char magic[8] = {'P', 'M', 'I', 'D', 'X', '2', '\n', '\0'};
+    constexpr std::size_t header_size = 40; // magic + snapshot size + snapshot hash + entry count + entries hash
+    constexpr std::size_t entry_size = 12;  // id + offset
+}
+
+std::string IndexedSnapshot::index_path(const std::string& snapshot_path)
+{
+    return snapshot_path + ".idx";
+}
+
+bool IndexedSnapshot::open(const std::string& path)
+{
+    if (!file_.open(path)) return false;
+
+    std::string_view body;
+    if (!text_records::split_header(file_.view(), body)) return false;
+    body_ = body;
+
+    const std::uint64_t size = file_.size();
+    const std::uint64_t hash = content_hash::of(file_.view());
+    if (!read_sidecar(index_path(path), size, hash)) build(index_path(path), size, hash);
+    return true;
+}
+
+bool IndexedSnapshot::read_sidecar(const std::string& path, std::uint64_t size, std::uint64_t hash)
+{
+    if (!index_file_.open(path)) return false;
+
+    const std::string_view data = index_file_.view();
+    const bool valid = data.size() >= header_size && std::memcmp(data.data(), magic, sizeof(magic)) == 0 &&
+                       get_u64(data.data() + 8) == size &&
+                       get_u64(data.data() + 16) == hash &&
+                       get_u64(data.data() + 24) == (data.size() - header_size) / entry_size &&
+                       (data.size() - header_size) % entry_size == 0 &&
+                       get_u64(data.data() + 32) == content_hash::of(data.substr(header_size));
+    if (!valid)
+    {
+        index_file_ = MappedFile(); // stale or damaged: rebuild it
+        return false;
+    }
+
+    entry_count_ = static_cast<std::size_t>(get_u64(data.data() + 24));
+    entries_ = data.substr(header_size);
+    return true;
+}
+
+void IndexedSnapshot::build(const std::string& path, std::uint64_t size, std::uint64_t hash)
+{
+    rebuilt_ = true;
+
+    // One pass over the records. Lines are checked the way the loader checks them, so ids of lines a
+    // full load would skip never enter the index.
+    std::vector<std::pair<int, std::uint64_t>> found;
+    text_records::RecordScratch scratch;
+    const char* base = file_.view().data();
+    std::size_t pos = 0;
+    while (pos < body_.size())
+    {
+        const std::size_t eol = body_.find('\n', pos);
+        const std::string_view line = body_.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+        pos = (eol == std::string_view::npos) ? body_.size() : eol + 1;
+
+        int id = 0;
+        int age = 0;
+        std::string_view hobbies;
+        if (!text_records::decode_line(line, scratch, id, age, hobbies)) continue;
+        found.emplace_back(id, static_cast<std::uint64_t>(line.data() - base));
+    }
+
+    // Sorted by id; the stable sort keeps file order among duplicates, so unique() keeps the first record
+    std::stable_sort(found.begin(), found.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    found.erase(std::unique(found.begin(), found.end(),
+                            [](const auto& a, const auto& b) { return a.first == b.first; }),
+                found.end());
+
+    built_.clear();
+    built_.reserve(found.size() * entry_size);
+    for (const auto& [id, offset] : found)
+    {
+        put_u32(built_, static_cast<std::uint32_t>(id));
+        put_u64(built_, offset);
+    }
+    entry_count_ = found.size();
+    entries_ = built_;
+
+    // Save it for the next open. Written under a temporary name and renamed, so a reader never maps
+    // a half-written index; failures only mean the next open scans again.
+    std::string header(magic, sizeof(magic));
+    put_u64(header, size);
+    put_u64(header, hash);
+    put_u64(header, entry_count_);
+    put_u64(header, content_hash::of(built_));
+
+    const std::string temp_path = path + ".tmp";
+    BufferedWriter out;
+    if (!out.open(temp_path)) return;
+    out.append(header);
+    out.append(built_);
+    std::error_code ec;
+    if (out.close()) std::filesystem::rename(temp_path, path, ec);
+    else std::filesystem::remove(temp_path, ec);
+}
+
+std::size_t IndexedSnapshot::lower_bound(int id) const
+{
+    std::size_t first = 0;
+    std::size_t count = entry_count_;
+    while (count > 0)
+    {
+        const std::size_t half = count / 2;
+        const auto entry_id = static_cast<int>(get_u32(entries_.data() + (first + half) * entry_size));
+        if (entry_id < id)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return first;
+}
+
+std::size_t IndexedSnapshot::file_size() const
+{
+    return file_.size();
+}
+
+bool IndexedSnapshot::index_rebuilt() const
+{
+    return rebuilt_;
+}
+
+std::size_t IndexedSnapshot::size() const
+{
+    return entry_count_;
+}
+
+bool IndexedSnapshot::contains(int id) const
+{
+    const std::size_t pos = lower_bound(id);
+    return pos < entry_count_ && static_cast<int>(get_u32(entries_.data() + pos * entry_size)) == id;
+}
+
+int IndexedSnapshot::max_id() const
+{
+    if (entry_count_ == 0) return 0;
+    return static_cast<int>(get_u32(entries_.data() + (entry_count_ - 1) * entry_size));
+}
+
+std::optional<Profile> IndexedSnapshot::load(int id, StringPool& strings) const
+{
+    const std::size_t pos = lower_bound(id);
+    if (pos >= entry_count_) return std::nullopt;
+    const char* entry = entries_.data() + pos * entry_size;
+    if (static_cast<int>(get_u32(entry)) != id) return std::nullopt;
+
+    const std::string_view data = file_.view();
+    const std::uint64_t offset = get_u64(entry + 4);
+    if (offset >= data.size()) return std::nullopt;
+
+    std::string_view line = data.substr(static_cast<std::size_t>(offset));
+    line = line.substr(0, line.find('\n'));
+
+    text_records::RecordScratch scratch;
+    int line_id = 0;
+    int age = 0;
+    std::string_view hobbies;
+    // The id check catches an index that points at the wrong place
+    if (!text_records::decode_line(line, scratch, line_id, age, hobbies) || line_id != id) return std::nullopt;
+
+    Profile profile(id, scratch.name, age, scratch.city, scratch.country, strings);
+    text_records::add_hobbies(hobbies, scratch, profile);
+    return profile;
+}
+
+void IndexedSnapshot::load_all(StringPool& strings, const std::function<void(Profile&)>& on_profile) const
+{
+    text_records::RecordScratch scratch;
+    text_records::parse_lines(body_, scratch, strings, on_profile);
+}
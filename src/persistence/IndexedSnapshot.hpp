@@ -0,0 +1,60 @@
+#ifndef PROFILEMANAGERCLI_INDEXEDSNAPSHOT_HPP
+#define PROFILEMANAGERCLI_INDEXEDSNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "MappedFile.hpp"
+#include "../service/ProfileBacking.hpp"
+
+// A PMCLI1 snapshot opened for lazy loading: the file stays memory-mapped and records are parsed
+// one at a time, located through an id -> offset index.
+//
+// The index lives next to the snapshot in "<snapshot>.idx" (all integers little-endian):
+//
+//   header  "PMIDX2\n\0" | u64 snapshot size | u64 snapshot content hash | u64 entry count
+//           | u64 hash of the entries (a damaged sidecar is rebuilt rather than trusted)
+//   entries i32 id | u64 offset of the record line, sorted by id (one entry per id: the first record,
+//           which is the one a full load keeps)
+//
+// A sidecar whose size and content hash (ContentHash.hpp) still match is just mapped: opening hashes
+// the snapshot at close to memory speed but parses nothing. Size and mtime alone are not trusted, since a
+// rewrite can keep both (copies that preserve timestamps, coarse filesystem clocks). Otherwise the
+// snapshot is scanned once, the index is built in memory and written back for next time (best
+// effort: a read-only directory only costs the rebuild).
+class IndexedSnapshot : public ProfileBacking
+{
+    private:
+        MappedFile file_;        // the snapshot itself
+        MappedFile index_file_;  // the sidecar, when it was up to date
+        std::string built_;      // index entries built in memory otherwise
+        std::string_view entries_; // entry_count_ * 12 bytes, from index_file_ or built_
+        std::string_view body_;    // records after the header line
+        std::size_t entry_count_ = 0;
+        bool rebuilt_ = false;
+
+        std::size_t lower_bound(int id) const; // position of the first entry with an id >= id
+        bool read_sidecar(const std::string& path, std::uint64_t size, std::uint64_t hash);
+        void build(const std::string& path, std::uint64_t size, std::uint64_t hash);
+
+    public:
+        static std::string index_path(const std::string& snapshot_path);
+
+        // Maps a PMCLI1 snapshot and reads (or builds) its index.
+        // Returns false if the file cannot be opened or is not a PMCLI1 snapshot.
+        bool open(const std::string& path);
+
+        std::size_t file_size() const;
+        bool index_rebuilt() const; // true if open() had to scan the snapshot
+
+        // ProfileBacking
+        std::size_t size() const override;
+        bool contains(int id) const override;
+        int max_id() const override;
+        std::optional<Profile> load(int id, StringPool& strings) const override;
+        void load_all(StringPool& strings, const std::function<void(Profile&)>& on_profile) const override;
+};
+
+#endif //PROFILEMANAGERCLI_INDEXEDSNAPSHOT_HPP
@@ -0,0 +1,185 @@
+#include "Lz.hpp"
+
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <vector>
+
+// Lz: greedy single-probe compressor and bounds-checked decompressor (stream layout in the header)
+
+namespace
+{
+    constexpr std::size_t min_match = 4;
+    constexpr std::size_t max_offset = 65535;
+    constexpr unsigned hash_bits = 14; // 16K entries * 4 bytes = 64 KiB table
+
+    // Matches never run into the last bytes of the input, so the final sequence always has literals
+    // and every 4-byte read during the search stays inside the buffer.
+    constexpr std::size_t end_literals = 5;
+
+    std::uint32_t read32(const char* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    std::uint32_t hash4(std::uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - hash_bits);
+    }
+
+    // Length nibbles of 15 continue in 255-valued bytes
+    void put_length(std::string& out, std::size_t length)
+    {
+        while (length >= 255)
+        {
+            out += static_cast<char>(255);
+            length -= 255;
+        }
+        out += static_cast<char>(length);
+    }
+
+    void put_sequence(std::string& out, const char* literals, std::size_t literal_count,
+                      std::size_t offset, std::size_t match_length)
+    {
+        const std::size_t match_code = match_length - min_match;
+        const unsigned literal_nibble = literal_count < 15 ? static_cast<unsigned>(literal_count) : 15;
+        const unsigned match_nibble = match_code < 15 ? static_cast<unsigned>(match_code) : 15;
+
+        out += static_cast<char>((literal_nibble << 4) | match_nibble);
+        if (literal_nibble == 15) put_length(out, literal_count - 15);
+        out.append(literals, literal_count);
+
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if (match_nibble == 15) put_length(out, match_code - 15);
+    }
+
+    void put_last_literals(std::string& out, const char* literals, std::size_t literal_count)
+    {
+        const unsigned literal_nibble = literal_count < 15 ? static_cast<unsigned>(literal_count) : 15;
+        out += static_cast<char>(literal_nibble << 4);
+        if (literal_nibble == 15) put_length(out, literal_count - 15);
+        out.append(literals, literal_count);
+    }
+
+    // Reads the continuation bytes of a length nibble; false if the input ends or the length
+    // already exceeds `limit` (nothing that long can be valid, and it stops overflow early)
+    bool read_length(const unsigned char*& ip, const unsigned char* end, std::size_t& length, std::size_t limit)
+    {
+        while (true)
+        {
+            if (ip == end) return false;
+            const unsigned byte = *ip++;
+            length += byte;
+            if (length > limit) return false;
+            if (byte != 255) return true;
+        }
+    }
+}
+
+namespace lz
+{
+    std::size_t max_compressed_size(std::size_t raw_size)
+    {
+        // All-literal worst case: one token plus one length byte per 255 literals
+        return raw_size + raw_size / 255 + 16;
+    }
+
+    void compress(std::string_view in, std::string& out)
+    {
+        const char* base = in.data();
+        const std::size_t size = in.size();
+        out.reserve(out.size() + max_compressed_size(size));
+
+        std::size_t anchor = 0; // first byte not yet emitted
+        if (size > end_literals + min_match)
+        {
+            // Last position a match may start at; matches also stop before the trailing literals
+            const std::size_t match_limit = size - end_literals;
+            std::vector<std::uint32_t> table(std::size_t(1) << hash_bits, 0);
+
+            std::size_t pos = 0;
+            while (pos + min_match <= match_limit)
+            {
+                const std::uint32_t sequence = read32(base + pos);
+                std::uint32_t& slot = table[hash4(sequence)];
+                std::size_t candidate = slot;
+                slot = static_cast<std::uint32_t>(pos);
+
+                if (candidate >= pos || pos - candidate > max_offset || read32(base + candidate) != sequence)
+                {
+                    // Skip faster through data that does not compress
+                    pos += 1 + ((pos - anchor) >> 6);
+                    continue;
+                }
+
+                std::size_t length = min_match;
+                while (pos + length < match_limit && base[candidate + length] == base[pos + length]) ++length;
+
+                // A match may also reach back into bytes that were going to be literals
+                while (pos > anchor && candidate > 0 && base[pos - 1] == base[candidate - 1])
+                {
+                    --pos;
+                    --candidate;
+                    ++length;
+                }
+
+                put_sequence(out, base + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+
+                // Seed the table just before the new position so back-to-back matches are found
+                if (pos + min_match <= match_limit) table[hash4(read32(base + pos - 2))] = static_cast<std::uint32_t>(pos - 2);
+            }
+        }
+
+        put_last_literals(out, base + anchor, size - anchor);
+    }
+
+    bool decompress(std::string_view in, char* out, std::size_t out_size)
+    {
+        const auto* ip = reinterpret_cast<const unsigned char*>(in.data());
+        const auto* end = ip + in.size();
+        std::size_t op = 0;
+
+        while (true)
+        {
+            if (ip == end) return false;
+            const unsigned token = *ip++;
+
+            std::size_t literal_count = token >> 4;
+            if (literal_count == 15 && !read_length(ip, end, literal_count, out_size)) return false;
+            if (literal_count > static_cast<std::size_t>(end - ip) || literal_count > out_size - op) return false;
+            std::memcpy(out + op, ip, literal_count);
+            ip += literal_count;
+            op += literal_count;
+
+            // The literal-only sequence at the end of the stream
+            if (ip == end) return op == out_size;
+
+            if (end - ip < 2) return false;
+            const std::size_t offset = static_cast<std::size_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > op) return false;
+
+            std::size_t match_length = token & 0x0F;
+            if (match_length == 15 && !read_length(ip, end, match_length, out_size)) return false;
+            match_length += min_match;
+            if (match_length > out_size - op) return false;
+
+            char* dst = out + op;
+            const char* src = dst - offset;
+            if (offset >= match_length)
+            {
+                std::memcpy(dst, src, match_length);
+            }
+            else
+            {
+                // Overlapping copy repeats the last `offset` bytes (run-length style), so go byte by byte
+                for (std::size_t i = 0; i < match_length; ++i) dst[i] = src[i];
+            }
+            op += match_length;
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PROFILEMANAGERCLI_LZ_HPP
+#define PROFILEMANAGERCLI_LZ_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Small LZ77 block codec used by the compressed snapshot format (PMCLI3).
+// The stream is a sequence of (literals, match) pairs, modelled on the LZ4 block format:
+//
+//   token          u8: high nibble = literal length, low nibble = match length - 4
+//                  (a nibble of 15 means "more length bytes follow": add bytes until one is < 255)
+//   literals       copied as-is
+//   match offset   u16 little-endian distance back into the output (1..65535)
+//
+// The last sequence has literals only. There is no entropy stage: snapshot blocks are dominated by
+// repeated cities, countries and hobbies, which plain back-references already remove.
+namespace lz
+{
+    // Upper bound of compress() output for `raw_size` input bytes (incompressible data grows slightly)
+    std::size_t max_compressed_size(std::size_t raw_size);
+
+    // Appends the compressed form of `in` to `out`
+    void compress(std::string_view in, std::string& out);
+
+    // Decodes `in` into exactly `out_size` bytes at `out`.
+    // Every length and offset is bounds-checked; returns false on corrupt or truncated input.
+    bool decompress(std::string_view in, char* out, std::size_t out_size);
+}
+
+#endif //PROFILEMANAGERCLI_LZ_HPP
@@ -0,0 +1,105 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <utility>  // std::exchange
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PMCLI_HAS_MMAP 1
+    #include <fcntl.h>    // open
+    #include <sys/mman.h> // mmap, munmap, madvise
+    #include <sys/stat.h> // fstat
+    #include <unistd.h>   // close
+#endif
+
+// MappedFile: mmap a file read-only, or fall back to reading it into memory
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapped_(std::exchange(other.mapped_, false)),
+      fallback_(std::move(other.fallback_))
+{
+    // A moved std::string may have moved its SSO buffer, so re-point at our own copy
+    if (!mapped_ && data_) data_ = fallback_.data();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapped_ = std::exchange(other.mapped_, false);
+        fallback_ = std::move(other.fallback_);
+        if (!mapped_ && data_) data_ = fallback_.data();
+    }
+    return *this;
+}
+
+void MappedFile::release()
+{
+#ifdef PMCLI_HAS_MMAP
+    if (mapped_ && data_)
+    {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    fallback_.clear();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    release();
+
+#ifdef PMCLI_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        const auto length = static_cast<std::size_t>(st.st_size);
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED)
+        {
+            // We scan front to back exactly once, so tell the kernel to read ahead aggressively.
+            madvise(addr, length, MADV_SEQUENTIAL);
+            ::close(fd); // the mapping stays valid after the descriptor is closed
+            data_ = static_cast<const char*>(addr);
+            size_ = length;
+            mapped_ = true;
+            return true;
+        }
+    }
+    ::close(fd);
+    // Empty files, pipes and failed mappings continue with the stream fallback below.
+#endif
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+    return true;
+}
+
+std::string_view MappedFile::view() const
+{
+    return std::string_view(data_ ? data_ : "", size_);
+}
+
+std::size_t MappedFile::size() const
+{
+    return size_;
+}
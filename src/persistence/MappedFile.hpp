@@ -0,0 +1,38 @@
+#ifndef PROFILEMANAGERCLI_MAPPEDFILE_HPP
+#define PROFILEMANAGERCLI_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file.
+// On POSIX systems the file is memory-mapped so the loader can scan it without copying.
+// If mapping is not possible (non-POSIX platform, pipes, special files) the contents are read into an owned buffer instead.
+class MappedFile
+{
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;   // true: data_ points into an mmap region that must be unmapped
+    std::string fallback_;  // owns the bytes when the file could not be mapped
+
+    void release();
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Owns a mapping, so copying is disabled (moving is fine)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Opens and maps the file. Returns false if the file cannot be opened/read.
+    bool open(const std::string& path);
+
+    std::string_view view() const; // whole file contents
+    std::size_t size() const;
+};
+
+#endif //PROFILEMANAGERCLI_MAPPEDFILE_HPP
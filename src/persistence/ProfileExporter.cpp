@@ -0,0 +1,44 @@
+#include "ProfileExporter.hpp"
+#include "../domain/ProfileFormatter.hpp"
+#include "../service/ProfileStore.hpp"
+#include "BufferedWriter.hpp"
+
+// ProfileExporter: JSON / CSV dumps through ProfileFormatter and one reused record buffer
+
+bool ProfileExporter::write(const ProfileStore& store, const std::string& path, ExportFormat format)
+{
+    BufferedWriter out;
+    if (!out.open(path)) return false;
+
+    std::string record; // capacity survives between profiles, so rendering stops allocating after warm-up
+    bool first = true;
+
+    if (format == ExportFormat::Csv)
+    {
+        ProfileFormatter::append_csv_header(record);
+        out.append(record);
+    }
+    else
+    {
+        out.append("[\n");
+    }
+
+    for (const Profile& p : store.ordered())
+    {
+        record.clear();
+        if (format == ExportFormat::Csv)
+        {
+            ProfileFormatter::append_csv(record, p);
+        }
+        else
+        {
+            if (!first) record += ",\n";
+            ProfileFormatter::append_json(record, p);
+        }
+        out.append(record);
+        first = false;
+    }
+
+    if (format == ExportFormat::Json) out.append(first ? "]\n" : "\n]\n");
+    return out.close();
+}
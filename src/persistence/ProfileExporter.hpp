@@ -0,0 +1,22 @@
+#ifndef PROFILEMANAGERCLI_PROFILEEXPORTER_HPP
+#define PROFILEMANAGERCLI_PROFILEEXPORTER_HPP
+
+#include <string>
+
+class ProfileStore;
+
+// Export-only formats (not read back by load()); see ProfileFormatter for the record layouts
+enum class ExportFormat
+{
+    Json, // one array of profile objects
+    Csv   // header row + one row per profile
+};
+
+class ProfileExporter
+{
+    public:
+        // Writes every profile in id order. Return true on success
+        static bool write(const ProfileStore& store, const std::string& path, ExportFormat format);
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEEXPORTER_HPP
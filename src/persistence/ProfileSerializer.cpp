@@ -1,236 +1,378 @@
 #include "ProfileSerializer.hpp"
+#include "../service/ConcurrentProfileStore.hpp"
 #include "../service/ProfileStore.hpp"
 #include "../domain/Profile.hpp"
 
-#include <fstream>
+#include "BinarySnapshot.hpp"
+#include "BufferedWriter.hpp"
+#include "CompressedSnapshot.hpp"
+#include "DeltaSegments.hpp"
+#include "FileSync.hpp"
+#include "IndexedSnapshot.hpp"
+#include "MappedFile.hpp"
+#include "TextRecords.hpp"
+#include "../util/ThreadPool.hpp"
+
+#include <algorithm> // std::count
+#include <chrono>
+#include <filesystem>
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 // ProfileSerializer: save/load from file
-// One profile per line in a tab-separated format:
-// <id>\t<age>\t<name>\t<city>\t<country>\t<hobby1|hobby2|hobby3>
+// Record lines are encoded/decoded by text_records (TextRecords.hpp)
 
 namespace
 {
-    // Escapes chars that would break our separators.
-    // We escape: backslash, tab, newline, pipe '|'
-    std::string escape_field(const std::string& s)
-    {
-        std::string out;
-        out.reserve(s.size());
-
-        for (char ch : s)
-        {
-            switch (ch)
-            {
-                case '\\': out += "\\\\"; break; // '\'  -> "\\"
-                case '\t': out += "\\t";  break; // tab -> "\t"
-                case '\n': out += "\\n";  break; // nl  -> "\n"
-                case '|':  out += "\\|";  break; // '|' -> "\|"
-                default:   out += ch;     break;
-            }
-        }
-        return out;
-    }
+    using namespace text_records;
 
-    // Converts escaped sequences back to original characters.
-    // Recognizes: "\\", "\t", "\n", "\|"
-    std::string unescape_field(const std::string& s)
+    // Cuts `text` into roughly `parts` pieces that each end right after a '\n',
+    // so no record is ever split between two chunks.
+    std::vector<std::string_view> split_at_newlines(std::string_view text, size_t parts)
     {
-        std::string out;
-        out.reserve(s.size());
+        std::vector<std::string_view> chunks;
+        if (parts == 0) parts = 1;
+        const size_t target = text.size() / parts + 1;
 
-        for (size_t i = 0; i < s.size(); ++i)
+        size_t start = 0;
+        while (start < text.size())
         {
-            char ch = s[i];
-
-            // Escape sequence begins with backslash and must have a next char
-            if (ch == '\\' && i + 1 < s.size())
+            size_t end = start + target;
+            if (end >= text.size())
             {
-                char next = s[i + 1];
-
-                switch (next)
-                {
-                    case '\\': out += '\\'; ++i; break; // "\\\\" -> '\'
-                    case 't':  out += '\t'; ++i; break; // "\\t"  -> tab
-                    case 'n':  out += '\n'; ++i; break; // "\\n"  -> newline
-                    case '|':  out += '|';  ++i; break; // "\\|"  -> '|'
-                    default:
-                        // Unknown escape sequence: keep the backslash literally
-                        out += ch;
-                        break;
-                }
+                end = text.size();
             }
             else
             {
-                out += ch;
+                const size_t eol = text.find('\n', end);
+                end = (eol == std::string_view::npos) ? text.size() : eol + 1;
             }
+            chunks.push_back(text.substr(start, end - start));
+            start = end;
         }
-        return out;
+        return chunks;
     }
 
-    // Split hobbies by '|' BUT only when the '|' is NOT escaped.
-    // This prevents breaking hobbies like "Gym|Weights" which are stored as "Gym\|Weights".
-    std::vector<std::string> split_unescaped_pipes(const std::string& s)
+    void fill_stats(LoadStats* stats, std::size_t bytes, std::size_t profiles,
+                    std::chrono::steady_clock::time_point started)
     {
-        std::vector<std::string> parts;
-        std::string current;
-
-        for (size_t i = 0; i < s.size(); ++i)
-        {
-            // If we see an escape introducer, copy it and the next char as-is
-            // so the token keeps sequences like "\|" intact until unescape_field().
-            if (s[i] == '\\' && i + 1 < s.size())
-            {
-                current.push_back(s[i]);
-                current.push_back(s[i + 1]);
-                ++i;
-                continue;
-            }
+        if (!stats) return;
+        stats->bytes = bytes;
+        stats->profiles = profiles;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
 
-            // Split only on an actual separator '|'
-            if (s[i] == '|')
-            {
-                parts.push_back(current);
-                current.clear();
-            }
-            else
-            {
-                current.push_back(s[i]);
-            }
-        }
+    // PMCLI1 writer behind save()
+    bool save_text(const ProfileSource& source, const std::string& path)
+    {
+        BufferedWriter out;
+        if (!out.open(path)) return false;
 
-        parts.push_back(current);
-        return parts;
-    }
-}
+        // File header so that we can detect format/version later.
+        out.append("PMCLI1\n");
 
-bool ProfileSerializer::save(const ProfileStore& store, const std::string& path)
-{
-    std::ofstream out(path, std::ios::trunc);
-    if (!out) return false;
+        // Records are escaped straight into the output buffer, which reaches the file in large writes.
+        source([&](const Profile& p) { write_record(out, p); });
 
-    // File header so that we can detect format/version later.
-    out << "PMCLI1\n";
+        return out.close();
+    }
 
-    // Store provides stable ordering via list_ids()
-    for (int id : store.list_ids())
+    // The snapshot file alone, without delta segments (load() below)
+    bool load_snapshot(ProfileStore& store, const std::string& path, LoadStats* stats)
     {
-        const Profile* p = store.find(id);
-        if (!p) continue; // defensive
+        const auto started = std::chrono::steady_clock::now();
+
+        // Map the whole file and scan it in place: lines and fields are string_view slices into the mapping,
+        // so the only allocations left are the strings the Profile itself owns.
+        MappedFile file;
+        if (!file.open(path)) return false;
+        ProfileStore::BulkLoad bulk(store); // the name index is built once, after the last insert
 
-        // Serialize hobbies as hobby1|hobby2|hobby3
-        // IMPORTANT:
-        // - We escape EACH hobby text (so hobby text can contain '|', tabs, etc.)
-        // - We do NOT escape the separator itself; separator stays as raw '|'
-        std::string hobbies_joined;
-        const auto& hobbies = p->hobbies();
+        // Dispatch on the header magic: PMCLI2 is the binary snapshot format
+        if (BinarySnapshot::matches(file.view()))
+        {
+            std::size_t loaded = 0;
+            if (!BinarySnapshot::load(store, file.view(), loaded)) return false;
+            fill_stats(stats, file.size(), loaded, started);
+            return true;
+        }
 
-        for (size_t i = 0; i < hobbies.size(); ++i)
+        // PMCLI3: compressed blocks, inflated one after another here (load_parallel spreads them over threads)
+        if (CompressedSnapshot::matches(file.view()))
         {
-            hobbies_joined += escape_field(hobbies[i]);
-            if (i + 1 < hobbies.size()) hobbies_joined += "|";
+            std::size_t loaded = 0;
+            if (!CompressedSnapshot::load(store, file.view(), loaded, 1)) return false;
+            fill_stats(stats, file.size(), loaded, started);
+            return true;
         }
 
-        // We escape text fields to ensure TAB/NEWLINE/'|' never breaks parsing.
-        out << p->id() << '\t'
-            << p->age() << '\t'
-            << escape_field(p->name()) << '\t'
-            << escape_field(p->city()) << '\t'
-            << escape_field(p->country()) << '\t'
-            << hobbies_joined
-            << "\n";
+        std::string_view body;
+        if (!split_header(file.view(), body)) return false;
+
+        // Replace in-memory data with disk data
+        store.clear();
+        // One record per line: counting newlines (memchr speed) gives the size hint for free
+        store.reserve(static_cast<std::size_t>(std::count(body.begin(), body.end(), '\n')) + 1);
+
+        RecordScratch scratch;
+        std::size_t loaded = 0;
+        parse_lines(body, scratch, store.strings(), [&](Profile& p)
+        {
+            // Moved straight into its table slot (staging a batch first measured slower here);
+            // if duplicate id exists, skip
+            if (store.insert_profile(std::move(p))) ++loaded;
+        });
+
+        fill_stats(stats, file.size(), loaded, started);
+        return true;
     }
 
-    return true;
-}
+    bool load_snapshot_parallel(ProfileStore& store, const std::string& path,
+                                unsigned thread_count, LoadStats* stats)
+    {
+        const unsigned threads = ThreadPool::resolve_thread_count(thread_count);
 
-bool ProfileSerializer::load(ProfileStore& store, const std::string& path)
-{
-    std::ifstream in(path);
-    if (!in) return false;
+        // Below this size the pool start-up costs more than the parsing it would save
+        constexpr std::size_t min_parallel_bytes = 1 << 20;
 
-    // Read the first line as header
-    std::string header;
-    if (!std::getline(in, header)) return false;
+        const auto started = std::chrono::steady_clock::now();
 
-    // Windows CRLF fix: strip trailing '\r'
-    if (!header.empty() && header.back() == '\r') header.pop_back();
+        MappedFile file;
+        if (!file.open(path)) return false;
+        ProfileStore::BulkLoad bulk(store);
 
-    // Validate file format
-    if (header != "PMCLI1") return false;
+        if (CompressedSnapshot::matches(file.view()) && threads > 1)
+        {
+            std::size_t loaded = 0;
+            if (!CompressedSnapshot::load(store, file.view(), loaded, threads)) return false;
+            fill_stats(stats, file.size(), loaded, started);
+            return true;
+        }
 
-    // Replace in-memory data with disk data
-    store.clear();
+        std::string_view body;
+        const bool text = split_header(file.view(), body);
 
-    std::string line;
-    while (std::getline(in, line))
-    {
-        // Windows CRLF fix: strip trailing '\r'
-        if (!line.empty() && line.back() == '\r') line.pop_back();
+        // Binary snapshots are already close to memcpy speed, so they (and small files) take the sequential path
+        if (!text || threads == 1 || body.size() < min_parallel_bytes)
+        {
+            file = MappedFile(); // release before re-mapping in load_snapshot()
+            return load_snapshot(store, path, stats);
+        }
 
-        if (line.empty()) continue;
+        // A few chunks per thread keeps every worker busy even if some chunks hold longer records.
+        const std::vector<std::string_view> chunks = split_at_newlines(body, threads * 4);
 
-        // Split the line by TAB into fields:
-        // fields[0]=id, fields[1]=age, fields[2]=name, fields[3]=city, fields[4]=country, fields[5]=hobbies(optional)
-        std::vector<std::string> fields;
+        // Parse chunks concurrently. Each chunk produces its profiles in file order,
+        // interned into a private pool so the workers never share a hash table.
+        std::vector<std::vector<Profile>> parsed(chunks.size());
+        std::vector<StringPool> pools(chunks.size());
         {
-            std::string current;
-            for (char ch : line)
+            ThreadPool pool(threads);
+            std::vector<std::future<void>> pending;
+            pending.reserve(chunks.size());
+
+            for (size_t i = 0; i < chunks.size(); ++i)
             {
-                if (ch == '\t')
-                {
-                    fields.push_back(current);
-                    current.clear();
-                }
-                else
+                pending.push_back(pool.submit([&chunks, &parsed, &pools, i]()
                 {
-                    current.push_back(ch);
-                }
+                    RecordScratch scratch;
+                    parse_lines(chunks[i], scratch, pools[i], [&](Profile& p) { parsed[i].push_back(std::move(p)); });
+                }));
             }
-            fields.push_back(current);
+            for (auto& f : pending) f.get();
         }
 
-        // Require at least 5 fields (id, age, name, city, country)
-        if (fields.size() < 5) continue;
+        // Merge in chunk order so "first occurrence wins" means the same as in the sequential loader.
+        store.clear();
+        std::size_t total = 0;
+        for (const auto& chunk : parsed) total += chunk.size();
+        store.reserve(total);
 
-        int id = 0;
-        int age = 0;
+        std::size_t loaded = 0;
+        std::vector<StringPool::Handle> remap;
+        for (size_t i = 0; i < parsed.size(); ++i)
+        {
+            // Move the chunk's handles over to the store's pool, one lookup per distinct string
+            remap.assign(pools[i].size(), StringPool::npos);
+            for (Profile& p : parsed[i]) p.rebind(store.strings(), remap);
+            loaded += store.insert_batch(parsed[i]); // moved in, duplicate ids skipped
+            std::vector<Profile>().swap(parsed[i]); // free each chunk as soon as it is merged
+            pools[i].clear();
+        }
+
+        fill_stats(stats, file.size(), loaded, started);
+        return true;
+    }
 
-        try
+    // Delta segments saved since the snapshot go on top; afterwards store matches path exactly.
+    // A damaged delta is applied not at all (never in part), and the snapshot-only load stands.
+    void apply_delta(ProfileStore& store, const std::string& path, LoadStats* stats)
+    {
+        std::size_t segments = 0;
+        if (!DeltaSegments::apply(store, path, segments))
         {
-            id  = std::stoi(fields[0]);
-            age = std::stoi(fields[1]);
+            if (stats) stats->delta_ignored = true;
         }
-        catch (...)
+        else if (segments > 0 && stats)
         {
-            // Skip malformed numeric fields rather than crashing.
-            continue;
+            stats->profiles = store.size();
         }
+        store.mark_clean(path);
+    }
 
-        // Unescape text fields to restore original content
-        std::string name    = unescape_field(fields[2]);
-        std::string city    = unescape_field(fields[3]);
-        std::string country = unescape_field(fields[4]);
+    // Format of an existing snapshot, from its header magic. False if it cannot be read.
+    bool detect_format(const std::string& path, SnapshotFormat& format)
+    {
+        MappedFile file;
+        if (!file.open(path)) return false;
+        std::string_view body;
+        if (BinarySnapshot::matches(file.view())) format = SnapshotFormat::Binary;
+        else if (CompressedSnapshot::matches(file.view())) format = SnapshotFormat::Compressed;
+        else if (split_header(file.view(), body)) format = SnapshotFormat::Text;
+        else return false;
+        return true;
+    }
+}
 
-        Profile p(id, name, age, city, country);
+bool ProfileSerializer::save(const ProfileStore& store, const std::string& path,
+                             SnapshotFormat format, SaveOrder order)
+{
+    // A lazy store may be reading from the very file we are about to truncate, so pull it in first
+    store.materialize();
+    return save([&](const ProfileVisitor& visit)
+    {
+        if (order == SaveOrder::ById) store.for_each_ordered(visit);
+        else store.for_each(visit);
+    }, path, format);
+}
 
-        // Hobbies are optional
-        if (fields.size() >= 6 && !fields[5].empty())
-        {
-            // Split only on unescaped pipes
-            auto hobby_tokens = split_unescaped_pipes(fields[5]);
+bool ProfileSerializer::save(ConcurrentProfileStore& store, const std::string& path,
+                             SnapshotFormat format, SaveOrder order)
+{
+    // Writers that touch a profile during the save copy its old state into the snapshot first
+    const ConcurrentProfileStore::Snapshot snapshot = store.open_snapshot();
+    return save([&](const ProfileVisitor& visit)
+    {
+        if (order == SaveOrder::ById) snapshot.for_each_ordered(visit);
+        else snapshot.for_each(visit);
+    }, path, format);
+}
 
-            // Unescape each hobby token to restore original hobby text
-            for (const auto& token : hobby_tokens)
-            {
-                p.add_hobby(unescape_field(token));
-            }
-        }
+bool ProfileSerializer::save(const ProfileSource& source, const std::string& path, SnapshotFormat format)
+{
+    bool saved = false;
+    if (format == SnapshotFormat::Binary) saved = BinarySnapshot::save(source, path);
+    else if (format == SnapshotFormat::Compressed) saved = CompressedSnapshot::save(source, path);
+    else saved = save_text(source, path);
+    if (!saved) return false;
+
+    std::error_code ec;
+    std::filesystem::remove(DeltaSegments::path_for(path), ec); // its changes are in the new snapshot
+    return true;
+}
+
+bool ProfileSerializer::load(ProfileStore& store, const std::string& path, LoadStats* stats)
+{
+    if (!load_snapshot(store, path, stats)) return false;
+    apply_delta(store, path, stats);
+    return true;
+}
+
+bool ProfileSerializer::load_parallel(ProfileStore& store, const std::string& path,
+                                      unsigned thread_count, LoadStats* stats)
+{
+    if (!load_snapshot_parallel(store, path, thread_count, stats)) return false;
+    apply_delta(store, path, stats);
+    return true;
+}
 
-        // Insert profile; if duplicate id exists, skip
-        if (!store.insert_profile(p)) continue;
+bool ProfileSerializer::open_lazy(ProfileStore& store, const std::string& path, LoadStats* stats)
+{
+    const auto started = std::chrono::steady_clock::now();
+
+    auto snapshot = std::make_unique<IndexedSnapshot>();
+    if (!snapshot->open(path))
+    {
+        snapshot.reset();
+        return load_parallel(store, path, 0, stats); // not PMCLI1 (or unreadable, then this fails too)
+    }
+
+    const std::size_t bytes = snapshot->file_size();
+    store.open_lazy(std::move(snapshot));
+    fill_stats(stats, bytes, store.size(), started);
+    apply_delta(store, path, stats); // changed records are read from the delta, the rest stays lazy
+    return true;
+}
+
+bool ProfileSerializer::save_delta(ProfileStore& store, const std::string& base_path, DeltaStats* stats)
+{
+    DeltaStats result;
+    const ChangeSet& changes = store.changes();
+
+    // Segments only make sense against the exact file the store last agreed with
+    SnapshotFormat format = SnapshotFormat::Text;
+    const bool base_readable = detect_format(base_path, format);
+    if (!changes.has_baseline() || changes.source() != base_path || !base_readable)
+    {
+        if (!save(store, base_path, format)) return false;
+        store.mark_clean(base_path);
+        result.written = store.size();
+        result.full_save = true;
+    }
+    else if (!changes.empty())
+    {
+        if (!DeltaSegments::append(store, base_path, result.deleted, result.written)) return false;
+        store.mark_clean(base_path);
     }
 
+    if (stats) *stats = result;
     return true;
 }
+
+bool ProfileSerializer::merge(const std::string& base_path)
+{
+    SnapshotFormat format = SnapshotFormat::Text;
+    if (!detect_format(base_path, format)) return false;
+
+    // load applies the segments; a damaged delta would be left out, so there is nothing safe to fold
+    ProfileStore scratch;
+    scratch.set_indexing(false);
+    scratch.set_allocation_mode(AllocationMode::Arena);
+    LoadStats stats;
+    if (!load_parallel(scratch, base_path, 0, &stats) || stats.delta_ignored) return false;
+
+    // Same sequence as WriteAheadLog compaction: the rename is the commit point. A crash before it
+    // keeps the old base + delta; after it the delta no longer matches the base and is dropped unread.
+    const std::string temp_path = base_path + ".tmp";
+    std::error_code ec;
+    if (!save(scratch, temp_path, format) || !file_sync::sync_existing_file(temp_path))
+    {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    std::filesystem::rename(temp_path, base_path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    const std::filesystem::path directory = std::filesystem::path(base_path).parent_path();
+    file_sync::sync_directory(directory);
+
+    std::filesystem::remove(DeltaSegments::path_for(base_path), ec);
+    file_sync::sync_directory(directory);
+    return true;
+}
+
+bool ProfileSerializer::convert(const std::string& input_path, const std::string& output_path, SnapshotFormat format)
+{
+    // Round-trip through a scratch store: load() accepts either format, save() writes the requested one
+    ProfileStore scratch;
+    scratch.set_indexing(false); // only passes through, nobody queries it
+    scratch.set_allocation_mode(AllocationMode::Arena); // bulk-loaded once, freed in one go
+    if (!load_parallel(scratch, input_path)) return false;
+    return save(scratch, output_path, format);
+}
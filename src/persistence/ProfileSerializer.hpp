@@ -1,18 +1,103 @@
 #ifndef PROFILEMANAGERCLI_PROFILESERIALIZER_HPP
 #define PROFILEMANAGERCLI_PROFILESERIALIZER_HPP
 
+#include <cstddef>
+#include <functional>
 #include <string>
 
+class ConcurrentProfileStore;
+class Profile;
 class ProfileStore;
 
+// Throughput numbers for a single load() call, so the UI/benchmarks can report them
+struct LoadStats
+{
+    std::size_t bytes = 0;    // file size scanned
+    std::size_t profiles = 0; // profiles actually inserted (duplicates/malformed lines not counted)
+    double seconds = 0.0;     // wall time of the whole load
+    bool delta_ignored = false; // "<path>.delta" was damaged: the store holds the snapshot without it
+
+    double mb_per_sec() const { return seconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0.0; }
+    double profiles_per_sec() const { return seconds > 0.0 ? profiles / seconds : 0.0; }
+};
+
+// On-disk snapshot formats. load() detects the format from the header, save() needs to be told.
+enum class SnapshotFormat
+{
+    Text,      // PMCLI1: escaped, tab-separated text (human-readable)
+    Binary,    // PMCLI2: string table + length-prefixed records (see BinarySnapshot.hpp)
+    Compressed // PMCLI3: independently compressed blocks of PMCLI1 records + id-range index (see CompressedSnapshot.hpp)
+};
+
+// What a save_delta() call wrote
+struct DeltaStats
+{
+    std::size_t deleted = 0;  // ids recorded as removed
+    std::size_t written = 0;  // records written (every profile when it fell back to a full save)
+    bool full_save = false;   // true if the whole snapshot was rewritten instead
+};
+
+// Record order on save. ById gives stable, diff-friendly files;
+// Unordered skips the global sort when the caller does not care (e.g. large nightly snapshots).
+enum class SaveOrder
+{
+    ById,
+    Unordered
+};
+
+// Anything save() can write: calls `visit` once per profile, in the order they should appear on disk
+using ProfileVisitor = std::function<void(const Profile&)>;
+using ProfileSource = std::function<void(const ProfileVisitor& visit)>;
+
 class ProfileSerializer
 {
     public:
         // Save all profiles to disk. Return true on success
-        static bool save(const ProfileStore& store, const std::string& path);
+        // Output goes through one large reusable buffer and is flushed in big writes.
+        static bool save(const ProfileStore& store, const std::string& path,
+                         SnapshotFormat format = SnapshotFormat::Text,
+                         SaveOrder order = SaveOrder::ById);
+        // Save a point-in-time snapshot of a concurrent store; writers keep running during the save
+        static bool save(ConcurrentProfileStore& store, const std::string& path,
+                         SnapshotFormat format = SnapshotFormat::Text,
+                         SaveOrder order = SaveOrder::ById);
+        // Save whatever `source` visits (the building block of the overloads above).
+        // A full save supersedes any delta segments kept for path, so "<path>.delta" is deleted.
+        static bool save(const ProfileSource& source, const std::string& path,
+                         SnapshotFormat format = SnapshotFormat::Text);
         // Load profiles from disk into store (overwrites existing in-memory store)
-        static bool load(ProfileStore& store, const std::string& path);
+        // PMCLI1, PMCLI2 and PMCLI3 files are accepted; the header magic decides which parser runs.
+        // Segments saved by save_delta() are applied on top, and the store is marked clean against path.
+        // A damaged delta file is left out whole (stats->delta_ignored) rather than failing the load;
+        // it stays on disk, and save_delta() refuses to append to it until a full save replaces it.
+        // The file is memory-mapped and parsed in place; pass stats to get throughput numbers back.
+        static bool load(ProfileStore& store, const std::string& path, LoadStats* stats = nullptr);
+        // Same result as load(), but the file is split at line boundaries and parsed on a thread pool.
+        // Chunks are merged in file order, so duplicate ids still resolve to the first occurrence.
+        // PMCLI3 files inflate their blocks on the pool instead.
+        // thread_count == 0 uses all hardware threads; small files fall back to load().
+        static bool load_parallel(ProfileStore& store, const std::string& path,
+                                  unsigned thread_count = 0, LoadStats* stats = nullptr);
+
+        // Lazy open (see ProfileStore::open_lazy): a PMCLI1 snapshot stays mapped and each record is parsed
+        // the first time it is looked up, via an id -> offset index kept next to it ("<path>.idx").
+        // Binary and compressed snapshots have no per-record offsets to use, so they are loaded in full.
+        static bool open_lazy(ProfileStore& store, const std::string& path, LoadStats* stats = nullptr);
+
+        // Incremental save (see DeltaSegments.hpp): appends only the profiles created, changed or removed
+        // since store last matched base_path to "<base_path>.delta", so the cost follows the size of the
+        // change rather than of the store. Falls back to a full save (in the base file's format, text if
+        // there is none) when the store was not loaded from / saved to base_path or was cleared since.
+        // load(), load_parallel() and open_lazy() apply the delta on top of the base file.
+        static bool save_delta(ProfileStore& store, const std::string& base_path, DeltaStats* stats = nullptr);
+        // Folds "<base_path>.delta" into the base file (rewritten in its own format) and deletes the delta.
+        // The new base is written to "<base_path>.tmp", synced and renamed over the old one, so a crash
+        // leaves either the old base + delta or the merged base. Fails (changing nothing) if the delta is damaged.
+        static bool merge(const std::string& base_path);
+
+        // Rewrite a snapshot file (either format) in the requested format
+        static bool convert(const std::string& input_path, const std::string& output_path, SnapshotFormat format);
 };
 
 
-#endif //PROFILEMANAGERCLI_PROFILESERIALIZER_HPP
\ No newline at end of file
+#endif //PROFILEMANAGERCLI_PROFILESERIALIZER_HPP
@@ -0,0 +1,313 @@
+#include "TextRecords.hpp"
+#include "BufferedWriter.hpp"
+#include "TextScan.hpp"
+#include "../domain/StringPool.hpp"
+
+#include <algorithm> // std::max
+#include <charconv> // std::from_chars, std::to_chars
+#include <cstring> // std::memcpy, std::memchr
+
+// TextRecords: PMCLI1 record encoding/decoding (format documented in the header)
+
+namespace
+{
+    // Escapes chars that would break our separators.
+    // We escape: backslash, tab, newline, pipe '|'
+    // Writes straight into `out`, which must have room for 2 * s.size() bytes (the worst case);
+    // returns the number of bytes written.
+    // Runs without special chars are located with text_scan and copied in one memcpy.
+    size_t escape_field(std::string_view s, char* out)
+    {
+        char* dst = out;
+        const char* src = s.data();
+        const char* end = src + s.size();
+
+        while (true)
+        {
+            const char* special = text_scan::find_escapable(src, end);
+            std::memcpy(dst, src, static_cast<size_t>(special - src));
+            dst += special - src;
+            if (special == end) break;
+
+            *dst++ = '\\';
+            switch (*special)
+            {
+                case '\\': *dst++ = '\\'; break; // '\'  -> "\\"
+                case '\t': *dst++ = 't';  break; // tab -> "\t"
+                case '\n': *dst++ = 'n';  break; // nl  -> "\n"
+                default:   *dst++ = '|';  break; // '|' -> "\|"
+            }
+            src = special + 1;
+        }
+        return static_cast<size_t>(dst - out);
+    }
+
+    // Escapes `s` directly into the sink's buffer (no temporary string)
+    template <typename Sink>
+    void append_escaped(Sink& out, std::string_view s)
+    {
+        char* dst = out.reserve(s.size() * 2);
+        out.commit(escape_field(s, dst));
+    }
+
+    // Writes one PMCLI1 record line into a BufferedWriter or a StringSink
+    template <typename Sink>
+    void put_record(Sink& out, const Profile& p)
+    {
+        out.append_int(p.id());
+        out.append('\t');
+        out.append_int(p.age());
+        out.append('\t');
+
+        // We escape text fields to ensure TAB/NEWLINE/'|' never breaks parsing.
+        append_escaped(out, p.name());
+        out.append('\t');
+        append_escaped(out, p.city());
+        out.append('\t');
+        append_escaped(out, p.country());
+        out.append('\t');
+
+        // Serialize hobbies as hobby1|hobby2|hobby3
+        // IMPORTANT:
+        // - We escape EACH hobby text (so hobby text can contain '|', tabs, etc.)
+        // - We do NOT escape the separator itself; separator stays as raw '|'
+        const auto& hobbies = p.hobbies();
+        for (size_t i = 0; i < hobbies.size(); ++i)
+        {
+            append_escaped(out, hobbies[i]);
+            if (i + 1 < hobbies.size()) out.append('|');
+        }
+        out.append('\n');
+    }
+
+    // Converts escaped sequences back to original characters.
+    // Recognizes: "\\", "\t", "\n", "\|"
+    // Writes into `out` (reusing its capacity) instead of returning a fresh string.
+    // Text between backslashes is appended in bulk; memchr is already vectorised by the C library.
+    void unescape_field(std::string_view s, std::string& out)
+    {
+        out.clear();
+        out.reserve(s.size());
+
+        const char* src = s.data();
+        const char* end = src + s.size();
+
+        while (src != end)
+        {
+            const auto* found = static_cast<const char*>(std::memchr(src, '\\', static_cast<size_t>(end - src)));
+            const char* backslash = found ? found : end;
+            out.append(src, static_cast<size_t>(backslash - src));
+            if (backslash == end) break;
+
+            // Escape sequence begins with backslash and must have a next char
+            src = backslash + 1;
+            if (src == end)
+            {
+                out += '\\'; // trailing backslash is kept literally
+                break;
+            }
+
+            switch (*src)
+            {
+                case '\\': out += '\\'; ++src; break; // "\\\\" -> '\'
+                case 't':  out += '\t'; ++src; break; // "\\t"  -> tab
+                case 'n':  out += '\n'; ++src; break; // "\\n"  -> newline
+                case '|':  out += '|';  ++src; break; // "\\|"  -> '|'
+                default:
+                    // Unknown escape sequence: keep the backslash literally
+                    out += '\\';
+                    break;
+            }
+        }
+    }
+
+    // Fast path for the common case: a field without any backslash is copied as-is,
+    // only fields that actually contain escapes pay for unescape_field().
+    void decode_field(std::string_view raw, std::string& out)
+    {
+        if (raw.find('\\') == std::string_view::npos)
+        {
+            out.assign(raw.data(), raw.size());
+            return;
+        }
+        unescape_field(raw, out);
+    }
+
+    // Split hobbies by '|' BUT only when the '|' is NOT escaped.
+    // This prevents breaking hobbies like "Gym|Weights" which are stored as "Gym\|Weights".
+    // Tokens are handed to on_token as slices of `s` (still escaped), so no per-token string is built.
+    // text_scan jumps straight to the next '|' or '\\', skipping plain text a block at a time.
+    template <typename Fn>
+    void split_unescaped_pipes(std::string_view s, Fn&& on_token)
+    {
+        const char* begin = s.data();
+        const char* end = begin + s.size();
+        const char* token_start = begin;
+        const char* pos = begin;
+
+        while (true)
+        {
+            pos = text_scan::find_pipe_or_backslash(pos, end);
+            if (pos == end) break;
+
+            // If we see an escape introducer, skip it and the next char
+            // so the token keeps sequences like "\|" intact until unescape_field().
+            if (*pos == '\\')
+            {
+                pos += (end - pos >= 2) ? 2 : 1;
+                continue;
+            }
+
+            // Split only on an actual separator '|'
+            on_token(std::string_view(token_start, static_cast<size_t>(pos - token_start)));
+            token_start = ++pos;
+        }
+
+        on_token(std::string_view(token_start, static_cast<size_t>(end - token_start)));
+    }
+
+    // Parses a base-10 int with the same acceptance rules as std::stoi:
+    // leading whitespace, optional sign, at least one digit, trailing junk ignored, overflow rejected.
+    bool parse_int(std::string_view s, int& value)
+    {
+        size_t i = 0;
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\r' || s[i] == '\v' || s[i] == '\f' || s[i] == '\n')) ++i;
+
+        // std::from_chars does not accept a leading '+', so consume it ourselves
+        if (i < s.size() && s[i] == '+')
+        {
+            ++i;
+            if (i >= s.size() || s[i] < '0' || s[i] > '9') return false;
+        }
+
+        const char* first = s.data() + i;
+        const char* last = s.data() + s.size();
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        return ec == std::errc() && ptr != first;
+    }
+
+    // Appends to a std::string with the part of the BufferedWriter interface put_record uses
+    class StringSink
+    {
+    private:
+        std::string& out_;
+        std::size_t used_;
+
+    public:
+        explicit StringSink(std::string& out) : out_(out), used_(out.size()) {}
+        ~StringSink() { out_.resize(used_); } // drop the unused tail of the last reserve()
+
+        char* reserve(std::size_t n)
+        {
+            if (out_.size() < used_ + n) out_.resize(std::max(used_ + n, out_.size() * 2));
+            return out_.data() + used_;
+        }
+        void commit(std::size_t n) { used_ += n; }
+
+        void append(std::string_view s)
+        {
+            std::memcpy(reserve(s.size()), s.data(), s.size());
+            used_ += s.size();
+        }
+        void append(char ch)
+        {
+            *reserve(1) = ch;
+            ++used_;
+        }
+        void append_int(long long value)
+        {
+            char* dst = reserve(24);
+            auto [ptr, ec] = std::to_chars(dst, dst + 24, value);
+            used_ += static_cast<std::size_t>(ptr - dst);
+        }
+    };
+}
+
+namespace text_records
+{
+    // Checks the "PMCLI1" header line; on success `body` is everything after it
+    bool split_header(std::string_view data, std::string_view& body)
+    {
+        if (data.empty()) return false; // no header line at all
+
+        // Read the first line as header
+        const size_t eol = data.find('\n');
+        std::string_view header = data.substr(0, eol);
+
+        // Windows CRLF fix: strip trailing '\r'
+        if (!header.empty() && header.back() == '\r') header.remove_suffix(1);
+
+        // Validate file format
+        if (header != "PMCLI1") return false;
+
+        body = (eol == std::string_view::npos) ? std::string_view() : data.substr(eol + 1);
+        return true;
+    }
+
+    void write_record(BufferedWriter& out, const Profile& p)
+    {
+        put_record(out, p);
+    }
+
+    void append_record(std::string& out, const Profile& p)
+    {
+        StringSink sink(out);
+        put_record(sink, p);
+    }
+
+    bool decode_line(std::string_view line, RecordScratch& scratch, int& id, int& age, std::string_view& hobbies)
+    {
+        // Windows CRLF fix: strip trailing '\r'
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        if (line.empty()) return false;
+
+        // Split the line by TAB into fields:
+        // fields[0]=id, fields[1]=age, fields[2]=name, fields[3]=city, fields[4]=country, fields[5]=hobbies(optional)
+        // Anything after the sixth field is ignored, so we stop scanning there.
+        std::string_view fields[6];
+        size_t field_count = 0;
+        {
+            size_t field_start = 0;
+            while (field_count < 6)
+            {
+                size_t tab = line.find('\t', field_start);
+                fields[field_count++] = line.substr(field_start, tab == std::string_view::npos ? std::string_view::npos : tab - field_start);
+                if (tab == std::string_view::npos) break;
+                field_start = tab + 1;
+            }
+        }
+
+        // Require at least 5 fields (id, age, name, city, country)
+        if (field_count < 5) return false;
+
+        // Skip malformed numeric fields rather than crashing.
+        if (!parse_int(fields[0], id) || !parse_int(fields[1], age)) return false;
+
+        // Unescape text fields to restore original content
+        decode_field(fields[2], scratch.name);
+        decode_field(fields[3], scratch.city);
+        decode_field(fields[4], scratch.country);
+
+        // Hobbies are optional
+        hobbies = (field_count >= 6) ? fields[5] : std::string_view();
+        return true;
+    }
+
+    bool parse_id(std::string_view line, int& id)
+    {
+        return parse_int(line.substr(0, line.find('\t')), id);
+    }
+
+    void add_hobbies(std::string_view hobbies, RecordScratch& scratch, Profile& p)
+    {
+        if (hobbies.empty()) return;
+
+        // Split only on unescaped pipes, then unescape each token to restore original hobby text
+        split_unescaped_pipes(hobbies, [&](std::string_view token)
+        {
+            decode_field(token, scratch.hobby);
+            p.add_hobby(scratch.hobby);
+        });
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef PROFILEMANAGERCLI_TEXTRECORDS_HPP
+#define PROFILEMANAGERCLI_TEXTRECORDS_HPP
+
+#include <string>
+#include <string_view>
+
+#include "../domain/Profile.hpp"
+
+class BufferedWriter;
+class StringPool;
+
+// PMCLI1 record lines, shared by the text snapshot and the compressed (PMCLI3) snapshot blocks.
+// One profile per line in a tab-separated format:
+// <id>\t<age>\t<name>\t<city>\t<country>\t<hobby1|hobby2|hobby3>
+namespace text_records
+{
+    // Scratch buffers reused for every record (their capacity survives between lines).
+    // Each parsing thread owns its own instance.
+    struct RecordScratch
+    {
+        std::string name;
+        std::string city;
+        std::string country;
+        std::string hobby;
+    };
+
+    // Checks the "PMCLI1" header line; on success `body` is everything after it
+    bool split_header(std::string_view data, std::string_view& body);
+
+    // Writes one record line (including its '\n'), escaping the text fields
+    void write_record(BufferedWriter& out, const Profile& p);
+    void append_record(std::string& out, const Profile& p);
+
+    // Splits one line (without its '\n') into id, age and the unescaped name/city/country in `scratch`.
+    // `hobbies` receives the still-escaped hobby field. Returns false for malformed lines.
+    bool decode_line(std::string_view line, RecordScratch& scratch, int& id, int& age, std::string_view& hobbies);
+
+    // Reads just the id field of a line (cheap filter before decode_line). Returns false if it is malformed
+    bool parse_id(std::string_view line, int& id);
+
+    // Adds every hobby of an escaped hobby field (as returned by decode_line) to p
+    void add_hobbies(std::string_view hobbies, RecordScratch& scratch, Profile& p);
+
+    // Parses every record line in `text` and passes each well-formed Profile to on_profile (as Profile&).
+    // Profiles intern their text into `strings`.
+    // Blank and malformed lines are skipped, exactly like the original getline-based loader.
+    template <typename Fn>
+    void parse_lines(std::string_view text, RecordScratch& scratch, StringPool& strings, Fn&& on_profile)
+    {
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            const size_t eol = text.find('\n', pos);
+            std::string_view line = text.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+            pos = (eol == std::string_view::npos) ? text.size() : eol + 1;
+
+            int id = 0;
+            int age = 0;
+            std::string_view hobbies;
+            if (!decode_line(line, scratch, id, age, hobbies)) continue;
+
+            Profile p(id, scratch.name, age, scratch.city, scratch.country, strings);
+            add_hobbies(hobbies, scratch, p);
+            on_profile(p);
+        }
+    }
+}
+
+#endif //PROFILEMANAGERCLI_TEXTRECORDS_HPP
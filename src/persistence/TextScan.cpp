@@ -0,0 +1,186 @@
+#include "TextScan.hpp"
+
+// text_scan: scalar / SSE2 / AVX2 byte searches with runtime selection
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define PROFILEMANAGERCLI_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using FindFn = const char* (*)(const char*, const char*);
+
+    // ---- scalar reference implementations ----
+
+    const char* find_escapable_scalar(const char* first, const char* last)
+    {
+        for (; first != last; ++first)
+        {
+            const char ch = *first;
+            if (ch == '\\' || ch == '\t' || ch == '\n' || ch == '|') return first;
+        }
+        return last;
+    }
+
+    const char* find_pipe_or_backslash_scalar(const char* first, const char* last)
+    {
+        for (; first != last; ++first)
+        {
+            if (*first == '\\' || *first == '|') return first;
+        }
+        return last;
+    }
+
+#ifdef PROFILEMANAGERCLI_X86_SIMD
+    // Each block compares 16 (SSE2) or 32 (AVX2) bytes against every needle at once; movemask turns the
+    // per-byte matches into a bit mask whose lowest set bit is the first hit. The tail shorter than one
+    // block goes through the scalar loop, so we never read past `last`.
+
+    const char* find_escapable_sse2(const char* first, const char* last)
+    {
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i pipe = _mm_set1_epi8('|');
+
+        for (; last - first >= 16; first += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, backslash), _mm_cmpeq_epi8(block, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, pipe)));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask != 0) return first + __builtin_ctz(mask);
+        }
+        return find_escapable_scalar(first, last);
+    }
+
+    const char* find_pipe_or_backslash_sse2(const char* first, const char* last)
+    {
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i pipe = _mm_set1_epi8('|');
+
+        for (; last - first >= 16; first += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, backslash), _mm_cmpeq_epi8(block, pipe));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask != 0) return first + __builtin_ctz(mask);
+        }
+        return find_pipe_or_backslash_scalar(first, last);
+    }
+
+    // Compiled for AVX2 regardless of the global -m flags; only called after the CPU check below.
+    __attribute__((target("avx2")))
+    const char* find_escapable_avx2(const char* first, const char* last)
+    {
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i pipe = _mm256_set1_epi8('|');
+
+        for (; last - first >= 32; first += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, backslash), _mm256_cmpeq_epi8(block, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, pipe)));
+            const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (mask != 0) return first + __builtin_ctz(mask);
+        }
+        return find_escapable_sse2(first, last);
+    }
+
+    __attribute__((target("avx2")))
+    const char* find_pipe_or_backslash_avx2(const char* first, const char* last)
+    {
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i pipe = _mm256_set1_epi8('|');
+
+        for (; last - first >= 32; first += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(block, backslash), _mm256_cmpeq_epi8(block, pipe));
+            const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (mask != 0) return first + __builtin_ctz(mask);
+        }
+        return find_pipe_or_backslash_sse2(first, last);
+    }
+#endif
+
+    text_scan::Level detect_best_level()
+    {
+#ifdef PROFILEMANAGERCLI_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return text_scan::Level::AVX2;
+        return text_scan::Level::SSE2;
+#else
+        return text_scan::Level::Scalar;
+#endif
+    }
+
+    struct Kernels
+    {
+        text_scan::Level level;
+        FindFn find_escapable;
+        FindFn find_pipe_or_backslash;
+    };
+
+    Kernels kernels_for(text_scan::Level level)
+    {
+        switch (level)
+        {
+#ifdef PROFILEMANAGERCLI_X86_SIMD
+            case text_scan::Level::AVX2:
+                return {level, find_escapable_avx2, find_pipe_or_backslash_avx2};
+            case text_scan::Level::SSE2:
+                return {level, find_escapable_sse2, find_pipe_or_backslash_sse2};
+#endif
+            default:
+                return {text_scan::Level::Scalar, find_escapable_scalar, find_pipe_or_backslash_scalar};
+        }
+    }
+
+    const text_scan::Level best = detect_best_level();
+    Kernels active = kernels_for(best);
+}
+
+namespace text_scan
+{
+    Level best_level()
+    {
+        return best;
+    }
+
+    Level active_level()
+    {
+        return active.level;
+    }
+
+    void set_level(Level level)
+    {
+        if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+        active = kernels_for(level);
+    }
+
+    const char* level_name(Level level)
+    {
+        switch (level)
+        {
+            case Level::AVX2: return "avx2";
+            case Level::SSE2: return "sse2";
+            default:          return "scalar";
+        }
+    }
+
+    const char* find_escapable(const char* first, const char* last)
+    {
+        return active.find_escapable(first, last);
+    }
+
+    const char* find_pipe_or_backslash(const char* first, const char* last)
+    {
+        return active.find_pipe_or_backslash(first, last);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef PROFILEMANAGERCLI_TEXTSCAN_HPP
+#define PROFILEMANAGERCLI_TEXTSCAN_HPP
+
+// Byte-search kernels for the PMCLI1 text format.
+// Each search looks for the first of a small set of special bytes and has a scalar, an SSE2 (16 bytes
+// per step) and an AVX2 (32 bytes per step) implementation. The widest one the CPU supports is
+// picked at start-up; set_level() can force a narrower one (e.g. to compare against the scalar path).
+namespace text_scan
+{
+    enum class Level
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    Level best_level();   // widest kernel this CPU can run
+    Level active_level(); // kernel currently in use
+    // Select a kernel (clamped to best_level()). Not thread-safe: call it before any parsing starts.
+    void set_level(Level level);
+    const char* level_name(Level level);
+
+    // First '\\', '\t', '\n' or '|' in [first, last), or last. These are the bytes escape_field rewrites.
+    const char* find_escapable(const char* first, const char* last);
+    // First '\\' or '|' in [first, last), or last. Used to split the hobby list on unescaped pipes.
+    const char* find_pipe_or_backslash(const char* first, const char* last);
+}
+
+#endif //PROFILEMANAGERCLI_TEXTSCAN_HPP
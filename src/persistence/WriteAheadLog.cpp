@@ -0,0 +1,575 @@
+#include "WriteAheadLog.hpp"
+#include "../service/ProfileStore.hpp"
+#include "../domain/Profile.hpp"
+#include "ByteOrder.hpp"
+#include "FileSync.hpp"
+#include "MappedFile.hpp"
+#include "ProfileSerializer.hpp"
+
+#include <cstring> // std::memcmp
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+
+// WriteAheadLog: record encoding, group-commit flusher, replay and compaction
+
+namespace
+{
+    using namespace byte_order;
+    using namespace file_sync;
+
+    constexpr char magic[8] = {'P', 'M', 'W', 'A', 'L', '1', '\n', '\0'};
+    constexpr std::size_t header_fixed_size = 20; // magic + generation + name length
+    constexpr std::size_t record_header_size = 8; // payload length + checksum
+
+    enum class WalOp : std::uint8_t
+    {
+        Create = 1,   // full profile: age, name, city, country, hobbies
+        Remove,
+        Clear,
+        AddHobby,
+        RemoveHobby,
+        SetName,
+        SetAge,
+        SetCity,
+        SetCountry
+    };
+
+    // FNV-1a: cheap, and good enough to tell a torn/garbage tail from a real record
+    std::uint32_t checksum(std::string_view bytes)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (char ch : bytes)
+        {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void put_string(std::string& out, std::string_view s)
+    {
+        put_u32(out, static_cast<std::uint32_t>(s.size()));
+        out.append(s);
+    }
+
+    std::string encode_header(std::uint64_t generation, const std::string& base_name)
+    {
+        std::string header(magic, sizeof(magic));
+        put_u64(header, generation);
+        put_string(header, base_name);
+        return header;
+    }
+
+    bool parse_header(std::string_view data, std::uint64_t& generation, std::string& base_name, std::size_t& header_size)
+    {
+        if (data.size() < header_fixed_size || std::memcmp(data.data(), magic, sizeof(magic)) != 0) return false;
+
+        generation = get_u64(data.data() + 8);
+        const std::uint32_t name_length = get_u32(data.data() + 16);
+        if (name_length > data.size() - header_fixed_size) return false;
+
+        base_name.assign(data.data() + header_fixed_size, name_length);
+        header_size = header_fixed_size + name_length;
+        return true;
+    }
+
+    // Bounds-checked reader over one record payload
+    class PayloadReader
+    {
+    private:
+        std::string_view data_;
+        std::size_t pos_ = 0;
+
+    public:
+        explicit PayloadReader(std::string_view data) : data_(data) {}
+
+        bool read_u8(std::uint8_t& value)
+        {
+            if (data_.size() - pos_ < 1) return false;
+            value = static_cast<std::uint8_t>(data_[pos_++]);
+            return true;
+        }
+
+        bool read_int(int& value)
+        {
+            if (data_.size() - pos_ < 4) return false;
+            value = static_cast<int>(get_u32(data_.data() + pos_));
+            pos_ += 4;
+            return true;
+        }
+
+        bool read_string(std::string& value)
+        {
+            if (data_.size() - pos_ < 4) return false;
+            const std::uint32_t length = get_u32(data_.data() + pos_);
+            pos_ += 4;
+            if (data_.size() - pos_ < length) return false;
+            value.assign(data_.data() + pos_, length);
+            pos_ += length;
+            return true;
+        }
+    };
+
+    // Applies a single decoded record to the store. Returns false if the payload is malformed.
+    // Edits addressed to ids that no longer exist are ignored, just like the live call would have been.
+    bool apply_record(std::string_view payload, ProfileStore& store)
+    {
+        PayloadReader in(payload);
+        std::uint8_t op = 0;
+        if (!in.read_u8(op)) return false;
+
+        if (static_cast<WalOp>(op) == WalOp::Clear)
+        {
+            store.clear();
+            return true;
+        }
+
+        int id = 0;
+        if (!in.read_int(id)) return false;
+
+        std::string text;
+        switch (static_cast<WalOp>(op))
+        {
+            case WalOp::Create:
+            {
+                int age = 0;
+                std::string name, city, country;
+                int hobby_count = 0;
+                if (!in.read_int(age) || !in.read_string(name) || !in.read_string(city) ||
+                    !in.read_string(country) || !in.read_int(hobby_count)) return false;
+
+                Profile p(id, name, age, city, country, store.strings());
+                for (int i = 0; i < hobby_count; ++i)
+                {
+                    if (!in.read_string(text)) return false;
+                    p.add_hobby(text);
+                }
+                store.insert_profile(std::move(p));
+                return true;
+            }
+            case WalOp::Remove:
+                store.remove(id);
+                return true;
+            case WalOp::SetAge:
+            {
+                int age = 0;
+                if (!in.read_int(age)) return false;
+                if (Profile* p = store.find(id)) p->set_age(age);
+                return true;
+            }
+            case WalOp::AddHobby:
+            case WalOp::RemoveHobby:
+            case WalOp::SetName:
+            case WalOp::SetCity:
+            case WalOp::SetCountry:
+            {
+                if (!in.read_string(text)) return false;
+                Profile* p = store.find(id);
+                if (!p) return true;
+
+                switch (static_cast<WalOp>(op))
+                {
+                    case WalOp::AddHobby:    p->add_hobby(text); break;
+                    case WalOp::RemoveHobby: p->remove_hobby(text); break;
+                    case WalOp::SetName:     p->set_name(text); break;
+                    case WalOp::SetCity:     p->set_city(text); break;
+                    default:                 p->set_country(text); break;
+                }
+                return true;
+            }
+            default:
+                return false; // unknown op: treat like corruption
+        }
+    }
+
+    // Replays records in order and returns how many bytes of valid records were consumed.
+    // Stops at the first incomplete or corrupt record, which can only be a torn write at the tail.
+    std::size_t apply_records(std::string_view records, ProfileStore& store, std::size_t& applied)
+    {
+        std::size_t pos = 0;
+        while (records.size() - pos >= record_header_size)
+        {
+            const std::uint32_t length = get_u32(records.data() + pos);
+            const std::uint32_t expected = get_u32(records.data() + pos + 4);
+            if (length > records.size() - pos - record_header_size) break;
+
+            const std::string_view payload = records.substr(pos + record_header_size, length);
+            if (checksum(payload) != expected || !apply_record(payload, store)) break;
+
+            ++applied;
+            pos += record_header_size + length;
+        }
+        return pos;
+    }
+
+    bool write_and_sync(std::FILE* file, const std::string& bytes)
+    {
+        if (!file) return false;
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) return false;
+        return sync_file(file);
+    }
+
+    // Writes a whole file durably (used for the log header and compacted logs)
+    bool write_file(const std::string& path, const std::string& bytes)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        const bool ok = write_and_sync(file, bytes);
+        return (std::fclose(file) == 0) && ok;
+    }
+}
+
+WriteAheadLog::WriteAheadLog(WalOptions options) : options_(options) {}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close();
+}
+
+std::string WriteAheadLog::resolve(const std::string& name) const
+{
+    // Snapshot names are stored relative to the log so the pair can be moved together
+    return (std::filesystem::path(path_).parent_path() / name).string();
+}
+
+bool WriteAheadLog::open(const std::string& path, ProfileStore& store)
+{
+    close();
+    path_ = path;
+    replayed_ = 0;
+
+    std::error_code ec;
+    bool fresh = !std::filesystem::exists(path, ec);
+
+    std::uint64_t log_size = 0;
+    if (fresh)
+    {
+        const std::string header = encode_header(0, std::string());
+        if (!write_file(path, header)) return false;
+        sync_directory(std::filesystem::path(path).parent_path());
+        generation_ = 0;
+        base_name_.clear();
+        log_size = header.size();
+    }
+    else
+    {
+        MappedFile log;
+        if (!log.open(path)) return false;
+
+        std::size_t header_size = 0;
+        if (!parse_header(log.view(), generation_, base_name_, header_size)) return false;
+
+        // Rebuild the state: base snapshot first, then every logged mutation on top of it
+        if (!base_name_.empty())
+        {
+            if (!ProfileSerializer::load(store, resolve(base_name_))) return false;
+        }
+        else
+        {
+            store.clear();
+        }
+
+        const std::size_t valid = apply_records(log.view().substr(header_size), store, replayed_);
+        log_size = header_size + valid;
+
+        // Drop a torn tail so new records are appended right after the last good one
+        if (log_size < log.size())
+        {
+            log = MappedFile();
+            std::filesystem::resize_file(path, log_size, ec);
+            if (ec) return false;
+        }
+    }
+
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_) return false;
+    file_size_ = log_size;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        appended_ = 0;
+        durable_ = 0;
+        stopping_ = false;
+        failed_ = false;
+    }
+    flusher_ = std::thread([this]() { flusher_loop(); });
+
+    store_ = &store;
+    store.add_listener(this);
+
+    // A new log must also describe whatever the store already held
+    if (fresh)
+    {
+        store.for_each_ordered([this](const Profile& p) { profile_added(p); });
+    }
+    return true;
+}
+
+void WriteAheadLog::close()
+{
+    if (store_)
+    {
+        store_->remove_listener(this);
+        store_ = nullptr;
+    }
+
+    // Drain the last batch before stopping the flusher, then let a running compaction finish
+    if (flusher_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        pending_cv_.notify_all();
+        flusher_.join();
+    }
+    wait_for_compaction();
+
+    std::lock_guard<std::mutex> io(io_mutex_);
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool WriteAheadLog::sync()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::uint64_t target = appended_;
+    if (durable_ >= target || !flusher_.joinable()) return !failed_;
+
+    // Waiters cut the group-commit window short
+    ++sync_waiters_;
+    pending_cv_.notify_all();
+    durable_cv_.wait(lock, [&]() { return durable_ >= target || failed_; });
+    --sync_waiters_;
+    return !failed_;
+}
+
+std::size_t WriteAheadLog::replayed_records() const
+{
+    return replayed_;
+}
+
+std::uint64_t WriteAheadLog::log_bytes() const
+{
+    std::lock_guard<std::mutex> io(io_mutex_);
+    return file_size_;
+}
+
+void WriteAheadLog::append_record()
+{
+    std::string header;
+    put_u32(header, static_cast<std::uint32_t>(record_.size()));
+    put_u32(header, checksum(record_));
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake = pending_.empty(); // the flusher only sleeps on "nothing pending"
+        pending_ += header;
+        pending_ += record_;
+        appended_ += header.size() + record_.size();
+    }
+    if (wake) pending_cv_.notify_one();
+}
+
+void WriteAheadLog::profile_added(const Profile& profile)
+{
+    record_.clear();
+    record_.push_back(static_cast<char>(WalOp::Create));
+    put_u32(record_, static_cast<std::uint32_t>(profile.id()));
+    put_u32(record_, static_cast<std::uint32_t>(profile.age()));
+    put_string(record_, profile.name());
+    put_string(record_, profile.city());
+    put_string(record_, profile.country());
+    const auto& hobbies = profile.hobbies();
+    put_u32(record_, static_cast<std::uint32_t>(hobbies.size()));
+    for (const auto& hobby : hobbies) put_string(record_, hobby);
+    append_record();
+}
+
+void WriteAheadLog::profile_removed(const Profile& profile)
+{
+    record_.clear();
+    record_.push_back(static_cast<char>(WalOp::Remove));
+    put_u32(record_, static_cast<std::uint32_t>(profile.id()));
+    append_record();
+}
+
+void WriteAheadLog::store_cleared()
+{
+    record_.clear();
+    record_.push_back(static_cast<char>(WalOp::Clear));
+    append_record();
+}
+
+void WriteAheadLog::profile_changed(const Profile& profile, ProfileField field, const std::string& hobby)
+{
+    record_.clear();
+    switch (field)
+    {
+        case ProfileField::Name:         record_.push_back(static_cast<char>(WalOp::SetName)); break;
+        case ProfileField::Age:          record_.push_back(static_cast<char>(WalOp::SetAge)); break;
+        case ProfileField::City:         record_.push_back(static_cast<char>(WalOp::SetCity)); break;
+        case ProfileField::Country:      record_.push_back(static_cast<char>(WalOp::SetCountry)); break;
+        case ProfileField::HobbyAdded:   record_.push_back(static_cast<char>(WalOp::AddHobby)); break;
+        case ProfileField::HobbyRemoved: record_.push_back(static_cast<char>(WalOp::RemoveHobby)); break;
+    }
+    put_u32(record_, static_cast<std::uint32_t>(profile.id()));
+
+    switch (field)
+    {
+        case ProfileField::Name:    put_string(record_, profile.name()); break;
+        case ProfileField::Age:     put_u32(record_, static_cast<std::uint32_t>(profile.age())); break;
+        case ProfileField::City:    put_string(record_, profile.city()); break;
+        case ProfileField::Country: put_string(record_, profile.country()); break;
+        default:                    put_string(record_, hobby); break;
+    }
+    append_record();
+}
+
+void WriteAheadLog::flusher_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        pending_cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) return; // stopping and fully drained
+
+        // Group commit: let more records join this batch, unless someone waits in sync() or we are closing
+        if (!stopping_ && sync_waiters_ == 0)
+        {
+            pending_cv_.wait_for(lock, options_.commit_interval,
+                                 [this]() { return stopping_ || sync_waiters_ > 0; });
+        }
+
+        writing_.swap(pending_);
+        const std::uint64_t batch_end = appended_;
+        lock.unlock();
+
+        // One write() + one fsync() for the whole batch
+        bool ok = false;
+        std::uint64_t log_size = 0;
+        {
+            std::lock_guard<std::mutex> io(io_mutex_);
+            ok = write_and_sync(file_, writing_);
+            if (ok) file_size_ += writing_.size();
+            log_size = file_size_;
+        }
+        writing_.clear();
+
+        lock.lock();
+        durable_ = batch_end;
+        if (!ok) failed_ = true;
+        durable_cv_.notify_all();
+
+        if (ok && !stopping_ && options_.compact_threshold > 0 && log_size >= options_.compact_threshold && !compacting_)
+        {
+            lock.unlock();
+            compact();
+            lock.lock();
+        }
+    }
+}
+
+bool WriteAheadLog::compact()
+{
+    std::lock_guard<std::mutex> guard(compact_mutex_);
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+        if (!file_) return false;
+    }
+    if (compacting_) return false;
+    if (compactor_.joinable()) compactor_.join(); // previous run already finished
+
+    compacting_ = true;
+    compactor_ = std::thread([this]()
+    {
+        run_compaction();
+        compacting_ = false;
+    });
+    return true;
+}
+
+void WriteAheadLog::wait_for_compaction()
+{
+    std::lock_guard<std::mutex> guard(compact_mutex_);
+    if (compactor_.joinable()) compactor_.join();
+}
+
+void WriteAheadLog::run_compaction()
+{
+    std::string base_name;
+    std::uint64_t generation = 0;
+    std::uint64_t fold_end = 0;
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+        base_name = base_name_;
+        generation = generation_;
+        fold_end = file_size_;
+    }
+
+    // Rebuild the logged state from the files alone, so the live store is never read off-thread.
+    // Records appended from now on land after fold_end and are carried over below.
+    ProfileStore folded;
+    folded.set_indexing(false); // only written out again
+    folded.set_allocation_mode(AllocationMode::Arena);
+    if (!base_name.empty() && !ProfileSerializer::load(folded, resolve(base_name))) return;
+    {
+        MappedFile log;
+        if (!log.open(path_) || log.size() < fold_end) return;
+
+        const std::string_view image = log.view().substr(0, fold_end);
+        std::uint64_t ignored_generation = 0;
+        std::string ignored_name;
+        std::size_t header_size = 0;
+        if (!parse_header(image, ignored_generation, ignored_name, header_size)) return;
+
+        std::size_t applied = 0;
+        apply_records(image.substr(header_size), folded, applied);
+    }
+
+    const std::string snapshot_name =
+        std::filesystem::path(path_).filename().string() + ".snap" + std::to_string(generation + 1);
+    const std::string snapshot_path = resolve(snapshot_name);
+    if (!ProfileSerializer::save(folded, snapshot_path, SnapshotFormat::Binary)) return;
+    if (!sync_existing_file(snapshot_path)) return;
+
+    // Swap in a log that names the new snapshot and keeps only the unfolded tail.
+    // The rename is the commit point: before it the old log + old snapshot are current, after it the new pair.
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+
+        MappedFile current;
+        if (!current.open(path_) || current.size() < file_size_) return;
+
+        std::string image = encode_header(generation + 1, snapshot_name);
+        const std::string_view tail = current.view().substr(fold_end, file_size_ - fold_end);
+        image.append(tail.data(), tail.size());
+        current = MappedFile();
+
+        const std::string temp_path = path_ + ".tmp";
+        if (!write_file(temp_path, image)) return;
+
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path_, ec);
+        if (ec) return;
+        sync_directory(std::filesystem::path(path_).parent_path());
+
+        std::fclose(file_);
+        file_ = std::fopen(path_.c_str(), "ab");
+        file_size_ = image.size();
+        generation_ = generation + 1;
+        base_name_ = snapshot_name;
+    }
+
+    if (!base_name.empty())
+    {
+        std::error_code ec;
+        std::filesystem::remove(resolve(base_name), ec);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef PROFILEMANAGERCLI_WRITEAHEADLOG_HPP
+#define PROFILEMANAGERCLI_WRITEAHEADLOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../service/ProfileStoreListener.hpp"
+
+class ProfileStore;
+
+struct WalOptions
+{
+    // Group commit window: records arriving within this interval share one write() + fsync()
+    std::chrono::milliseconds commit_interval{5};
+    // Start a background compaction once the log file grows past this size (0 = never automatically)
+    std::uint64_t compact_threshold = 64ull << 20;
+};
+
+// Append-only write-ahead log of ProfileStore mutations.
+//
+// File layout:  "PMWAL1\n\0" | u64 generation | u32 name length | base snapshot file name
+//               then records: u32 payload length | u32 checksum | payload (u8 op | i32 id | op fields)
+//
+// The log names the snapshot it applies on top of, so the log file itself is the single commit point:
+// compaction writes a new snapshot next to it and then atomically replaces the log with one that names
+// the new snapshot and holds only the records that arrived meanwhile.
+// A torn record at the end (crash mid-write) is detected by its checksum and dropped on open.
+class WriteAheadLog : public ProfileStoreListener
+{
+public:
+    explicit WriteAheadLog(WalOptions options = WalOptions());
+    ~WriteAheadLog() override; // close()
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Opens (or creates) the log at path. An existing log replaces the store contents with
+    // its base snapshot plus the replayed records; a new log starts from what the store already holds.
+    // From then on every store mutation is appended. Returns false if the log or its snapshot is unreadable.
+    bool open(const std::string& path, ProfileStore& store);
+
+    // Stops logging, makes everything durable and waits for a running compaction
+    void close();
+
+    // Blocks until every record appended so far is on disk. Returns false if a write failed
+    bool sync();
+
+    // Starts folding the log into a new snapshot on a background thread.
+    // Returns false if the log is not open or a compaction is already running.
+    bool compact();
+    void wait_for_compaction();
+
+    std::size_t replayed_records() const; // records applied by open()
+    std::uint64_t log_bytes() const;      // current size of the log file (flushed part)
+
+    // ProfileStoreListener
+    void profile_added(const Profile& profile) override;
+    void profile_removed(const Profile& profile) override;
+    void store_cleared() override;
+    void profile_changed(const Profile& profile, ProfileField field, const std::string& hobby) override;
+
+private:
+    WalOptions options_;
+    ProfileStore* store_ = nullptr;
+    std::string path_;
+    std::size_t replayed_ = 0;
+
+    // Encoded records waiting for the next group commit (guarded by mutex_)
+    std::mutex mutex_;
+    std::condition_variable pending_cv_;
+    std::condition_variable durable_cv_;
+    std::string pending_;
+    std::string writing_;          // spare buffer swapped with pending_ by the flusher
+    std::uint64_t appended_ = 0;   // bytes ever appended to pending_
+    std::uint64_t durable_ = 0;    // bytes ever written + synced
+    int sync_waiters_ = 0;
+    bool stopping_ = false;
+    bool failed_ = false;
+    std::thread flusher_;
+
+    // The log file itself (guarded by io_mutex_, so compaction can swap it safely)
+    mutable std::mutex io_mutex_;
+    std::FILE* file_ = nullptr;
+    std::uint64_t file_size_ = 0;
+    std::uint64_t generation_ = 0;
+    std::string base_name_;        // snapshot file name, relative to the log's directory
+
+    std::string record_;           // scratch for encoding one record (store thread only)
+
+    std::mutex compact_mutex_;
+    std::thread compactor_;
+    std::atomic<bool> compacting_{false};
+
+    void append_record();
+    void flusher_loop();
+    void run_compaction();
+    std::string resolve(const std::string& name) const;
+};
+
+#endif //PROFILEMANAGERCLI_WRITEAHEADLOG_HPP
@@ -0,0 +1,60 @@
+#ifndef PROFILEMANAGERCLI_CHANGESET_HPP
+#define PROFILEMANAGERCLI_CHANGESET_HPP
+
+#include <string>
+#include <unordered_set>
+
+// Ids changed since the store's contents last matched a file on disk (its baseline), used by delta saves.
+// A profile is either dirty (created, inserted or edited: its current record must be written) or
+// deleted (removed: its old record must be dropped), never both.
+// Without a baseline (a new store, or after clear()) nothing is recorded per id: everything counts as
+// changed and only a full save can describe the contents. That also keeps bulk loads free of tracking.
+class ChangeSet
+{
+private:
+    std::unordered_set<int> dirty_;
+    std::unordered_set<int> deleted_;
+    bool baseline_ = false;
+    std::string source_; // the file the baseline came from / went to
+
+public:
+    bool has_baseline() const { return baseline_; }
+    const std::string& source() const { return source_; }
+    const std::unordered_set<int>& dirty() const { return dirty_; }
+    const std::unordered_set<int>& deleted() const { return deleted_; }
+    bool empty() const { return baseline_ && dirty_.empty() && deleted_.empty(); }
+
+    void modified(int id)
+    {
+        if (!baseline_) return;
+        dirty_.insert(id);
+        deleted_.erase(id);
+    }
+
+    void removed(int id)
+    {
+        if (!baseline_) return;
+        deleted_.insert(id);
+        dirty_.erase(id);
+    }
+
+    // The contents no longer relate to any file (clear())
+    void drop_baseline()
+    {
+        baseline_ = false;
+        source_.clear();
+        dirty_.clear();
+        deleted_.clear();
+    }
+
+    // The contents now match the file at `source` exactly (after a load or a save)
+    void mark_clean(const std::string& source)
+    {
+        baseline_ = true;
+        source_ = source;
+        dirty_.clear();
+        deleted_.clear();
+    }
+};
+
+#endif //PROFILEMANAGERCLI_CHANGESET_HPP
@@ -0,0 +1,193 @@
+#include "ConcurrentProfileStore.hpp"
+#include "../util/ThreadPool.hpp"
+
+#include <algorithm> // std::sort
+#include <utility>
+
+// ConcurrentProfileStore: sharded ProfileStore behind per-shard reader-writer locks
+
+ConcurrentProfileStore::ConcurrentProfileStore(unsigned shard_count)
+{
+    // A few shards per thread keeps two writers from landing on the same lock most of the time
+    if (shard_count == 0) shard_count = ThreadPool::resolve_thread_count(0) * 4;
+
+    shards_.reserve(shard_count);
+    for (unsigned i = 0; i < shard_count; ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>());
+        shards_.back()->store.set_indexing(false); // per-shard indexes would only answer part of a query
+    }
+}
+
+ConcurrentProfileStore::Shard& ConcurrentProfileStore::shard_for(int id)
+{
+    // Ids are handed out sequentially, so modulo spreads them evenly (unsigned keeps negatives in range)
+    return *shards_[static_cast<unsigned>(id) % shards_.size()];
+}
+
+const ConcurrentProfileStore::Shard& ConcurrentProfileStore::shard_for(int id) const
+{
+    return *shards_[static_cast<unsigned>(id) % shards_.size()];
+}
+
+void ConcurrentProfileStore::bump_next_id(int id)
+{
+    int current = next_id_.load(std::memory_order_relaxed);
+    while (id >= current && !next_id_.compare_exchange_weak(current, id + 1, std::memory_order_relaxed))
+    {
+        // compare_exchange_weak reloaded `current`; try again while it is still too small
+    }
+}
+
+void ConcurrentProfileStore::capture(Shard& shard, const Profile& profile)
+{
+    // Only the first write after the snapshot matters: that is the state the snapshot has to see
+    if (shard.preimages.count(profile.id())) return;
+
+    Profile copy = profile;
+    copy.rebind(shard.capture_strings);
+    shard.preimages.emplace(profile.id(), std::move(copy));
+}
+
+void ConcurrentProfileStore::capture_new(Shard& shard, int id)
+{
+    shard.preimages.emplace(id, std::nullopt); // no-op if the id already has a preimage
+}
+
+int ConcurrentProfileStore::create_profile(const std::string& name,
+                                           int age,
+                                           const std::string& city,
+                                           const std::string& country)
+{
+    const int id = next_id_.fetch_add(1, std::memory_order_relaxed);
+
+    Shard& shard = shard_for(id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.capturing) capture_new(shard, id);
+    // Built against the shard's own pool, so insert_profile does not need to re-intern
+    shard.store.insert_profile(Profile(id, name, age, city, country, shard.store.strings()));
+    return id;
+}
+
+bool ConcurrentProfileStore::insert_profile(const Profile& profile)
+{
+    Shard& shard = shard_for(profile.id());
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.store.insert_profile(profile)) return false;
+        if (shard.capturing) capture_new(shard, profile.id());
+    }
+    bump_next_id(profile.id());
+    return true;
+}
+
+bool ConcurrentProfileStore::remove(int id)
+{
+    Shard& shard = shard_for(id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.capturing)
+    {
+        if (const Profile* p = shard.store.find(id)) capture(shard, *p);
+    }
+    return shard.store.remove(id);
+}
+
+std::vector<int> ConcurrentProfileStore::list_ids() const
+{
+    std::vector<int> ids;
+    for (const auto& shard : shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        shard->store.for_each([&](const Profile& p) { ids.push_back(p.id()); });
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::size_t ConcurrentProfileStore::size() const
+{
+    std::size_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->store.size();
+    }
+    return total;
+}
+
+std::size_t ConcurrentProfileStore::shard_count() const
+{
+    return shards_.size();
+}
+
+void ConcurrentProfileStore::clear()
+{
+    // Take every lock (always in shard order, so two clear() calls cannot deadlock)
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(shards_.size());
+    for (const auto& shard : shards_) locks.emplace_back(shard->mutex);
+
+    for (const auto& shard : shards_)
+    {
+        if (shard->capturing) shard->store.for_each([&](const Profile& p) { capture(*shard, p); });
+        shard->store.clear();
+    }
+    next_id_.store(1, std::memory_order_relaxed);
+}
+
+ConcurrentProfileStore::Snapshot ConcurrentProfileStore::open_snapshot()
+{
+    return Snapshot(*this);
+}
+
+ConcurrentProfileStore::Snapshot::Snapshot(ConcurrentProfileStore& store)
+    : store_(&store), hold_(store.snapshot_mutex_)
+{
+    // Lock every shard at once for a moment, so the snapshot is one point in time across shards
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(store.shards_.size());
+    for (const auto& shard : store.shards_) locks.emplace_back(shard->mutex);
+    for (const auto& shard : store.shards_) shard->capturing = true;
+}
+
+ConcurrentProfileStore::Snapshot::Snapshot(Snapshot&& other) noexcept
+    : store_(std::exchange(other.store_, nullptr)), hold_(std::move(other.hold_)){}
+
+ConcurrentProfileStore::Snapshot::~Snapshot()
+{
+    if (!store_) return; // moved from
+
+    for (const auto& shard : store_->shards_)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        shard->capturing = false;
+        shard->preimages.clear();
+        shard->capture_strings.clear();
+    }
+}
+
+std::vector<int> ConcurrentProfileStore::Snapshot::shard_ids(const Shard& shard) const
+{
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    std::vector<int> ids;
+    ids.reserve(shard.store.size() + shard.preimages.size());
+    shard.store.for_each([&](const Profile& p) { ids.push_back(p.id()); });
+
+    // Removed since the snapshot: only the preimage is left
+    for (const auto& kv : shard.preimages)
+    {
+        if (kv.second && !shard.store.find(kv.first)) ids.push_back(kv.first);
+    }
+    return ids;
+}
+
+std::size_t ConcurrentProfileStore::Snapshot::captured() const
+{
+    std::size_t count = 0;
+    for (const auto& shard : store_->shards_)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        count += shard->preimages.size();
+    }
+    return count;
+}
@@ -0,0 +1,174 @@
+#ifndef PROFILEMANAGERCLI_CONCURRENTPROFILESTORE_HPP
+#define PROFILEMANAGERCLI_CONCURRENTPROFILESTORE_HPP
+
+#include <algorithm> // std::sort
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../domain/Profile.hpp"
+#include "ProfileStore.hpp"
+
+// Thread-safe profile store for multi-threaded servers and workers.
+// The id space is split across N shards (id % N); each shard is an ordinary ProfileStore guarded
+// by its own reader-writer lock, so readers never block each other and writers only block
+// the one shard they touch. Ids come from an atomic counter instead of next_id_++.
+//
+// Profiles never escape the lock: read() and update() run a callback while the shard is locked
+// (shared for read, exclusive for update). Callbacks must not call back into the same store.
+//
+// open_snapshot() gives a point-in-time view for saving while writers keep going (copy-on-write):
+// while a snapshot is open, the first write to a profile copies its old state aside, and ids
+// created after the snapshot are marked as such. Memory is proportional to the number of
+// profiles touched during the snapshot, not to the store size.
+class ConcurrentProfileStore
+{
+private:
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        ProfileStore store; // ids only ever come in through insert_profile
+
+        // Copy-on-write state, only used while a snapshot is open.
+        // preimages: id -> state at snapshot time (nullopt: the id did not exist yet)
+        bool capturing = false;
+        std::unordered_map<int, std::optional<Profile>> preimages;
+        StringPool capture_strings; // preimages are re-interned here, so store.clear() can't pull strings away
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_; // unique_ptr: shards hold a mutex, so they can't move
+    std::atomic<int> next_id_{1};
+    std::mutex snapshot_mutex_; // held by the open Snapshot (one at a time)
+
+    Shard& shard_for(int id);
+    const Shard& shard_for(int id) const;
+    void bump_next_id(int id); // next_id_ = max(next_id_, id + 1)
+
+    // Copy-on-write hooks, called with the shard locked exclusively
+    static void capture(Shard& shard, const Profile& profile); // before the first change/removal
+    static void capture_new(Shard& shard, int id);             // id did not exist at snapshot time
+
+public:
+    // shard_count == 0 picks a default from the hardware thread count
+    explicit ConcurrentProfileStore(unsigned shard_count = 0);
+
+    ConcurrentProfileStore(const ConcurrentProfileStore&) = delete;
+    ConcurrentProfileStore& operator=(const ConcurrentProfileStore&) = delete;
+
+    int create_profile(const std::string& name, int age, const std::string& city, const std::string& country);
+    bool insert_profile(const Profile& profile); // false if the id is taken
+    bool remove(int id);
+
+    // Runs fn(const Profile&) under the shard's shared lock. False if the id does not exist
+    template <typename Fn>
+    bool read(int id, Fn&& fn) const
+    {
+        const Shard& shard = shard_for(id);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const Profile* p = shard.store.find(id);
+        if (!p) return false;
+        fn(*p);
+        return true;
+    }
+
+    // Runs fn(Profile&) under the shard's exclusive lock. False if the id does not exist
+    template <typename Fn>
+    bool update(int id, Fn&& fn)
+    {
+        Shard& shard = shard_for(id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Profile* p = shard.store.find(id);
+        if (!p) return false;
+        if (shard.capturing) capture(shard, *p);
+        fn(*p);
+        return true;
+    }
+
+    // Visits every profile, one shard at a time under its shared lock.
+    // Each shard is consistent on its own; writers may change other shards in between.
+    template <typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        for (const auto& shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            shard->store.for_each(fn);
+        }
+    }
+
+    // Point-in-time view of the store. Move-only; closing (destruction) drops the copied preimages.
+    // Only one snapshot can be open at a time: opening a second one waits for the first to close.
+    class Snapshot
+    {
+    private:
+        ConcurrentProfileStore* store_ = nullptr;
+        std::unique_lock<std::mutex> hold_;
+
+        // Visits the snapshot version of `id` (if it existed at snapshot time) under the shard's shared lock
+        template <typename Fn>
+        void visit(int id, Fn& fn) const
+        {
+            const Shard& shard = store_->shard_for(id);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto pre = shard.preimages.find(id);
+            if (pre != shard.preimages.end())
+            {
+                if (pre->second) fn(*pre->second);
+                return;
+            }
+            if (const Profile* p = shard.store.find(id)) fn(*p);
+        }
+
+        std::vector<int> shard_ids(const Shard& shard) const; // live ids + preimage ids of one shard
+
+    public:
+        explicit Snapshot(ConcurrentProfileStore& store);
+        ~Snapshot();
+        Snapshot(Snapshot&& other) noexcept;
+        Snapshot& operator=(Snapshot&& other) = delete;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        // Visit every profile as it was when the snapshot was opened.
+        // Each profile is read under its shard's shared lock, so writers are only held up per profile.
+        template <typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            for (const auto& shard : store_->shards_)
+            {
+                for (int id : shard_ids(*shard)) visit(id, fn);
+            }
+        }
+
+        // Same, in ascending id order
+        template <typename Fn>
+        void for_each_ordered(Fn&& fn) const
+        {
+            std::vector<int> ids;
+            for (const auto& shard : store_->shards_)
+            {
+                const std::vector<int> part = shard_ids(*shard);
+                ids.insert(ids.end(), part.begin(), part.end());
+            }
+            std::sort(ids.begin(), ids.end());
+            for (int id : ids) visit(id, fn);
+        }
+
+        std::size_t captured() const; // preimages copied so far (the snapshot's memory cost)
+    };
+
+    Snapshot open_snapshot();
+
+    std::vector<int> list_ids() const; // sorted
+    std::size_t size() const;
+    std::size_t shard_count() const;
+    void clear(); // also resets the id counter; don't race it against create_profile
+};
+
+#endif //PROFILEMANAGERCLI_CONCURRENTPROFILESTORE_HPP
@@ -0,0 +1,528 @@
+#include "NameIndex.hpp"
+#include "../domain/Profile.hpp"
+
+#include <algorithm> // std::lower_bound, std::sort, std::unique, heap functions
+#include <limits>
+#include <string>
+
+// NameIndex: trigram posting lists over profile names
+
+namespace
+{
+    constexpr std::size_t gram_count = std::size_t(1) << 18; // 3 codes of 6 bits
+
+    // 0 = separator (and the padding in front of a word), 1-26 letters, 27-36 digits,
+    // 37-62 non-ASCII bytes (folded together modulo 26; matches are verified on the real name anyway),
+    // 63 = the padding in front of a name's first word
+    constexpr unsigned word_pad = 0;
+    constexpr unsigned name_pad = 63;
+
+    struct CodeTable
+    {
+        unsigned char codes[256] = {};
+
+        CodeTable()
+        {
+            for (unsigned ch = 0; ch < 256; ++ch)
+            {
+                if (ch >= 'a' && ch <= 'z') codes[ch] = static_cast<unsigned char>(ch - 'a' + 1);
+                else if (ch >= 'A' && ch <= 'Z') codes[ch] = static_cast<unsigned char>(ch - 'A' + 1);
+                else if (ch >= '0' && ch <= '9') codes[ch] = static_cast<unsigned char>(ch - '0' + 27);
+                else if (ch >= 0x80) codes[ch] = static_cast<unsigned char>(37 + ch % 26);
+            }
+        }
+    };
+    const CodeTable code_table;
+
+    unsigned code(unsigned char ch)
+    {
+        return code_table.codes[ch];
+    }
+
+    std::uint32_t gram(unsigned a, unsigned b, unsigned c)
+    {
+        return (a << 12) | (b << 6) | c;
+    }
+
+    // The three kinds of grams, told apart by their first code
+    bool is_trigram(std::uint32_t g)
+    {
+        const unsigned lead = g >> 12;
+        return lead != word_pad && lead != name_pad;
+    }
+
+    bool is_word_start(std::uint32_t g)
+    {
+        return (g >> 12) == word_pad;
+    }
+
+    bool is_name_start(std::uint32_t g)
+    {
+        return (g >> 12) == name_pad;
+    }
+
+    // Calls fn(gram) for every gram of text, in order (a gram repeated in the text is visited again).
+    // One pass: `run` is the position inside the current word and the last two codes make the next trigram.
+    template <typename Fn>
+    void for_each_gram(std::string_view text, Fn&& fn)
+    {
+        std::size_t run = 0;
+        bool first_word = true;
+        unsigned before = 0;
+        unsigned last = 0;
+        for (const char ch : text)
+        {
+            const unsigned c = code(static_cast<unsigned char>(ch));
+            if (c == 0)
+            {
+                if (run > 0) first_word = false;
+                run = 0;
+                continue;
+            }
+            ++run;
+            if (run == 1)
+            {
+                fn(gram(word_pad, word_pad, c));
+                if (first_word) fn(gram(name_pad, name_pad, c));
+            }
+            else if (run == 2)
+            {
+                fn(gram(word_pad, last, c));
+                if (first_word) fn(gram(name_pad, last, c));
+            }
+            else
+            {
+                fn(gram(before, last, c));
+            }
+            before = last;
+            last = c;
+        }
+    }
+
+    // Lower-case letters, one ' ' for any separator, other bytes unchanged
+    char fold(char ch)
+    {
+        const auto byte = static_cast<unsigned char>(ch);
+        if (byte >= 'A' && byte <= 'Z') return static_cast<char>(byte - 'A' + 'a');
+        return code(byte) == 0 ? ' ' : ch;
+    }
+
+    // Does name (unfolded) contain the folded query at pos?
+    bool matches_at(std::string_view name, std::size_t pos, std::string_view query)
+    {
+        for (std::size_t i = 0; i < query.size(); ++i)
+        {
+            if (fold(name[pos + i]) != query[i]) return false;
+        }
+        return true;
+    }
+
+    using SlotIterator = std::vector<std::uint32_t>::const_iterator;
+
+    // First position in [first, last) whose slot is >= slot. Galloping: the slots looked for only grow,
+    // so the answer is usually a few steps past `first`.
+    SlotIterator seek(SlotIterator first, SlotIterator last, std::uint32_t slot)
+    {
+        std::size_t step = 1;
+        while (static_cast<std::size_t>(last - first) > step && first[step] < slot)
+        {
+            first += step;
+            step *= 2;
+        }
+        const std::size_t span = std::min(step + 1, static_cast<std::size_t>(last - first));
+        return std::lower_bound(first, first + span, slot);
+    }
+
+    // Compaction threshold: dead or out-of-order slots above a quarter of all slots (and a floor, so
+    // small indexes are not renumbered every few edits)
+    bool worth_compacting(std::size_t stale, std::size_t slots)
+    {
+        return stale > 1024 && stale > slots / 4;
+    }
+
+    // A match plus what ranks it
+    struct Ranked
+    {
+        NameMatch match;
+        std::size_t length = 0;
+    };
+
+    // True if a ranks before b
+    bool better(const Ranked& a, const Ranked& b)
+    {
+        if (a.match.kind != b.match.kind) return a.match.kind < b.match.kind;
+        if (a.match.similarity != b.match.similarity) return a.match.similarity > b.match.similarity;
+        if (a.length != b.length) return a.length < b.length;
+        return a.match.id < b.match.id;
+    }
+}
+
+void NameIndex::grams_of(std::string_view text, std::vector<Gram>& grams)
+{
+    grams.clear();
+    for_each_gram(text, [&](Gram g) { grams.push_back(g); });
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+void NameIndex::suspend()
+{
+    clear();
+    suspended_ = true;
+}
+
+void NameIndex::build(const ProfileWalk& walk)
+{
+    clear();
+    by_gram_.resize(gram_count);
+
+    // Profiles arrive in ascending id order, so slots are handed out in id order. A gram repeated
+    // within one name is indexed once: `seen` remembers the last slot counted per gram, and while
+    // filling, the slot is already at the back of the list.
+    std::vector<std::uint32_t> sizes(gram_count, 0);
+    std::vector<Slot> seen(gram_count, std::numeric_limits<Slot>::max());
+    Slot slot = 0;
+    walk([&](const Profile& profile)
+    {
+        for_each_gram(profile.name(), [&](Gram g)
+        {
+            if (seen[g] == slot) return;
+            seen[g] = slot;
+            ++sizes[g];
+        });
+        slot_ids_.push_back(profile.id());
+        ++slot;
+    });
+    for (std::size_t g = 0; g < gram_count; ++g) by_gram_[g].reserve(sizes[g]);
+
+    slot = 0;
+    walk([&](const Profile& profile)
+    {
+        for_each_gram(profile.name(), [&](Gram g)
+        {
+            Postings& postings = by_gram_[g];
+            if (postings.empty() || postings.back() != slot) postings.push_back(slot);
+        });
+        ++slot;
+    });
+    dead_.assign(slot_ids_.size(), false);
+    sorted_ = slot_ids_.size();
+    suspended_ = false;
+}
+
+NameIndex::Slot NameIndex::live_slot(int id) const
+{
+    const auto recent = recent_.find(id);
+    if (recent != recent_.end()) return recent->second;
+
+    // The sorted part holds every id at most once
+    const auto first = slot_ids_.begin();
+    const auto it = std::lower_bound(first, first + static_cast<std::ptrdiff_t>(sorted_), id);
+    const auto slot = static_cast<Slot>(it - first);
+    if (slot < sorted_ && *it == id && !dead_[slot]) return slot;
+    return static_cast<Slot>(slot_ids_.size());
+}
+
+void NameIndex::add(const Profile& profile)
+{
+    if (suspended_) return;
+    if (by_gram_.empty()) by_gram_.resize(gram_count);
+
+    const int id = profile.id();
+    if (live_slot(id) != slot_ids_.size()) remove(profile); // not expected, but never index an id twice
+
+    // Ids are handed out (and loaded) in increasing order, so the sorted part usually just grows
+    const auto slot = static_cast<Slot>(slot_ids_.size());
+    if (sorted_ == slot && (slot == 0 || slot_ids_.back() < id)) ++sorted_;
+    else recent_.emplace(id, slot);
+    slot_ids_.push_back(id);
+    dead_.push_back(false);
+
+    // A gram repeated within the name finds the slot already at the back of its list
+    for_each_gram(profile.name(), [&](Gram g)
+    {
+        Postings& postings = by_gram_[g];
+        if (postings.empty() || postings.back() != slot) postings.push_back(slot);
+    });
+    if (worth_compacting(recent_.size(), slot_ids_.size())) compact();
+}
+
+void NameIndex::remove(const Profile& profile)
+{
+    if (by_gram_.empty()) return;
+
+    // The slot stays in its lists until the next compaction; searches skip it
+    const Slot slot = live_slot(profile.id());
+    if (slot == slot_ids_.size()) return;
+    dead_[slot] = true;
+    ++dead_count_;
+    recent_.erase(profile.id());
+    if (worth_compacting(dead_count_, slot_ids_.size())) compact();
+}
+
+void NameIndex::compact()
+{
+    // Live slots in id order get the new numbers 0, 1, 2...
+    std::vector<Slot> order;
+    order.reserve(slot_ids_.size() - dead_count_);
+    std::size_t live_sorted = 0;
+    for (Slot slot = 0; slot < slot_ids_.size(); ++slot)
+    {
+        if (dead_[slot]) continue;
+        order.push_back(slot);
+        if (slot < sorted_) ++live_sorted;
+    }
+    // The sorted part is in order already; only the recent slots need placing
+    const auto recent = order.begin() + static_cast<std::ptrdiff_t>(live_sorted);
+    const auto by_id = [this](Slot a, Slot b) { return slot_ids_[a] < slot_ids_[b]; };
+    std::sort(recent, order.end(), by_id);
+    std::inplace_merge(order.begin(), recent, order.end(), by_id);
+
+    const Slot gone = std::numeric_limits<Slot>::max();
+    std::vector<Slot> renumbered(slot_ids_.size(), gone);
+    std::vector<int> ids(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        renumbered[order[i]] = static_cast<Slot>(i);
+        ids[i] = slot_ids_[order[i]];
+    }
+
+    for (Postings& postings : by_gram_)
+    {
+        // Renumbering keeps the sorted part in order; recent slots (at the back) may land anywhere
+        std::size_t kept = 0;
+        bool ordered = true;
+        for (const Slot slot : postings)
+        {
+            const Slot now = renumbered[slot];
+            if (now == gone) continue;
+            if (kept > 0 && postings[kept - 1] > now) ordered = false;
+            postings[kept++] = now;
+        }
+        postings.resize(kept);
+        if (!ordered) std::sort(postings.begin(), postings.end());
+    }
+
+    slot_ids_.swap(ids);
+    dead_.assign(slot_ids_.size(), false);
+    sorted_ = slot_ids_.size();
+    dead_count_ = 0;
+    recent_.clear();
+}
+
+void NameIndex::clear()
+{
+    std::vector<Postings>().swap(by_gram_);
+    std::vector<int>().swap(slot_ids_);
+    std::vector<bool>().swap(dead_);
+    sorted_ = 0;
+    dead_count_ = 0;
+    recent_.clear();
+}
+
+std::vector<NameMatch> NameIndex::search(std::string_view query, std::size_t limit, const NameLookup& name_of) const
+{
+    std::vector<NameMatch> results;
+
+    // Folded query without separators at either end
+    std::string folded;
+    folded.reserve(query.size());
+    for (char ch : query) folded += fold(ch);
+    const std::size_t first = folded.find_first_not_of(' ');
+    if (first == std::string::npos || limit == 0 || by_gram_.empty()) return results;
+    folded = folded.substr(first, folded.find_last_not_of(' ') - first + 1);
+
+    // The query's grams, by what they say about a name containing the query:
+    //   trigrams      the name has all of them
+    //   later_starts  word starts of the 2nd, 3rd... query word: they start words of the name too
+    //   first_starts  word start of the first query word: only if it is a WordPrefix match or better
+    //   first_lead    name start of the first query word: only if it is a Prefix match or better
+    std::vector<Gram> grams;
+    std::vector<Gram> trigrams;
+    std::vector<Gram> first_starts;
+    std::vector<Gram> first_lead;
+    std::vector<Gram> later_starts;
+    const std::size_t space = folded.find(' ');
+    grams_of(folded, grams);
+    for (Gram g : grams)
+    {
+        if (is_trigram(g)) trigrams.push_back(g);
+    }
+    grams_of(std::string_view(folded).substr(0, space), grams);
+    for (Gram g : grams)
+    {
+        if (is_word_start(g)) first_starts.push_back(g);
+        else if (is_name_start(g)) first_lead.push_back(g);
+    }
+    if (space != std::string::npos)
+    {
+        grams_of(std::string_view(folded).substr(space), grams);
+        for (Gram g : grams)
+        {
+            if (is_word_start(g)) later_starts.push_back(g);
+        }
+    }
+
+    // The best `limit` matches so far, in a heap whose top is the worst of them
+    std::vector<Ranked> best;
+    std::vector<Gram> name_grams;
+    const auto full_of_better = [&](NameMatchKind kind)
+    {
+        return best.size() == limit && best.front().match.kind < kind;
+    };
+
+    // Ranks one candidate if its kind is in [lowest, highest]. Each pass below accepts only the kinds
+    // it is responsible for, so a name found by two passes is ranked once.
+    const auto consider = [&](Slot slot, NameMatchKind lowest, NameMatchKind highest, std::size_t needed)
+    {
+        if (dead_[slot]) return; // removed, or renamed since (the new name has a slot of its own)
+        const int id = slot_ids_[slot];
+        const std::string_view name = name_of(id);
+
+        // Earliest occurrence of the query, and whether one starts a word
+        bool found = false;
+        bool word_start = false;
+        std::size_t at = 0;
+        for (std::size_t pos = 0; pos + folded.size() <= name.size() && !word_start; ++pos)
+        {
+            if (!matches_at(name, pos, folded)) continue;
+            if (!found) at = pos;
+            found = true;
+            word_start = pos == 0 || fold(name[pos - 1]) == ' ';
+        }
+
+        Ranked ranked;
+        ranked.match.id = id;
+        ranked.length = name.size();
+        if (found && at == 0 && folded.size() == name.size()) ranked.match.kind = NameMatchKind::Exact;
+        else if (found && at == 0) ranked.match.kind = NameMatchKind::Prefix;
+        else if (word_start) ranked.match.kind = NameMatchKind::WordPrefix;
+        else if (found) ranked.match.kind = NameMatchKind::Substring;
+        else ranked.match.kind = NameMatchKind::Similar;
+        if (ranked.match.kind < lowest || ranked.match.kind > highest) return;
+        if (trigrams.empty() && !word_start) return; // short queries only match word prefixes
+
+        // Cannot beat anything kept so far: skip the similarity work
+        if (full_of_better(ranked.match.kind)) return;
+
+        if (!trigrams.empty())
+        {
+            grams_of(name, name_grams);
+            std::size_t name_trigrams = 0;
+            std::size_t shared = 0;
+            for (Gram g : name_grams)
+            {
+                if (!is_trigram(g)) continue;
+                ++name_trigrams;
+                if (std::binary_search(trigrams.begin(), trigrams.end(), g)) ++shared;
+            }
+            if (!found && shared < needed) return;
+            ranked.match.similarity = static_cast<double>(shared) /
+                                      static_cast<double>(trigrams.size() + name_trigrams - shared);
+        }
+
+        if (best.size() == limit && !better(ranked, best.front())) return;
+        best.push_back(ranked);
+        std::push_heap(best.begin(), best.end(), better);
+        if (best.size() > limit)
+        {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.pop_back();
+        }
+    };
+
+    // Passes 1-3: a name containing the query holds all of `required`. Each pass adds the grams its
+    // kinds imply, so the best kinds come from the shortest intersections, and the later passes are
+    // skipped once `limit` better matches are in hand.
+    std::vector<Gram> required = trigrams;
+    required.insert(required.end(), later_starts.begin(), later_starts.end());
+    if (trigrams.empty()) required.insert(required.end(), first_starts.begin(), first_starts.end());
+
+    struct Pass
+    {
+        const std::vector<Gram>* extra;
+        NameMatchKind lowest;
+        NameMatchKind highest;
+    };
+    const Pass passes[] = {
+        {&first_lead, NameMatchKind::Exact, NameMatchKind::Prefix},
+        {&first_starts, NameMatchKind::WordPrefix, NameMatchKind::WordPrefix},
+        {nullptr, NameMatchKind::Substring, NameMatchKind::Substring},
+    };
+
+    std::vector<const Postings*> lists;
+    std::vector<Postings::const_iterator> cursors;
+    const auto by_size = [](const Postings* a, const Postings* b) { return a->size() < b->size(); };
+    for (const Pass& pass : passes)
+    {
+        if (full_of_better(pass.lowest)) break;
+        if (!pass.extra && trigrams.empty()) break; // short queries: word prefixes only
+
+        lists.clear();
+        for (Gram g : required) lists.push_back(&by_gram_[g]);
+        if (pass.extra)
+        {
+            for (Gram g : *pass.extra) lists.push_back(&by_gram_[g]);
+        }
+        std::sort(lists.begin(), lists.end(), by_size);
+
+        // Intersection: walk the shortest list and look each slot up in the others
+        cursors.clear();
+        for (const Postings* list : lists) cursors.push_back(list->begin());
+        for (const Slot slot : *lists.front())
+        {
+            bool everywhere = true;
+            for (std::size_t l = 1; l < lists.size() && everywhere; ++l)
+            {
+                cursors[l] = seek(cursors[l], lists[l]->end(), slot);
+                everywhere = cursors[l] != lists[l]->end() && *cursors[l] == slot;
+            }
+            if (everywhere) consider(slot, pass.lowest, pass.highest, 0);
+        }
+    }
+
+    // Pass 4, only when that left room: names sharing at least half of the query's trigrams. Such a
+    // name is in at least one of the n - needed + 1 shortest lists; counting its slot in all n lists
+    // first means only names that really share enough trigrams get read.
+    if (!trigrams.empty() && !full_of_better(NameMatchKind::Similar))
+    {
+        const std::size_t needed = (trigrams.size() + 1) / 2;
+        lists.clear();
+        for (Gram g : trigrams) lists.push_back(&by_gram_[g]);
+        std::sort(lists.begin(), lists.end(), by_size);
+        const std::size_t sources = trigrams.size() - needed + 1;
+
+        cursors.clear();
+        for (const Postings* list : lists) cursors.push_back(list->begin());
+        while (true)
+        {
+            // Next slot of the union of the source lists
+            Slot slot = 0;
+            bool any = false;
+            for (std::size_t l = 0; l < sources; ++l)
+            {
+                if (cursors[l] == lists[l]->end()) continue;
+                if (!any || *cursors[l] < slot) slot = *cursors[l];
+                any = true;
+            }
+            if (!any) break;
+
+            std::size_t count = 0;
+            for (std::size_t l = 0; l < lists.size(); ++l)
+            {
+                if (l >= sources) cursors[l] = seek(cursors[l], lists[l]->end(), slot);
+                if (cursors[l] != lists[l]->end() && *cursors[l] == slot)
+                {
+                    ++count;
+                    if (l < sources) ++cursors[l];
+                }
+            }
+            if (count >= needed) consider(slot, NameMatchKind::Similar, NameMatchKind::Similar, needed);
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end(), better);
+    results.reserve(best.size());
+    for (const Ranked& ranked : best) results.push_back(ranked.match);
+    return results;
+}
@@ -0,0 +1,94 @@
+#ifndef PROFILEMANAGERCLI_NAMEINDEX_HPP
+#define PROFILEMANAGERCLI_NAMEINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <string_view>
+#include <vector>
+
+class Profile;
+
+// How a name matched a search, best first
+enum class NameMatchKind
+{
+    Exact,      // the whole name (ignoring case)
+    Prefix,     // the name starts with the query
+    WordPrefix, // a later word of the name starts with the query
+    Substring,  // the query appears somewhere inside the name
+    Similar     // no exact occurrence, but at least half of the query's trigrams (typos, other spellings)
+};
+
+struct NameMatch
+{
+    int id = 0;
+    NameMatchKind kind = NameMatchKind::Similar;
+    double similarity = 0.0; // shared trigrams / all trigrams of query and name (0 for queries under 3 letters)
+};
+
+// Trigram index over profile names for partial and fuzzy name search.
+// Names are split into words (letters, digits and non-ASCII bytes; everything else separates words) and
+// folded to lower case. Every word contributes its trigrams plus two "word start" grams padded in front
+// ("  j", " jo" for "john"), so one and two letter queries still find word prefixes; the first word of a
+// name also gets "name start" grams, which narrow prefix matches down before any name is read.
+// Grams are 3 x 6-bit codes, which makes the index a plain vector of posting lists addressed by gram
+// (no hashing, like ProfileIndex).
+//
+// Posting lists hold slots, not ids: every name added gets the next slot number, so adding only ever
+// appends to the lists of its grams, and removing a name (or the old name before a rename) only marks
+// its slot dead. Word-start grams are shared by a large part of all names, so keeping those lists in
+// id order would shift O(n) ids per edit. Searches skip dead slots; once dead or out-of-order slots
+// make up a quarter of the index, compact() renumbers the live ones in id order (slot order then
+// matches id order again, and lookups by id are a binary search).
+//
+// Like the other ProfileIndex lists it is kept current from the start: ProfileIndex forwards
+// create/insert/remove and set_name to add()/remove(). Bulk loads suspend() it and build() it in one
+// pass at the end (exactly sized lists instead of one growing list per gram), so a search right after
+// a load finds every name. The 2^18 list directory is allocated with the first name; clear() frees it.
+class NameIndex
+{
+private:
+    using Gram = std::uint32_t;
+    using Slot = std::uint32_t;
+    using Postings = std::vector<Slot>; // ascending slots
+
+    std::vector<Postings> by_gram_; // 2^18 lists once a name was added
+    std::vector<int> slot_ids_;     // slot -> id; [0, sorted_) is in ascending id order
+    std::vector<bool> dead_;        // slot -> removed or renamed since
+    std::size_t sorted_ = 0;
+    std::size_t dead_count_ = 0;
+    std::unordered_map<int, Slot> recent_; // live slots at or past sorted_, by id
+    bool suspended_ = false;
+
+    static void grams_of(std::string_view text, std::vector<Gram>& grams); // sorted, distinct
+    Slot live_slot(int id) const; // slot_ids_.size() if the id has none
+    void compact();
+
+public:
+    // Current name of an id the index handed out (the store's profile)
+    using NameLookup = std::function<std::string_view(int id)>;
+    // Calls `visit` for every profile, in ascending id order
+    using ProfileVisitor = std::function<void(const Profile&)>;
+    using ProfileWalk = std::function<void(const ProfileVisitor& visit)>;
+
+    // Drops every list; add()/remove() do nothing until the next build() (clear() does not end this)
+    void suspend();
+    // Indexes every profile `walk` visits: one pass to size each posting list exactly, one to fill it
+    void build(const ProfileWalk& walk);
+
+    void add(const Profile& profile);    // profile entered the store, or its name was just set
+    void remove(const Profile& profile); // profile is about to leave the store, or its name is about to change
+    void clear();
+
+    // Up to `limit` best matches for `query`, best first: by kind, then similarity, then shorter name, then id.
+    // Names containing the query are found by intersecting the posting lists of its grams, best kinds
+    // first (prefixes, then word prefixes, then substrings, stopping once `limit` better ones are found);
+    // only if those are fewer than `limit` are the names sharing at least half of its trigrams looked at.
+    // Either way the lists are walked before any name is read, so the cost follows how many names
+    // could match rather than the size of the store. Queries whose words are all shorter than
+    // 3 letters match word prefixes only.
+    std::vector<NameMatch> search(std::string_view query, std::size_t limit, const NameLookup& name_of) const;
+};
+
+#endif //PROFILEMANAGERCLI_NAMEINDEX_HPP
@@ -0,0 +1,30 @@
+#ifndef PROFILEMANAGERCLI_PROFILEBACKING_HPP
+#define PROFILEMANAGERCLI_PROFILEBACKING_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+#include "../domain/Profile.hpp"
+
+class StringPool;
+
+// Records that stay on disk until somebody asks for them (see ProfileStore::open_lazy).
+// Implemented by the persistence layer (IndexedSnapshot); the store only needs these lookups.
+class ProfileBacking
+{
+    public:
+        virtual ~ProfileBacking() = default;
+
+        virtual std::size_t size() const = 0;       // distinct ids on disk
+        virtual bool contains(int id) const = 0;
+        virtual int max_id() const = 0;             // 0 when empty
+
+        // Parses the record with this id, interning its text into `strings`. Empty if there is none
+        virtual std::optional<Profile> load(int id, StringPool& strings) const = 0;
+
+        // Parses every record in file order (a duplicate id may come up twice; the store keeps the first)
+        virtual void load_all(StringPool& strings, const std::function<void(Profile&)>& on_profile) const = 0;
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEBACKING_HPP
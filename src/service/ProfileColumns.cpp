@@ -0,0 +1,119 @@
+#include "ProfileColumns.hpp"
+#include "../domain/Profile.hpp"
+
+// ProfileColumns: dense per-field arrays kept in step with the store
+
+void ProfileColumns::add(const Profile& profile)
+{
+    rows_[profile.id()] = ids_.size();
+    ids_.push_back(profile.id());
+    ages_.push_back(profile.age());
+    cities_.push_back(profile.city_handle());
+    countries_.push_back(profile.country_handle());
+}
+
+void ProfileColumns::remove(int id)
+{
+    auto it = rows_.find(id);
+    if (it == rows_.end()) return;
+
+    // Fill the hole with the last row so the arrays stay dense
+    const std::size_t row = it->second;
+    const std::size_t last = ids_.size() - 1;
+    if (row != last)
+    {
+        ids_[row] = ids_[last];
+        ages_[row] = ages_[last];
+        cities_[row] = cities_[last];
+        countries_[row] = countries_[last];
+        rows_[ids_[row]] = row;
+    }
+    ids_.pop_back();
+    ages_.pop_back();
+    cities_.pop_back();
+    countries_.pop_back();
+    rows_.erase(it);
+}
+
+void ProfileColumns::clear()
+{
+    ids_.clear();
+    ages_.clear();
+    cities_.clear();
+    countries_.clear();
+    rows_.clear();
+}
+
+void ProfileColumns::reserve(std::size_t count)
+{
+    ids_.reserve(count);
+    ages_.reserve(count);
+    cities_.reserve(count);
+    countries_.reserve(count);
+    rows_.reserve(count);
+}
+
+void ProfileColumns::update(const Profile& profile, ProfileField field)
+{
+    const std::size_t row = row_of(profile.id());
+    if (row == npos) return;
+
+    switch (field)
+    {
+        case ProfileField::Age:     ages_[row] = profile.age(); break;
+        case ProfileField::City:    cities_[row] = profile.city_handle(); break;
+        case ProfileField::Country: countries_[row] = profile.country_handle(); break;
+        default: break; // name and hobbies have no column
+    }
+}
+
+std::size_t ProfileColumns::size() const
+{
+    return ids_.size();
+}
+
+std::size_t ProfileColumns::row_of(int id) const
+{
+    auto it = rows_.find(id);
+    return it == rows_.end() ? npos : it->second;
+}
+
+const int* ProfileColumns::ids() const{return ids_.data();}
+const int* ProfileColumns::ages() const{return ages_.data();}
+const StringPool::Handle* ProfileColumns::cities() const{return cities_.data();}
+const StringPool::Handle* ProfileColumns::countries() const{return countries_.data();}
+
+std::size_t ProfileColumns::count_age_between(int min_age, int max_age) const
+{
+    // Branch-free count over one contiguous array, which the compiler can vectorise
+    std::size_t count = 0;
+    const int* ages = ages_.data();
+    const std::size_t n = ages_.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        count += (ages[i] >= min_age) & (ages[i] <= max_age);
+    }
+    return count;
+}
+
+std::size_t ProfileColumns::count_in_country(StringPool::Handle country, int min_age, int max_age) const
+{
+    std::size_t count = 0;
+    const int* ages = ages_.data();
+    const StringPool::Handle* countries = countries_.data();
+    const std::size_t n = ages_.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        count += (countries[i] == country) & (ages[i] >= min_age) & (ages[i] <= max_age);
+    }
+    return count;
+}
+
+void ProfileColumns::add_country_counts(std::vector<std::size_t>& counts) const
+{
+    for (StringPool::Handle country : countries_)
+    {
+        if (country >= counts.size()) counts.resize(static_cast<std::size_t>(country) + 1, 0);
+        ++counts[country];
+    }
+}
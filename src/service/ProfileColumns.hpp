@@ -0,0 +1,53 @@
+#ifndef PROFILEMANAGERCLI_PROFILECOLUMNS_HPP
+#define PROFILEMANAGERCLI_PROFILECOLUMNS_HPP
+
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "../domain/ProfileObserver.hpp"
+#include "../domain/StringPool.hpp"
+
+class Profile;
+
+// Structure-of-arrays copy of the scan-hot profile fields: one dense array per field,
+// row i of every array belongs to the same profile. City and country are dictionary encoded
+// (StringPool handles), so a scan over age or country walks a few contiguous integer arrays
+// instead of chasing map nodes and heap strings.
+// Rows are unordered; removal moves the last row into the hole. `rows_` maps id -> row for find.
+class ProfileColumns
+{
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+private:
+    std::vector<int> ids_;
+    std::vector<int> ages_;
+    std::vector<StringPool::Handle> cities_;
+    std::vector<StringPool::Handle> countries_;
+    std::unordered_map<int, std::size_t> rows_;
+
+public:
+    void add(const Profile& profile);
+    void remove(int id);
+    void clear();
+    void reserve(std::size_t count);
+    void update(const Profile& profile, ProfileField field); // refresh one column after a mutation
+
+    std::size_t size() const;
+    std::size_t row_of(int id) const; // npos if the id has no row
+
+    // Raw columns (size() entries each)
+    const int* ids() const;
+    const int* ages() const;
+    const StringPool::Handle* cities() const;
+    const StringPool::Handle* countries() const;
+
+    // Scans
+    std::size_t count_age_between(int min_age, int max_age) const;
+    std::size_t count_in_country(StringPool::Handle country, int min_age, int max_age) const;
+    void add_country_counts(std::vector<std::size_t>& counts) const; // counts[handle] += rows in that country
+};
+
+#endif //PROFILEMANAGERCLI_PROFILECOLUMNS_HPP
@@ -0,0 +1,224 @@
+#include "ProfileIndex.hpp"
+#include "../domain/Profile.hpp"
+
+#include <algorithm> // std::stable_sort
+
+// ProfileIndex: posting lists per city/country/age/hobby, maintained incrementally
+
+namespace
+{
+    // A list's change log is merged once it outgrows a quarter of the list (plus a floor for short lists)
+    bool worth_merging(std::size_t pending, std::size_t ids)
+    {
+        return pending > ids / 4 + 32;
+    }
+}
+
+void ProfileIndex::insert_id(Postings& postings, int id)
+{
+    // Ids are handed out in increasing order, so appending is the common case
+    if (postings.pending.empty() && (postings.ids.empty() || postings.ids.back() < id))
+    {
+        postings.ids.push_back(id);
+        return;
+    }
+    log(postings, {id, true});
+}
+
+void ProfileIndex::erase_id(Postings& postings, int id)
+{
+    if (postings.pending.empty() && !postings.ids.empty() && postings.ids.back() == id)
+    {
+        postings.ids.pop_back();
+        return;
+    }
+    log(postings, {id, false});
+}
+
+void ProfileIndex::log(Postings& postings, Edit edit)
+{
+    postings.pending.push_back(edit);
+    if (worth_merging(postings.pending.size(), postings.ids.size())) merge(postings);
+}
+
+void ProfileIndex::merge(Postings& postings)
+{
+    std::vector<Edit>& pending = postings.pending;
+    if (pending.empty()) return;
+
+    // By id, oldest first within an id: the last change of an id decides whether it is in the list
+    std::stable_sort(pending.begin(), pending.end(), [](const Edit& a, const Edit& b) { return a.id < b.id; });
+
+    std::vector<int> merged;
+    merged.reserve(postings.ids.size() + pending.size());
+    auto id = postings.ids.cbegin();
+    const auto end = postings.ids.cend();
+    for (std::size_t e = 0; e < pending.size(); ++e)
+    {
+        if (e + 1 < pending.size() && pending[e + 1].id == pending[e].id) continue; // superseded
+        const Edit& edit = pending[e];
+        while (id != end && *id < edit.id) merged.push_back(*id++);
+        if (id != end && *id == edit.id) ++id; // re-added below if it stays
+        if (edit.added) merged.push_back(edit.id);
+    }
+    merged.insert(merged.end(), id, end);
+
+    postings.ids.swap(merged);
+    pending.clear();
+}
+
+// Posting list for a handle, growing the index when the pool has handed out new handles
+ProfileIndex::Postings& ProfileIndex::slot(std::vector<Postings>& index, StringPool::Handle handle)
+{
+    if (handle >= index.size()) index.resize(static_cast<std::size_t>(handle) + 1);
+    return index[handle];
+}
+
+void ProfileIndex::erase_age(int age, int id)
+{
+    auto it = by_age_.find(age);
+    if (it == by_age_.end()) return;
+    erase_id(it->second, id);
+    if (it->second.ids.empty() && it->second.pending.empty()) by_age_.erase(it); // keeps range queries short
+}
+
+void ProfileIndex::add(const Profile& profile)
+{
+    const int id = profile.id();
+    insert_id(slot(by_city_, profile.city_handle()), id);
+    insert_id(slot(by_country_, profile.country_handle()), id);
+    insert_id(by_age_[profile.age()], id);
+
+    const HobbyView hobbies = profile.hobbies();
+    for (std::size_t i = 0; i < hobbies.size(); ++i)
+    {
+        insert_id(slot(by_hobby_, hobbies.handles()[i]), id); // duplicates of the same hobby are indexed once
+    }
+    names_.add(profile);
+}
+
+void ProfileIndex::remove(const Profile& profile)
+{
+    const int id = profile.id();
+    erase_id(slot(by_city_, profile.city_handle()), id);
+    erase_id(slot(by_country_, profile.country_handle()), id);
+    erase_age(profile.age(), id);
+
+    const HobbyView hobbies = profile.hobbies();
+    for (std::size_t i = 0; i < hobbies.size(); ++i)
+    {
+        erase_id(slot(by_hobby_, hobbies.handles()[i]), id);
+    }
+    names_.remove(profile);
+}
+
+void ProfileIndex::clear()
+{
+    by_city_.clear();
+    by_country_.clear();
+    by_hobby_.clear();
+    by_age_.clear();
+    names_.clear();
+}
+
+void ProfileIndex::before_change(const Profile& profile, ProfileField field)
+{
+    const int id = profile.id();
+    switch (field)
+    {
+        case ProfileField::City:    erase_id(slot(by_city_, profile.city_handle()), id); break;
+        case ProfileField::Country: erase_id(slot(by_country_, profile.country_handle()), id); break;
+        case ProfileField::Age:     erase_age(profile.age(), id); break;
+        case ProfileField::Name:    names_.remove(profile); break;
+        default: break; // hobbies are handled after the change
+    }
+}
+
+void ProfileIndex::after_change(const Profile& profile, ProfileField field, const std::string& hobby)
+{
+    const int id = profile.id();
+    switch (field)
+    {
+        case ProfileField::City:    insert_id(slot(by_city_, profile.city_handle()), id); break;
+        case ProfileField::Country: insert_id(slot(by_country_, profile.country_handle()), id); break;
+        case ProfileField::Age:     insert_id(by_age_[profile.age()], id); break;
+        case ProfileField::HobbyAdded:
+            insert_id(slot(by_hobby_, profile.strings().find(hobby)), id);
+            break;
+        case ProfileField::HobbyRemoved:
+        {
+            // Only unindex if that was the last copy of the hobby on this profile
+            const StringPool::Handle handle = profile.strings().find(hobby);
+            if (!profile.has_hobby(handle)) erase_id(slot(by_hobby_, handle), id);
+            break;
+        }
+        case ProfileField::Name: names_.add(profile); break;
+    }
+}
+
+IdRange ProfileIndex::range_of(Postings& postings)
+{
+    merge(postings);
+    return IdRange(postings.ids.data(), postings.ids.data() + postings.ids.size());
+}
+
+IdRange ProfileIndex::range_of(std::vector<Postings>& index, StringPool::Handle handle)
+{
+    if (handle >= index.size()) return IdRange(); // also covers StringPool::npos
+    return range_of(index[handle]);
+}
+
+IdRange ProfileIndex::ids_in_city(StringPool::Handle city) const
+{
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    return range_of(by_city_, city);
+}
+
+IdRange ProfileIndex::ids_in_country(StringPool::Handle country) const
+{
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    return range_of(by_country_, country);
+}
+
+IdRange ProfileIndex::ids_with_hobby(StringPool::Handle hobby) const
+{
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    return range_of(by_hobby_, hobby);
+}
+
+std::vector<IdRange> ProfileIndex::ids_by_age(int min_age, int max_age) const
+{
+    std::vector<IdRange> ranges;
+    if (min_age > max_age) return ranges;
+
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    for (auto it = by_age_.lower_bound(min_age); it != by_age_.end() && it->first <= max_age; ++it)
+    {
+        const IdRange range = range_of(it->second);
+        if (!range.empty()) ranges.push_back(range); // emptied by changes that were still pending
+    }
+    return ranges;
+}
+
+std::size_t ProfileIndex::count_by_age(int min_age, int max_age) const
+{
+    std::size_t count = 0;
+    if (min_age > max_age) return count;
+
+    std::lock_guard<std::mutex> lock(merge_mutex_);
+    for (auto it = by_age_.lower_bound(min_age); it != by_age_.end() && it->first <= max_age; ++it)
+    {
+        count += range_of(it->second).size();
+    }
+    return count;
+}
+
+NameIndex& ProfileIndex::names()
+{
+    return names_;
+}
+
+const NameIndex& ProfileIndex::names() const
+{
+    return names_;
+}
@@ -0,0 +1,102 @@
+#ifndef PROFILEMANAGERCLI_PROFILEINDEX_HPP
+#define PROFILEMANAGERCLI_PROFILEINDEX_HPP
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../domain/ProfileObserver.hpp"
+#include "../domain/StringPool.hpp"
+#include "NameIndex.hpp"
+
+class Profile;
+
+// Read-only view of an ascending run of ids inside an index.
+// Valid until the store is modified again (like an iterator into a std::vector).
+class IdRange
+{
+private:
+    const int* first_ = nullptr;
+    const int* last_ = nullptr;
+
+public:
+    IdRange() = default;
+    IdRange(const int* first, const int* last) : first_(first), last_(last) {}
+
+    const int* begin() const { return first_; }
+    const int* end() const { return last_; }
+    std::size_t size() const { return static_cast<std::size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+};
+
+// Secondary indexes over the profiles of one ProfileStore:
+// indexes for city and country, an ordered index for age, an inverted index hobby -> ids
+// and a trigram index over names (NameIndex.hpp).
+// City, country and hobby values are interned, so those indexes are plain vectors addressed by
+// StringPool handle (no hashing). Queries hand out ranges of ascending ids instead of scanning the store.
+// The store keeps it current from create/insert/remove/clear and from every Profile mutator.
+//
+// Ids that arrive in increasing order (loads, create_profile) are appended to their lists. Any other
+// change (an edit moving a profile between cities or ages, a removal) is logged on the list instead of
+// shifting the ids behind it, and merged in by the next query that reads the list, or by the change that
+// grows the log past a quarter of the list. An edit therefore costs an append plus, amortised, a few id
+// moves, whatever the size of the store.
+class ProfileIndex
+{
+private:
+    struct Edit
+    {
+        int id;
+        bool added; // false = removed
+    };
+
+    struct Postings
+    {
+        std::vector<int> ids;      // ascending; what queries hand out
+        std::vector<Edit> pending; // changes not merged into ids yet, oldest first
+    };
+
+    // Queries merge pending changes into the lists they read (the ids in the index stay the same), so
+    // the lists are mutable, and merge_mutex_ keeps concurrent const queries from merging at once
+    mutable std::vector<Postings> by_city_;    // indexed by city handle
+    mutable std::vector<Postings> by_country_; // indexed by country handle
+    mutable std::vector<Postings> by_hobby_;   // indexed by hobby handle
+    mutable std::map<int, Postings> by_age_;
+    mutable std::mutex merge_mutex_;
+    NameIndex names_;
+
+    static void insert_id(Postings& postings, int id);
+    static void erase_id(Postings& postings, int id);
+    static void log(Postings& postings, Edit edit);
+    static void merge(Postings& postings); // applies the pending changes
+    static Postings& slot(std::vector<Postings>& index, StringPool::Handle handle);
+    static IdRange range_of(std::vector<Postings>& index, StringPool::Handle handle); // merged first
+    static IdRange range_of(Postings& postings);                                      // merged first
+    void erase_age(int age, int id);
+
+public:
+    void add(const Profile& profile);    // profile entered the store
+    void remove(const Profile& profile); // profile is about to leave the store
+    void clear();
+
+    // Mirror of ProfileObserver: drop the old value before a change, index the new one after it
+    void before_change(const Profile& profile, ProfileField field);
+    void after_change(const Profile& profile, ProfileField field, const std::string& hobby);
+
+    // Lookups by interned handle (StringPool::npos gives an empty range)
+    IdRange ids_in_city(StringPool::Handle city) const;
+    IdRange ids_in_country(StringPool::Handle country) const;
+    IdRange ids_with_hobby(StringPool::Handle hobby) const;
+
+    // One ascending id range per distinct age in [min_age, max_age], youngest first
+    std::vector<IdRange> ids_by_age(int min_age, int max_age) const;
+    std::size_t count_by_age(int min_age, int max_age) const;
+
+    // Name search index (see NameIndex.hpp)
+    NameIndex& names();
+    const NameIndex& names() const;
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEINDEX_HPP
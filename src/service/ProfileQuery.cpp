@@ -0,0 +1,215 @@
+#include "ProfileQuery.hpp"
+#include "ProfileStore.hpp"
+#include "../util/ThreadPool.hpp"
+
+#include <algorithm> // std::sort, std::is_sorted
+#include <future>
+
+// ProfileQueryEngine: predicate matching + chunked parallel scans
+
+namespace
+{
+    // Below this many profiles the pool start-up costs more than the scan it would split
+    constexpr std::size_t min_parallel_profiles = 50000;
+
+    // The query with its strings resolved to pool handles once, so matching is integer compares
+    struct Matcher
+    {
+        bool impossible = false; // a requested city/country/hobby was never interned: nothing matches
+        int min_age = 0;
+        int max_age = 0;
+        StringPool::Handle city = StringPool::npos;    // npos = any
+        StringPool::Handle country = StringPool::npos;
+        StringPool::Handle hobby = StringPool::npos;
+        std::string_view name_prefix;
+
+        bool matches(const Profile& p) const
+        {
+            if (p.age() < min_age || p.age() > max_age) return false;
+            if (city != StringPool::npos && p.city_handle() != city) return false;
+            if (country != StringPool::npos && p.country_handle() != country) return false;
+            if (!name_prefix.empty() && p.name().substr(0, name_prefix.size()) != name_prefix) return false;
+            if (hobby != StringPool::npos && !p.has_hobby(hobby)) return false;
+            return true;
+        }
+    };
+
+    Matcher compile(const ProfileQuery& query, const StringPool& strings)
+    {
+        Matcher m;
+        m.min_age = query.min_age;
+        m.max_age = query.max_age;
+        m.name_prefix = query.name_prefix;
+        m.impossible = query.min_age > query.max_age;
+
+        auto resolve = [&](const std::string& text, StringPool::Handle& handle)
+        {
+            if (text.empty()) return;
+            handle = strings.find(text);
+            if (handle == StringPool::npos) m.impossible = true;
+        };
+        resolve(query.city, m.city);
+        resolve(query.country, m.country);
+        resolve(query.hobby, m.hobby);
+        return m;
+    }
+
+    // Splits the store's partitions into ranges and runs scan(task, first, last) for each,
+    // in parallel when the store is big enough. Returns the number of tasks (results are indexed by task).
+    template <typename Scan>
+    std::size_t run_chunked(const ProfileStore& store, unsigned thread_count, Scan&& scan)
+    {
+        const std::size_t partitions = store.partition_count();
+        const unsigned threads = ThreadPool::resolve_thread_count(thread_count);
+        if (threads == 1 || store.size() < min_parallel_profiles || partitions < 2)
+        {
+            scan(0, 0, partitions);
+            return 1;
+        }
+
+        // A few tasks per thread evens out partitions that are fuller than others
+        const std::size_t tasks = std::min<std::size_t>(partitions, threads * 4);
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> pending;
+        pending.reserve(tasks);
+        for (std::size_t t = 0; t < tasks; ++t)
+        {
+            const std::size_t first = partitions * t / tasks;
+            const std::size_t last = partitions * (t + 1) / tasks;
+            pending.push_back(pool.submit([&scan, t, first, last]() { scan(t, first, last); }));
+        }
+        for (auto& f : pending) f.get();
+        return tasks;
+    }
+
+    std::size_t max_tasks(unsigned thread_count)
+    {
+        return static_cast<std::size_t>(ThreadPool::resolve_thread_count(thread_count)) * 4;
+    }
+
+    QueryRow project(const Profile& p, unsigned fields)
+    {
+        QueryRow row;
+        if (fields & query_fields::id) row.id = p.id();
+        if (fields & query_fields::name) row.name = p.name_string();
+        if (fields & query_fields::age) row.age = p.age();
+        if (fields & query_fields::city) row.city = p.city();
+        if (fields & query_fields::country) row.country = p.country();
+        if (fields & query_fields::hobbies)
+        {
+            const HobbyView hobbies = p.hobbies();
+            row.hobbies.assign(hobbies.begin(), hobbies.end());
+        }
+        return row;
+    }
+}
+
+std::vector<int> ProfileQueryEngine::ids(const ProfileStore& store, const ProfileQuery& query, unsigned thread_count)
+{
+    // A lazy store reads its records first, so the filter strings below resolve against all of them
+    store.materialize();
+    const Matcher m = compile(query, store.strings());
+    if (m.impossible) return {};
+
+    std::vector<std::vector<int>> parts(max_tasks(thread_count));
+    const std::size_t tasks = run_chunked(store, thread_count, [&](std::size_t t, std::size_t first, std::size_t last)
+    {
+        store.for_each_in_partitions(first, last, [&](const Profile& p) { if (m.matches(p)) parts[t].push_back(p.id()); });
+    });
+
+    std::vector<int> result;
+    for (std::size_t t = 0; t < tasks; ++t) result.insert(result.end(), parts[t].begin(), parts[t].end());
+    // Partitions are in id order except that negative ids come last
+    if (!std::is_sorted(result.begin(), result.end())) std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<QueryRow> ProfileQueryEngine::rows(const ProfileStore& store, const ProfileQuery& query, unsigned fields,
+                                               unsigned thread_count)
+{
+    store.materialize();
+    const Matcher m = compile(query, store.strings());
+    if (m.impossible) return {};
+
+    // Projection runs in the workers too: copying strings out is most of the work for wide rows
+    std::vector<std::vector<QueryRow>> parts(max_tasks(thread_count));
+    const std::size_t tasks = run_chunked(store, thread_count, [&](std::size_t t, std::size_t first, std::size_t last)
+    {
+        store.for_each_in_partitions(first, last, [&](const Profile& p)
+        {
+            if (m.matches(p)) parts[t].push_back(project(p, fields | query_fields::id));
+        });
+    });
+
+    std::vector<QueryRow> result;
+    std::size_t total = 0;
+    for (std::size_t t = 0; t < tasks; ++t) total += parts[t].size();
+    result.reserve(total);
+    for (std::size_t t = 0; t < tasks; ++t)
+    {
+        for (QueryRow& row : parts[t]) result.push_back(std::move(row));
+    }
+    if (!std::is_sorted(result.begin(), result.end(), [](const QueryRow& a, const QueryRow& b) { return a.id < b.id; }))
+    {
+        std::sort(result.begin(), result.end(), [](const QueryRow& a, const QueryRow& b) { return a.id < b.id; });
+    }
+    if (!(fields & query_fields::id))
+    {
+        for (QueryRow& row : result) row.id = 0; // only used for ordering
+    }
+    return result;
+}
+
+std::size_t ProfileQueryEngine::count(const ProfileStore& store, const ProfileQuery& query, unsigned thread_count)
+{
+    store.materialize();
+    const Matcher m = compile(query, store.strings());
+    if (m.impossible) return 0;
+
+    std::vector<std::size_t> parts(max_tasks(thread_count), 0);
+    run_chunked(store, thread_count, [&](std::size_t t, std::size_t first, std::size_t last)
+    {
+        std::size_t n = 0; // local counter: no shared cache line between workers
+        store.for_each_in_partitions(first, last, [&](const Profile& p) { n += m.matches(p); });
+        parts[t] = n;
+    });
+
+    std::size_t total = 0;
+    for (std::size_t n : parts) total += n;
+    return total;
+}
+
+std::vector<CountryCount> ProfileQueryEngine::count_by_country(const ProfileStore& store, const ProfileQuery& query,
+                                                               unsigned thread_count)
+{
+    store.materialize();
+    const Matcher m = compile(query, store.strings());
+    if (m.impossible) return {};
+
+    // One histogram per task, indexed by country handle, summed afterwards
+    const std::size_t handles = store.strings().size();
+    std::vector<std::vector<std::size_t>> parts(max_tasks(thread_count));
+    const std::size_t tasks = run_chunked(store, thread_count, [&](std::size_t t, std::size_t first, std::size_t last)
+    {
+        std::vector<std::size_t>& counts = parts[t];
+        counts.assign(handles, 0);
+        store.for_each_in_partitions(first, last, [&](const Profile& p) { if (m.matches(p)) ++counts[p.country_handle()]; });
+    });
+
+    std::vector<std::size_t> totals(handles, 0);
+    for (std::size_t t = 0; t < tasks; ++t)
+    {
+        for (std::size_t h = 0; h < handles; ++h) totals[h] += parts[t][h];
+    }
+
+    std::vector<CountryCount> result;
+    for (std::size_t h = 0; h < handles; ++h)
+    {
+        if (totals[h]) result.push_back({store.strings().str(static_cast<StringPool::Handle>(h)), totals[h]});
+    }
+    std::sort(result.begin(), result.end(), [](const CountryCount& a, const CountryCount& b)
+    {
+        return a.profiles != b.profiles ? a.profiles > b.profiles : a.country < b.country;
+    });
+    return result;
+}
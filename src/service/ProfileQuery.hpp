@@ -0,0 +1,70 @@
+#ifndef PROFILEMANAGERCLI_PROFILEQUERY_HPP
+#define PROFILEMANAGERCLI_PROFILEQUERY_HPP
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+class ProfileStore;
+
+// Filter for ProfileStore::query*(). Every predicate that is set must match (AND);
+// empty strings and the default age bounds mean "any".
+struct ProfileQuery
+{
+    int min_age = std::numeric_limits<int>::min(); // inclusive
+    int max_age = std::numeric_limits<int>::max(); // inclusive
+    std::string city;        // exact match
+    std::string country;     // exact match
+    std::string name_prefix; // case-sensitive
+    std::string hobby;       // profile lists this hobby
+};
+
+// Projection: which QueryRow fields a query fills in (OR them together)
+namespace query_fields
+{
+    constexpr unsigned id = 1u << 0;
+    constexpr unsigned name = 1u << 1;
+    constexpr unsigned age = 1u << 2;
+    constexpr unsigned city = 1u << 3;
+    constexpr unsigned country = 1u << 4;
+    constexpr unsigned hobbies = 1u << 5;
+    constexpr unsigned all = id | name | age | city | country | hobbies;
+}
+
+// One matching profile, copied out so it stays valid after the store changes.
+// Fields outside the projection are left empty / zero.
+struct QueryRow
+{
+    int id = 0;
+    std::string name;
+    int age = 0;
+    std::string city;
+    std::string country;
+    std::vector<std::string> hobbies;
+};
+
+struct CountryCount
+{
+    std::string country;
+    std::size_t profiles = 0;
+};
+
+// Runs ProfileQuery filters over a store. The store is split into page ranges that are scanned
+// on a ThreadPool (one task per range, a few per thread), and the per-task results are merged in
+// range order, so rows come back in ascending id order just like a sequential scan.
+// Small stores are scanned on the calling thread. The store must not change during a query.
+class ProfileQueryEngine
+{
+public:
+    // thread_count == 0 means "one per hardware thread"
+    static std::vector<int> ids(const ProfileStore& store, const ProfileQuery& query, unsigned thread_count = 0);
+    static std::vector<QueryRow> rows(const ProfileStore& store, const ProfileQuery& query, unsigned fields,
+                                      unsigned thread_count = 0);
+    static std::size_t count(const ProfileStore& store, const ProfileQuery& query, unsigned thread_count = 0);
+    // Matching profiles per country, most profiles first (ties by name); countries without matches are left out
+    static std::vector<CountryCount> count_by_country(const ProfileStore& store, const ProfileQuery& query,
+                                                      unsigned thread_count = 0);
+};
+
+#endif //PROFILEMANAGERCLI_PROFILEQUERY_HPP
@@ -1,5 +1,6 @@
 #include "ProfileStore.hpp"
-#include <algorithm> // std::sort
+#include <algorithm> // std::remove
+#include <optional>
 
 
 // ProfileStore: holds all profiles in memory, CRUD operations, id generation
@@ -10,66 +11,121 @@ int ProfileStore::create_profile(const std::string& name,
                                  const std::string& country)
 {
     const int id = next_id_++;
-    // Construct Profile in-place in the map.
-    profiles_.emplace(id, Profile(id, name, age, city, country));
+    // Construct Profile in its table slot.
+    Profile* stored = profiles_.emplace(Profile(id, name, age, city, country, strings_)).first;
+    added(*stored);
     return id;
 }
 
 // Finds a profile by ID and returns a pointer that allows modification & returns nullptr if the profile doesn't exist
 Profile* ProfileStore::find(int id)
 {
-    auto it = profiles_.find(id);
-    if (it == profiles_.end()) return nullptr;
-    return &it->second; // returning the pointer to the stored profile object
+    return const_cast<Profile*>(static_cast<const ProfileStore&>(*this).find(id));
 }
 
 //Const overload of find() & Allows read-only access when ProfileStore itself is const
 const Profile* ProfileStore::find(int id) const
 {
-    auto it = profiles_.find(id);
-    if (it == profiles_.end()) return nullptr;
-    return &it->second;
+    // pointer to the stored profile object, nullptr if absent
+    if (!lazy_.load(std::memory_order_acquire)) return profiles_.find(id);
+
+    // Lazy mode: the record may still be on disk, and another reader may be filling the cache right now
+    std::lock_guard<std::mutex> lock(lazy_mutex_);
+    const Profile* profile = profiles_.find(id);
+    if (profile || !backing_) return profile;
+    // Reading a record from disk only fills the cache, see materialize()
+    return const_cast<ProfileStore*>(this)->fault_in(id);
 }
 
 // Removes a profile by ID & Returns true if a profile was removed, false if ID was found.
 bool ProfileStore::remove(int id)
 {
-    return profiles_.erase(id) > 0; // erase() returns the number of elements removed (0 or 1 in this scenario)
+    Profile* profile = find(id); // a lazy record is read first so listeners still see the full profile
+    if (!profile) return false;
+
+    for (ProfileStoreListener* listener : listeners_) listener->profile_removed(*profile);
+    changes_.removed(id);
+    if (indexing_) index_.remove(*profile);
+    if (layout_ == StorageLayout::Columnar) columns_.remove(id);
+    ordered_.erase(id);
+    profiles_.erase(id);
+    return true;
 }
 
 //Returns a sorted list of all profile ID's currently stored
 std::vector<int> ProfileStore::list_ids() const
 {
+    materialize();
     std::vector<int> ids;
     ids.reserve(profiles_.size()); // reserve memory upfront to avoid reallocations
 
-    for (const auto& kv : profiles_) { // Extract all ID's (keys) from unordered_map
-        ids.push_back(kv.first);
-    }
-    // Sort ID's so output order is consistent
-    std::sort(ids.begin(), ids.end());
+    // The ordered index is already sorted, so this is a straight copy
+    for (auto it = ordered_.begin(); it != ordered_.end(); ++it) ids.push_back(it.id());
     return ids;
 }
 
+const SortedIdIndex& ProfileStore::ordered() const
+{
+    materialize();
+    return ordered_;
+}
+
+int ProfileStore::id_before(int id, std::size_t steps) const
+{
+    materialize();
+    if (ordered_.empty()) return id;
+
+    auto it = ordered_.lower_bound(id);
+    for (; steps > 0 && it != ordered_.begin(); --steps) --it;
+    if (it == ordered_.end()) --it; // empty page past the end: step back onto the last profile
+    return it.id();
+}
+
 // Returns the number of profiles currently stored
 std::size_t ProfileStore::size() const
 {
-    return profiles_.size(); // cheap O(1) query
+    // cheap O(1) query; in lazy mode every id on disk that was not read (or removed) yet counts too
+    if (!lazy_.load(std::memory_order_acquire)) return profiles_.size();
+
+    std::lock_guard<std::mutex> lock(lazy_mutex_);
+    const std::size_t pending = backing_ ? backing_->size() - taken_.size() : 0;
+    return profiles_.size() + pending;
 }
 
 void ProfileStore::clear()
 {
-    profiles_.clear();
+    if (allocation_ == AllocationMode::Arena)
+    {
+        // Every table page, name and hobby buffer of profiles_ lives in arena_, and none of them owns
+        // anything else, so the profiles are abandoned without running a destructor per profile and
+        // the memory goes back in one reset.
+        profiles_.abandon();
+        arena_.reset();
+    } else
+    {
+        profiles_.clear();
+    }
+    ordered_.clear();
+    index_.clear();
+    columns_.clear();
+    strings_.clear(); // nothing refers to the old handles any more
+    backing_.reset();
+    taken_.clear();
+    lazy_.store(false, std::memory_order_release);
+    changes_.drop_baseline();
     next_id_ = 1;
+    for (ProfileStoreListener* listener : listeners_) listener->store_cleared();
 }
 
 bool ProfileStore::insert_profile(const Profile& profile)
 {
-    const int id = profile.id();
+    return insert_profile(Profile(profile));
+}
 
-    // If the id already exists, reject to avoid collisions.
-    auto [it, inserted] = profiles_.emplace(id, profile);
-    if (!inserted) return false;
+bool ProfileStore::insert_profile(Profile&& profile)
+{
+    const int id = profile.id();
+    if (!store_profile(std::move(profile))) return false;
 
     // Ensure next_id_ will never reuse an existing id.
     if (id >= next_id_) {
@@ -77,3 +133,368 @@ bool ProfileStore::insert_profile(const Profile& profile)
     }
     return true;
 }
+
+bool ProfileStore::store_profile(Profile&& profile)
+{
+    // A record still on disk holds this id, so it counts as already stored
+    if (backing_ && backing_->contains(profile.id()) && taken_.count(profile.id()) == 0) return false;
+
+    // If the id already exists, reject to avoid collisions (the profile is left untouched then).
+    auto [stored, inserted] = profiles_.emplace(std::move(profile));
+    if (!inserted) return false;
+
+    stored->rebind(strings_); // no-op when it was built against our pool already
+    added(*stored);
+    return true;
+}
+
+void ProfileStore::reserve(std::size_t profiles)
+{
+    profiles_.reserve(profiles);
+    ordered_.reserve(profiles);
+    if (layout_ == StorageLayout::Columnar) columns_.reserve(profiles);
+}
+
+std::size_t ProfileStore::insert_batch(std::vector<Profile>& batch)
+{
+    std::size_t stored = 0;
+    int max_id = next_id_ - 1;
+    for (Profile& profile : batch)
+    {
+        const int id = profile.id();
+        if (!store_profile(std::move(profile))) continue;
+        ++stored;
+        if (id > max_id) max_id = id;
+    }
+    batch.clear();
+
+    // One counter update for the whole batch
+    if (max_id >= next_id_) next_id_ = max_id + 1;
+    return stored;
+}
+
+const ChangeSet& ProfileStore::changes() const
+{
+    return changes_;
+}
+
+void ProfileStore::mark_clean(const std::string& source)
+{
+    changes_.mark_clean(source);
+}
+
+StringPool& ProfileStore::strings()
+{
+    return strings_;
+}
+
+const StringPool& ProfileStore::strings() const
+{
+    materialize(); // find() on the pool must not race a record being interned
+    return strings_;
+}
+
+void ProfileStore::add_listener(ProfileStoreListener* listener)
+{
+    // Records still on disk would later appear without the listener hearing about them, so a
+    // listener (e.g. a write-ahead log describing the store) always starts from a fully read store
+    materialize();
+    listeners_.push_back(listener);
+}
+
+void ProfileStore::remove_listener(ProfileStoreListener* listener)
+{
+    listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener), listeners_.end());
+}
+
+void ProfileStore::open_lazy(std::unique_ptr<ProfileBacking> backing)
+{
+    clear();
+    backing_ = std::move(backing);
+    next_id_ = backing_->max_id() + 1;
+    if (next_id_ < 1) next_id_ = 1;
+    lazy_.store(true, std::memory_order_release);
+
+    // Listeners hear about every record of a load(); records read lazily would skip them, so with
+    // listeners attached everything is read now and announced like a normal load
+    if (!listeners_.empty())
+    {
+        materialize();
+        for (const Profile& profile : ordered_)
+        {
+            for (ProfileStoreListener* listener : listeners_) listener->profile_added(profile);
+        }
+    }
+}
+
+bool ProfileStore::lazy() const
+{
+    return lazy_.load(std::memory_order_acquire);
+}
+
+Profile* ProfileStore::fault_in(int id)
+{
+    if (taken_.count(id) != 0) return nullptr; // read before and removed since
+
+    std::optional<Profile> loaded = backing_->load(id, strings_);
+    if (!loaded) return nullptr;
+    taken_.insert(id);
+
+    Profile* stored = profiles_.emplace(std::move(*loaded)).first;
+    wire(*stored);
+    return stored;
+}
+
+void ProfileStore::materialize() const
+{
+    if (!lazy_.load(std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lock(lazy_mutex_);
+    if (!backing_) return; // another reader got here first
+
+    // Only the cache of on-disk records changes here (see find() const)
+    ProfileStore& self = const_cast<ProfileStore&>(*this);
+    const std::unique_ptr<ProfileBacking> backing = std::move(self.backing_);
+    self.reserve(profiles_.size() + backing->size() - taken_.size());
+
+    BulkLoad bulk(self);
+    backing->load_all(self.strings_, [&self](Profile& profile)
+    {
+        // Records read (or removed) before were handled already; a duplicate id keeps its first record
+        if (self.taken_.count(profile.id()) != 0) return;
+        auto [stored, inserted] = self.profiles_.emplace(std::move(profile));
+        if (inserted) self.wire(*stored);
+    });
+    self.taken_.clear();
+    lazy_.store(false, std::memory_order_release);
+}
+
+void ProfileStore::added(Profile& profile)
+{
+    wire(profile);
+    changes_.modified(profile.id());
+    for (ProfileStoreListener* listener : listeners_) listener->profile_added(profile);
+}
+
+void ProfileStore::wire(Profile& profile)
+{
+    profile.set_observer(this);
+    profile.set_arena(allocation_ == AllocationMode::Arena ? &arena_ : nullptr); // no-op when already there
+    profile.set_unique_hobbies(unique_hobbies_);
+    ordered_.insert(profile.id(), &profile);
+    if (indexing_) index_.add(profile);
+    if (layout_ == StorageLayout::Columnar) columns_.add(profile);
+}
+
+void ProfileStore::profile_changing(const Profile& profile, ProfileField field)
+{
+    if (indexing_) index_.before_change(profile, field);
+}
+
+void ProfileStore::profile_changed(const Profile& profile, ProfileField field, const std::string& hobby)
+{
+    if (indexing_) index_.after_change(profile, field, hobby);
+    if (layout_ == StorageLayout::Columnar) columns_.update(profile, field);
+    changes_.modified(profile.id());
+    for (ProfileStoreListener* listener : listeners_) listener->profile_changed(profile, field, hobby);
+}
+
+void ProfileStore::set_indexing(bool enabled)
+{
+    if (enabled == indexing_) return;
+    materialize();
+    indexing_ = enabled;
+    index_.clear();
+
+    // Rebuild in id order so every posting list is filled by appends
+    if (enabled) for_each_ordered([this](const Profile& p) { index_.add(p); });
+}
+
+bool ProfileStore::indexing() const
+{
+    return indexing_;
+}
+
+IdRange ProfileStore::ids_in_city(const std::string& city) const
+{
+    materialize();
+    return index_.ids_in_city(strings_.find(city));
+}
+
+IdRange ProfileStore::ids_in_country(const std::string& country) const
+{
+    materialize();
+    return index_.ids_in_country(strings_.find(country));
+}
+
+IdRange ProfileStore::ids_with_hobby(const std::string& hobby) const
+{
+    materialize();
+    return index_.ids_with_hobby(strings_.find(hobby));
+}
+
+std::vector<IdRange> ProfileStore::ids_by_age(int min_age, int max_age) const
+{
+    materialize();
+    return index_.ids_by_age(min_age, max_age);
+}
+
+std::size_t ProfileStore::count_by_age(int min_age, int max_age) const
+{
+    materialize();
+    return index_.count_by_age(min_age, max_age);
+}
+
+ProfileStore::BulkLoad::BulkLoad(ProfileStore& store) : store_(store)
+{
+    if (store_.bulk_loads_++ == 0 && store_.indexing_) store_.index_.names().suspend();
+}
+
+ProfileStore::BulkLoad::~BulkLoad()
+{
+    if (--store_.bulk_loads_ != 0 || !store_.indexing_) return;
+    // ordered_ directly: this also runs inside materialize(), where for_each_ordered() would re-enter it
+    store_.index_.names().build([this](const NameIndex::ProfileVisitor& visit)
+    {
+        for (const Profile& p : store_.ordered_) visit(p);
+    });
+}
+
+std::vector<NameMatch> ProfileStore::search_names(const std::string& query, std::size_t limit) const
+{
+    materialize();
+    if (!indexing_) return {};
+    return index_.names().search(query, limit, [this](int id) { return profiles_.find(id)->name(); });
+}
+
+void ProfileStore::set_unique_hobbies(bool unique)
+{
+    unique_hobbies_ = unique;
+    profiles_.for_each([unique](Profile& p) { p.set_unique_hobbies(unique); });
+}
+
+bool ProfileStore::unique_hobbies() const
+{
+    return unique_hobbies_;
+}
+
+void ProfileStore::set_allocation_mode(AllocationMode mode)
+{
+    if (mode == allocation_) return;
+    materialize(); // the move below walks the table
+    allocation_ = mode;
+    Arena* arena = (mode == AllocationMode::Arena) ? &arena_ : nullptr;
+
+    // Move every profile into a table that allocates the new way, in id order so ordered_ is
+    // rebuilt by appends. Indexes and columns only hold ids, so they stay as they are.
+    const std::vector<int> ids = list_ids();
+    ProfileTable moved(arena);
+    ordered_.clear();
+    for (int id : ids)
+    {
+        Profile& profile = *moved.emplace(std::move(*profiles_.find(id))).first;
+        profile.set_arena(arena);
+        profile.set_observer(this); // the observer link is not carried over by a move
+        ordered_.insert(id, &profile);
+    }
+    profiles_ = std::move(moved);
+    if (!arena) arena_.reset(); // nothing refers to the arena any more
+}
+
+AllocationMode ProfileStore::allocation_mode() const
+{
+    return allocation_;
+}
+
+ArenaStats ProfileStore::arena_stats() const
+{
+    return arena_.stats();
+}
+
+void ProfileStore::set_layout(StorageLayout layout)
+{
+    if (layout == layout_) return;
+    materialize();
+    layout_ = layout;
+    columns_.clear();
+
+    if (layout == StorageLayout::Columnar)
+    {
+        columns_.reserve(profiles_.size());
+        profiles_.for_each([this](const Profile& p) { columns_.add(p); });
+    }
+}
+
+StorageLayout ProfileStore::layout() const
+{
+    return layout_;
+}
+
+std::size_t ProfileStore::scan_count_age_between(int min_age, int max_age) const
+{
+    materialize();
+    if (layout_ == StorageLayout::Columnar) return columns_.count_age_between(min_age, max_age);
+
+    std::size_t count = 0;
+    profiles_.for_each([&](const Profile& p)
+    {
+        if (p.age() >= min_age && p.age() <= max_age) ++count;
+    });
+    return count;
+}
+
+std::size_t ProfileStore::scan_count_in_country(const std::string& country, int min_age, int max_age) const
+{
+    materialize();
+    const StringPool::Handle handle = strings_.find(country);
+    if (handle == StringPool::npos) return 0; // nobody lives in a country we never interned
+
+    if (layout_ == StorageLayout::Columnar) return columns_.count_in_country(handle, min_age, max_age);
+
+    std::size_t count = 0;
+    profiles_.for_each([&](const Profile& p)
+    {
+        if (p.country_handle() == handle && p.age() >= min_age && p.age() <= max_age) ++count;
+    });
+    return count;
+}
+
+std::vector<std::size_t> ProfileStore::scan_country_counts() const
+{
+    materialize();
+    std::vector<std::size_t> counts(strings_.size(), 0);
+    if (layout_ == StorageLayout::Columnar)
+    {
+        columns_.add_country_counts(counts);
+        return counts;
+    }
+
+    profiles_.for_each([&](const Profile& p) { ++counts[p.country_handle()]; });
+    return counts;
+}
+
+std::size_t ProfileStore::partition_count() const
+{
+    materialize();
+    return profiles_.page_count();
+}
+
+std::vector<int> ProfileStore::query_ids(const ProfileQuery& query, unsigned thread_count) const
+{
+    return ProfileQueryEngine::ids(*this, query, thread_count);
+}
+
+std::vector<QueryRow> ProfileStore::query(const ProfileQuery& query, unsigned fields, unsigned thread_count) const
+{
+    return ProfileQueryEngine::rows(*this, query, fields, thread_count);
+}
+
+std::size_t ProfileStore::query_count(const ProfileQuery& query, unsigned thread_count) const
+{
+    return ProfileQueryEngine::count(*this, query, thread_count);
+}
+
+std::vector<CountryCount> ProfileStore::query_count_by_country(const ProfileQuery& query, unsigned thread_count) const
+{
+    return ProfileQueryEngine::count_by_country(*this, query, thread_count);
+}
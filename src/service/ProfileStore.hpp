@@ -1,19 +1,89 @@
 #ifndef PROFILEMANAGERCLI_PROFILESTORE_HPP
 #define PROFILEMANAGERCLI_PROFILESTORE_HPP
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../domain/Profile.hpp"
+#include "../domain/ProfileObserver.hpp"
+#include "../domain/StringPool.hpp"
+#include "ChangeSet.hpp"
+#include "ProfileBacking.hpp"
+#include "ProfileColumns.hpp"
+#include "ProfileIndex.hpp"
+#include "ProfileQuery.hpp"
+#include "ProfileStoreListener.hpp"
+#include "ProfileTable.hpp"
+#include "SortedIdIndex.hpp"
+#include "../util/Arena.hpp"
 
-class ProfileStore
+// How the store lays out its data for scans.
+// Rows: every scan walks the id -> Profile map.
+// Columnar: the store also keeps dense, dictionary-encoded columns (ProfileColumns) of id, age,
+// city and country; scans read those instead. Profiles stay the owners of the full record, so
+// find() and the mutators behave the same in both layouts.
+enum class StorageLayout
+{
+    Rows,
+    Columnar
+};
+
+// Where the store allocates its profiles (table pages, names, hobby buffers).
+// Heap: the global heap, one allocation at a time.
+// Arena: bump-allocated from large slabs owned by the store. Removed profiles are not reused until
+// clear(), which then drops everything in one arena reset instead of destroying profile by profile.
+// Meant for bulk-loaded, mostly read-only stores (exports, listings, conversions).
+enum class AllocationMode
+{
+    Heap,
+    Arena
+};
+
+// Stored profiles report their edits back to the store (private ProfileObserver),
+// which forwards them to any registered ProfileStoreListener.
+class ProfileStore : private ProfileObserver
 {
 private:
-    std::unordered_map<int, Profile> profiles_;
+    StringPool strings_; // interned city/country/hobby text; declared first so it outlives the profiles
+    Arena arena_;        // backs profiles_ in AllocationMode::Arena; declared before it for the same reason
+    ProfileTable profiles_; // id -> profile, stored in place (no per-profile node)
+    AllocationMode allocation_ = AllocationMode::Heap;
+    SortedIdIndex ordered_; // same profiles in id order (table slots don't move, so the pointers stay valid)
     int next_id_ = 1;
+    std::vector<ProfileStoreListener*> listeners_;
+    ProfileIndex index_;   // secondary indexes (city, country, age, hobby)
+    bool indexing_ = true;
+    ProfileColumns columns_; // only maintained in StorageLayout::Columnar
+    StorageLayout layout_ = StorageLayout::Rows;
+    bool unique_hobbies_ = false;
+    // Lazy mode cache. Const readers fill it (find(), materialize()), so it is guarded by lazy_mutex_;
+    // lazy_ lets them skip the lock once everything is in memory.
+    mutable std::unique_ptr<ProfileBacking> backing_; // records still on disk
+    mutable std::unordered_set<int> taken_;           // backing ids already read (or removed) since open_lazy
+    mutable std::mutex lazy_mutex_;
+    mutable std::atomic<bool> lazy_{false};
+    ChangeSet changes_; // ids touched since the last load/save (delta saves)
+    std::size_t bulk_loads_ = 0; // open BulkLoad scopes
+
+    void added(Profile& profile); // wires a newly stored profile into observer, index and listeners
+    void wire(Profile& profile);  // the same without telling the listeners (records read from backing_)
+    bool store_profile(Profile&& profile); // insert without touching next_id_
+    Profile* fault_in(int id);    // reads one record from backing_ into the table
+
+    // ProfileObserver
+    void profile_changing(const Profile& profile, ProfileField field) override;
+    void profile_changed(const Profile& profile, ProfileField field, const std::string& hobby) override;
 
 public:
+    ProfileStore() = default;
+    // Profiles hold a pointer back to their store, so a store cannot be copied or moved
+    ProfileStore(const ProfileStore&) = delete;
+    ProfileStore& operator=(const ProfileStore&) = delete;
+
     // Profile creation and return it's assigned ID
     int create_profile(const std::string& name,
                        int age,
@@ -26,11 +96,156 @@ public:
     // Remove profile by ID. True if removed / False if not found
     bool remove(int id);
 
-    std::vector<int> list_ids() const; // Return all ID's
+    std::vector<int> list_ids() const; // Return all ID's (ascending)
     std::size_t size() const; // num of profiles stored
 
     void clear(); // clears all stored profiles and resets id counter
-    bool insert_profile(const Profile& profile); // pre-constructed profile (e.g. from disk)
+
+    // Lazy mode: replaces the contents with `backing` without reading any record.
+    // find() and remove() read a record on first access and keep it; size() is exact right away.
+    // Operations that need every profile (listing, ordered/full scans, queries, index lookups,
+    // layout/allocation switches, saving) call materialize() first. Listeners are not told about
+    // records read this way (they were already there, nothing changed); instead, opening lazily with
+    // listeners attached reads every record at once and announces it like load() does, and
+    // add_listener() materializes first.
+    // Const methods stay safe to call from several threads at once in lazy mode, and so does reading
+    // the profiles they return (pooled text included, see StringPool): reads from the backing are
+    // serialised, and nothing they add moves what other readers already hold.
+    void open_lazy(std::unique_ptr<ProfileBacking> backing);
+    bool lazy() const; // records still on disk
+    // Reads every record that is still on disk and drops the backing (no-op outside lazy mode).
+    // Const because it only fills a cache: the store's contents do not change.
+    void materialize() const;
+    bool insert_profile(const Profile& profile); // pre-constructed profile (e.g. from disk), re-interned here
+    bool insert_profile(Profile&& profile);      // same, moving the name and hobbies in instead of copying
+
+    // Bulk import (loaders). reserve() sizes the storage for `profiles` records up front;
+    // insert_batch() moves a batch in (ids already stored are skipped, as with insert_profile),
+    // bumps the id counter once per batch, leaves `batch` empty and returns how many were stored.
+    void reserve(std::size_t profiles);
+    std::size_t insert_batch(std::vector<Profile>& batch);
+
+    // Scope around a loader's inserts: the name index is left alone while it is open and rebuilt in one
+    // pass when the outermost scope closes, so the store is fully indexed when the load returns.
+    class BulkLoad
+    {
+        private:
+            ProfileStore& store_;
+
+        public:
+            explicit BulkLoad(ProfileStore& store);
+            ~BulkLoad();
+            BulkLoad(const BulkLoad&) = delete;
+            BulkLoad& operator=(const BulkLoad&) = delete;
+    };
+
+    // Change tracking for delta saves: every create/insert, remove and Profile edit since the contents
+    // last matched a file. Loaders and savers call mark_clean(path) once the store and that file agree.
+    const ChangeSet& changes() const;
+    void mark_clean(const std::string& source);
+
+    // Pool every stored profile interns into. Loaders build profiles against it directly.
+    // The const overload reads a lazy store in full first, so lookups by text see every record.
+    StringPool& strings();
+    const StringPool& strings() const;
+
+    // Mutation listeners (not owned). A listener must be removed before it is destroyed.
+    // Adding one to a lazy store reads every record first (see open_lazy()).
+    void add_listener(ProfileStoreListener* listener);
+    void remove_listener(ProfileStoreListener* listener);
+
+    // Secondary indexes. On by default; turning them off saves memory/time for throwaway stores
+    // (conversions, compaction) and turning them back on rebuilds them in one pass.
+    void set_indexing(bool enabled);
+    bool indexing() const;
+
+    // Index queries: ascending ids, no scan of the store. Ranges are invalidated by the next mutation.
+    // With indexing switched off they return empty results.
+    IdRange ids_in_city(const std::string& city) const;
+    IdRange ids_in_country(const std::string& country) const;
+    IdRange ids_with_hobby(const std::string& hobby) const;
+    std::vector<IdRange> ids_by_age(int min_age, int max_age) const; // one range per age, inclusive bounds
+    std::size_t count_by_age(int min_age, int max_age) const;
+
+    // Name search (partial, case-insensitive, typo tolerant) through the trigram index: up to `limit`
+    // matches, best first (see NameIndex.hpp for the ranking). Empty with indexing switched off.
+    // The index is maintained with the others, from the load on (switching indexing on rebuilds it).
+    std::vector<NameMatch> search_names(const std::string& query, std::size_t limit = 10) const;
+
+    // Unique hobbies: every stored profile (current and future) refuses duplicate add_hobby calls.
+    // Off by default; duplicates already on a profile (e.g. loaded from a file) are left alone.
+    void set_unique_hobbies(bool unique);
+    bool unique_hobbies() const;
+
+    // Switching moves every stored profile into the new allocation mode.
+    void set_allocation_mode(AllocationMode mode);
+    AllocationMode allocation_mode() const;
+    ArenaStats arena_stats() const; // all zero unless the arena has been used
+
+    // Switching to Columnar builds the columns in one pass; switching back drops them.
+    void set_layout(StorageLayout layout);
+    StorageLayout layout() const;
+
+    // Full scans (no index needed), served from the columns in the Columnar layout
+    std::size_t scan_count_age_between(int min_age, int max_age) const; // inclusive bounds
+    std::size_t scan_count_in_country(const std::string& country, int min_age, int max_age) const;
+    std::vector<std::size_t> scan_country_counts() const; // indexed by country handle (see strings())
+
+    // Visit every profile in unspecified order (no id copy, no sort, no lookups)
+    template <typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        materialize();
+        profiles_.for_each(fn);
+    }
+
+    // Storage split into partitions (table pages) for parallel scans: visit the profiles of
+    // partitions [first, last). Disjoint ranges can be scanned from different threads at once.
+    // partition_count() materializes a lazy store, so call it before handing out partitions.
+    std::size_t partition_count() const;
+    template <typename Fn>
+    void for_each_in_partitions(std::size_t first, std::size_t last, Fn&& fn) const
+    {
+        profiles_.for_each_in_pages(first, last, fn);
+    }
+
+    // Filtered queries (see ProfileQuery.hpp), scanned in parallel on a thread pool.
+    // thread_count == 0 means one thread per hardware thread. Results are in ascending id order.
+    std::vector<int> query_ids(const ProfileQuery& query, unsigned thread_count = 0) const;
+    std::vector<QueryRow> query(const ProfileQuery& query, unsigned fields = query_fields::all,
+                                unsigned thread_count = 0) const;
+    std::size_t query_count(const ProfileQuery& query, unsigned thread_count = 0) const;
+    std::vector<CountryCount> query_count_by_country(const ProfileQuery& query, unsigned thread_count = 0) const;
+
+    // Profiles in ascending id order: `for (const Profile& p : store.ordered())`.
+    // Kept up to date on every insert/remove, so walking it needs no sort and no lookups.
+    // Iterators are invalidated by the next insert or remove.
+    const SortedIdIndex& ordered() const;
+
+    // Visit every profile in ascending id order
+    template <typename Fn>
+    void for_each_ordered(Fn&& fn) const
+    {
+        materialize();
+        for (const Profile& p : ordered_) fn(p);
+    }
+
+    // Range API for cursor-based paging.
+    // Visits up to `limit` profiles with id >= first_id in ascending order; returns how many were visited.
+    template <typename Fn>
+    std::size_t for_each_from(int first_id, std::size_t limit, Fn&& fn) const
+    {
+        materialize();
+        std::size_t visited = 0;
+        for (auto it = ordered_.lower_bound(first_id); it != ordered_.end() && visited < limit; ++it, ++visited)
+        {
+            fn(*it);
+        }
+        return visited;
+    }
+    // Id of the profile `steps` positions before the first id >= `id` (the smallest id if there are fewer).
+    // Returns `id` itself when the store is empty.
+    int id_before(int id, std::size_t steps) const;
 
 };
 
@@ -0,0 +1,27 @@
+#ifndef PROFILEMANAGERCLI_PROFILESTORELISTENER_HPP
+#define PROFILEMANAGERCLI_PROFILESTORELISTENER_HPP
+
+#include <string>
+
+#include "../domain/ProfileObserver.hpp"
+
+class Profile;
+
+// Receives every mutation applied to a ProfileStore, including edits made through a Profile* from find().
+// Used by layers that mirror the store (e.g. the write-ahead log); the store itself stays unaware of them.
+class ProfileStoreListener
+{
+    public:
+        virtual ~ProfileStoreListener() = default;
+
+        // A profile entered the store (create_profile or insert_profile); it is passed in full, hobbies included
+        virtual void profile_added(const Profile& profile) = 0;
+        // A profile is about to be erased by remove()
+        virtual void profile_removed(const Profile& profile) = 0;
+        // clear() dropped every profile
+        virtual void store_cleared() = 0;
+        // A stored profile was edited (see ProfileObserver::profile_changed)
+        virtual void profile_changed(const Profile& profile, ProfileField field, const std::string& hobby) = 0;
+};
+
+#endif //PROFILEMANAGERCLI_PROFILESTORELISTENER_HPP
@@ -0,0 +1,215 @@
+#include "ProfileTable.hpp"
+
+#include <algorithm> // std::lower_bound, std::max
+#include <new> // placement new
+
+// ProfileTable: id-indexed pages of profiles
+
+namespace
+{
+    // First sparse entry whose page index is >= index
+    template <typename Entries>
+    auto sparse_lower_bound(Entries& entries, std::size_t index)
+    {
+        return std::lower_bound(entries.begin(), entries.end(), index,
+                                [](const auto& entry, std::size_t i) { return entry.first < i; });
+    }
+}
+
+ProfileTable::ProfileTable(Arena* arena) : arena_(arena) {}
+
+ProfileTable::~ProfileTable()
+{
+    clear();
+}
+
+ProfileTable::ProfileTable(ProfileTable&& other) noexcept
+    : pages_(std::move(other.pages_)), sparse_(std::move(other.sparse_)),
+      live_pages_(std::exchange(other.live_pages_, 0)), size_(std::exchange(other.size_, 0)), arena_(other.arena_)
+{
+    other.pages_.clear();
+    other.sparse_.clear();
+}
+
+ProfileTable& ProfileTable::operator=(ProfileTable&& other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        pages_ = std::move(other.pages_);
+        other.pages_.clear();
+        sparse_ = std::move(other.sparse_);
+        other.sparse_.clear();
+        live_pages_ = std::exchange(other.live_pages_, 0);
+        size_ = std::exchange(other.size_, 0);
+        arena_ = other.arena_;
+    }
+    return *this;
+}
+
+std::size_t ProfileTable::dense_limit() const
+{
+    // At least half of the directory holds pages, plus a small fixed slack (64 entries = 512 bytes)
+    // so a fresh store fills in without going through the sparse list
+    return std::max<std::size_t>(64, 2 * live_pages_);
+}
+
+ProfileTable::Page* ProfileTable::page_for(std::uint32_t k) const
+{
+    const std::size_t index = k >> page_bits;
+    if (index < pages_.size()) return pages_[index];
+
+    auto it = sparse_lower_bound(sparse_, index);
+    return (it != sparse_.end() && it->first == index) ? it->second : nullptr;
+}
+
+ProfileTable::Page*& ProfileTable::slot_for(std::size_t index)
+{
+    if (index < pages_.size()) return pages_[index];
+
+    if (index < dense_limit())
+    {
+        // Grow the directory and take over the sparse pages it now covers (the front of sparse_)
+        pages_.resize(index + 1, nullptr);
+        auto covered = sparse_.begin();
+        while (covered != sparse_.end() && covered->first <= index)
+        {
+            pages_[covered->first] = covered->second;
+            ++covered;
+        }
+        sparse_.erase(sparse_.begin(), covered);
+        return pages_[index];
+    }
+
+    auto it = sparse_lower_bound(sparse_, index);
+    if (it == sparse_.end() || it->first != index) it = sparse_.insert(it, {static_cast<std::uint32_t>(index), nullptr});
+    return it->second;
+}
+
+const ProfileTable::Page* ProfileTable::page_at(std::size_t partition) const
+{
+    if (partition < pages_.size()) return pages_[partition];
+    return sparse_[partition - pages_.size()].second;
+}
+
+void ProfileTable::destroy_page(Page* page)
+{
+    page->~Page();
+    ArenaAllocator<Page>(arena_).deallocate(page, 1); // no-op in an arena
+    --live_pages_;
+}
+
+void ProfileTable::free_page(std::size_t index)
+{
+    if (index < pages_.size())
+    {
+        destroy_page(pages_[index]);
+        pages_[index] = nullptr;
+        return;
+    }
+    auto it = sparse_lower_bound(sparse_, index);
+    destroy_page(it->second);
+    sparse_.erase(it);
+}
+
+std::pair<Profile*, bool> ProfileTable::emplace(const Profile& profile)
+{
+    return emplace(Profile(profile));
+}
+
+std::pair<Profile*, bool> ProfileTable::emplace(Profile&& profile)
+{
+    const std::uint32_t k = key(profile.id());
+    const std::size_t index = k >> page_bits;
+    const std::size_t pos = k & (page_size - 1);
+
+    Page*& page = slot_for(index);
+    if (!page)
+    {
+        // Default-initialised: only the bitmap and count are set, the profile slots stay raw memory
+        page = new (ArenaAllocator<Page>(arena_).allocate(1)) Page;
+        ++live_pages_;
+    }
+
+    if (page->has(pos)) return {page->slot(pos), false};
+    Profile* stored = new (page->slot(pos)) Profile(std::move(profile));
+    page->occupied[pos / 64] |= std::uint64_t(1) << (pos % 64);
+    ++page->count;
+    ++size_;
+    return {stored, true};
+}
+
+void ProfileTable::reserve(std::size_t profiles)
+{
+    pages_.reserve(profiles / page_size + 1);
+}
+
+Profile* ProfileTable::find(int id)
+{
+    const std::uint32_t k = key(id);
+    Page* page = page_for(k);
+    const std::size_t pos = k & (page_size - 1);
+    return (page && page->has(pos)) ? page->slot(pos) : nullptr;
+}
+
+const Profile* ProfileTable::find(int id) const
+{
+    return const_cast<ProfileTable*>(this)->find(id);
+}
+
+bool ProfileTable::erase(int id)
+{
+    const std::uint32_t k = key(id);
+    Page* page = page_for(k);
+    const std::size_t pos = k & (page_size - 1);
+    if (!page || !page->has(pos)) return false;
+
+    page->slot(pos)->~Profile();
+    page->occupied[pos / 64] &= ~(std::uint64_t(1) << (pos % 64));
+    --size_;
+    if (--page->count == 0) free_page(k >> page_bits);
+    return true;
+}
+
+std::size_t ProfileTable::size() const
+{
+    return size_;
+}
+
+bool ProfileTable::empty() const
+{
+    return size_ == 0;
+}
+
+Arena* ProfileTable::arena() const
+{
+    return arena_;
+}
+
+void ProfileTable::clear()
+{
+    for (std::size_t partition = 0; partition < page_count(); ++partition)
+    {
+        Page* page = const_cast<Page*>(page_at(partition));
+        if (!page) continue;
+        for (std::size_t w = 0; w < page_size / 64; ++w)
+        {
+            for (std::uint64_t bits = page->occupied[w]; bits != 0; bits &= bits - 1)
+            {
+                page->slot(w * 64 + lowest_bit(bits))->~Profile();
+            }
+        }
+        destroy_page(page);
+    }
+    pages_.clear();
+    sparse_.clear();
+    size_ = 0;
+}
+
+void ProfileTable::abandon()
+{
+    pages_.clear();
+    sparse_.clear();
+    live_pages_ = 0;
+    size_ = 0;
+}
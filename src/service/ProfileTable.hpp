@@ -0,0 +1,134 @@
+#ifndef PROFILEMANAGERCLI_PROFILETABLE_HPP
+#define PROFILEMANAGERCLI_PROFILETABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../domain/Profile.hpp"
+#include "../util/Arena.hpp"
+
+// Id -> Profile storage for ProfileStore: a two-level array indexed directly by id.
+// The store hands out ids densely, so a lookup is two array reads (directory, then slot) with
+// no hashing and no per-profile node. Pages hold page_size profiles in place plus an occupancy
+// bitmap; a page is created when the first id in its range is stored and freed when its last
+// profile is erased. Pages never move, so a Profile's address is stable until it is erased
+// (SortedIdIndex and the observer links rely on that).
+// The directory only grows while it stays reasonably full (see dense_limit()); a page far away
+// from the rest (e.g. a negative or huge id read from a file) goes into a short sorted list of
+// sparse pages instead, so any int id costs one page, not a directory spanning the distance.
+class ProfileTable
+{
+public:
+    static constexpr unsigned page_bits = 10;
+    static constexpr std::size_t page_size = std::size_t(1) << page_bits;
+
+private:
+    struct Page
+    {
+        std::uint64_t occupied[page_size / 64] = {};
+        std::size_t count = 0;
+        alignas(Profile) unsigned char slots[page_size * sizeof(Profile)];
+
+        Profile* slot(std::size_t i) { return reinterpret_cast<Profile*>(slots) + i; }
+        bool has(std::size_t i) const { return (occupied[i / 64] >> (i % 64)) & 1u; }
+    };
+
+    using SparsePage = std::pair<std::uint32_t, Page*>; // page index, page
+
+    std::vector<Page*> pages_;        // indexed by key >> page_bits; nullptr = nothing stored in that range
+    std::vector<SparsePage> sparse_;  // pages at index >= pages_.size(), sorted by index
+    std::size_t live_pages_ = 0;      // non-null pages, dense and sparse
+    std::size_t size_ = 0;
+    Arena* arena_ = nullptr;          // where pages come from; nullptr = global heap
+
+    static std::uint32_t key(int id) { return static_cast<std::uint32_t>(id); }
+
+    // Position (0-63) of the lowest set bit of a non-zero word (portable count-trailing-zeros)
+    static unsigned lowest_bit(std::uint64_t bits)
+    {
+        static constexpr unsigned char positions[64] = {
+            0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6};
+        // Isolate the lowest bit, then a de Bruijn multiply puts a unique pattern in the top 6 bits
+        return positions[((bits & (~bits + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+    }
+
+    std::size_t dense_limit() const; // the directory may grow to this many entries
+    Page* page_for(std::uint32_t k) const;
+    Page*& slot_for(std::size_t index); // directory or sparse entry for a page index (created if missing)
+    void free_page(std::size_t index);
+    void destroy_page(Page* page);
+    const Page* page_at(std::size_t partition) const; // by position in page_count() order
+
+public:
+    explicit ProfileTable(Arena* arena = nullptr);
+    ~ProfileTable();
+
+    // Profiles point back into their pages' owner, so the table is not copyable; moving hands the pages over
+    ProfileTable(const ProfileTable&) = delete;
+    ProfileTable& operator=(const ProfileTable&) = delete;
+    ProfileTable(ProfileTable&& other) noexcept;
+    ProfileTable& operator=(ProfileTable&& other) noexcept;
+
+    // Stores the profile under profile.id(). {existing, false} if the id is taken.
+    std::pair<Profile*, bool> emplace(const Profile& profile);
+    std::pair<Profile*, bool> emplace(Profile&& profile);
+
+    void reserve(std::size_t profiles); // directory room for ids 1..profiles (pages are still created on use)
+
+    Profile* find(int id);
+    const Profile* find(int id) const;
+    bool erase(int id);
+
+    std::size_t size() const;
+    bool empty() const;
+    Arena* arena() const;
+
+    void clear(); // destroys every profile
+    // Arena mode: forgets every profile without running destructors. Only valid when everything
+    // the profiles own lives in the arena, which the caller resets right after.
+    void abandon();
+
+    // Visit every profile, in ascending key order (non-negative ids ascending, then negative ones)
+    template <typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        for_each_in_pages(0, page_count(), fn);
+    }
+
+    // Pages are the unit for splitting a scan between threads: [first, last) of page_count()
+    // (directory entries first, then the sparse pages, so the order stays ascending by key)
+    std::size_t page_count() const { return pages_.size() + sparse_.size(); }
+
+    template <typename Fn>
+    void for_each_in_pages(std::size_t first, std::size_t last, Fn&& fn) const
+    {
+        for (std::size_t index = first; index < last && index < page_count(); ++index)
+        {
+            const Page* page = page_at(index);
+            if (!page) continue;
+            for (std::size_t w = 0; w < page_size / 64; ++w)
+            {
+                for (std::uint64_t bits = page->occupied[w]; bits != 0; bits &= bits - 1)
+                {
+                    const std::size_t pos = w * 64 + lowest_bit(bits);
+                    const Profile& profile = *const_cast<Page*>(page)->slot(pos);
+                    fn(profile);
+                }
+            }
+        }
+    }
+
+    template <typename Fn>
+    void for_each(Fn&& fn)
+    {
+        static_cast<const ProfileTable&>(*this).for_each_in_pages(0, page_count(),
+                                                                  [&](const Profile& p) { fn(const_cast<Profile&>(p)); });
+    }
+};
+
+#endif //PROFILEMANAGERCLI_PROFILETABLE_HPP
@@ -0,0 +1,128 @@
+#include "SortedIdIndex.hpp"
+
+#include <algorithm> // std::lower_bound, std::partition_point
+
+// SortedIdIndex: blocked sorted array of (id, profile)
+
+namespace
+{
+    bool entry_before(const std::pair<int, const Profile*>& entry, int id)
+    {
+        return entry.first < id;
+    }
+}
+
+std::size_t SortedIdIndex::block_for(int id) const
+{
+    // First block whose last id is >= id; ids beyond every block go to the last one
+    auto it = std::partition_point(blocks_.begin(), blocks_.end(),
+                                   [id](const Block& block) { return block.back().first < id; });
+    if (it == blocks_.end()) return blocks_.size() - 1;
+    return static_cast<std::size_t>(it - blocks_.begin());
+}
+
+void SortedIdIndex::insert(int id, const Profile* profile)
+{
+    ++size_;
+    if (blocks_.empty())
+    {
+        blocks_.emplace_back();
+        blocks_.back().reserve(max_block);
+        blocks_.back().emplace_back(id, profile);
+        return;
+    }
+
+    const std::size_t b = block_for(id);
+    Block& block = blocks_[b];
+
+    // Appending past the current maximum: start a new block when the last one is full,
+    // so sequential ids fill blocks completely instead of leaving them half empty after splits
+    if (b + 1 == blocks_.size() && id > block.back().first)
+    {
+        if (block.size() < max_block)
+        {
+            block.emplace_back(id, profile);
+            return;
+        }
+        blocks_.emplace_back();
+        blocks_.back().reserve(max_block);
+        blocks_.back().emplace_back(id, profile);
+        return;
+    }
+
+    block.insert(std::lower_bound(block.begin(), block.end(), id, entry_before), Entry(id, profile));
+    if (block.size() <= max_block) return;
+
+    // Split a full block in two halves
+    Block upper(block.begin() + static_cast<std::ptrdiff_t>(block.size() / 2), block.end());
+    block.resize(block.size() / 2);
+    blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(b) + 1, std::move(upper));
+}
+
+void SortedIdIndex::erase(int id)
+{
+    if (blocks_.empty()) return;
+
+    const std::size_t b = block_for(id);
+    Block& block = blocks_[b];
+    auto it = std::lower_bound(block.begin(), block.end(), id, entry_before);
+    if (it == block.end() || it->first != id) return;
+
+    block.erase(it);
+    --size_;
+    if (block.empty())
+    {
+        blocks_.erase(blocks_.begin() + static_cast<std::ptrdiff_t>(b)); // keep blocks non-empty
+        return;
+    }
+
+    // Fold a mostly empty block into its successor, so heavy deletion doesn't leave lots of tiny blocks
+    if (block.size() < max_block / 4 && b + 1 < blocks_.size() && block.size() + blocks_[b + 1].size() <= max_block)
+    {
+        Block& next = blocks_[b + 1];
+        next.insert(next.begin(), block.begin(), block.end());
+        blocks_.erase(blocks_.begin() + static_cast<std::ptrdiff_t>(b));
+    }
+}
+
+void SortedIdIndex::reserve(std::size_t count)
+{
+    blocks_.reserve(count / max_block + 1);
+}
+
+void SortedIdIndex::clear()
+{
+    blocks_.clear();
+    size_ = 0;
+}
+
+std::size_t SortedIdIndex::size() const
+{
+    return size_;
+}
+
+bool SortedIdIndex::empty() const
+{
+    return size_ == 0;
+}
+
+SortedIdIndex::const_iterator SortedIdIndex::begin() const
+{
+    return const_iterator(&blocks_, 0, 0);
+}
+
+SortedIdIndex::const_iterator SortedIdIndex::end() const
+{
+    return const_iterator(&blocks_, blocks_.size(), 0);
+}
+
+SortedIdIndex::const_iterator SortedIdIndex::lower_bound(int id) const
+{
+    if (blocks_.empty()) return end();
+
+    const std::size_t b = block_for(id);
+    const Block& block = blocks_[b];
+    auto it = std::lower_bound(block.begin(), block.end(), id, entry_before);
+    if (it == block.end()) return end(); // only possible in the last block: id is past everything
+    return const_iterator(&blocks_, b, static_cast<std::size_t>(it - block.begin()));
+}
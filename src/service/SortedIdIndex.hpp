@@ -0,0 +1,92 @@
+#ifndef PROFILEMANAGERCLI_SORTEDIDINDEX_HPP
+#define PROFILEMANAGERCLI_SORTEDIDINDEX_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+class Profile;
+
+// Profiles in ascending id order, maintained incrementally so ordered walks need no sort and no
+// per-id lookup. Entries live in sorted blocks of at most max_block entries (a flat, two-level
+// B-tree): appending the next id - the usual case - is a push_back, an out-of-order insert or an
+// erase only shifts entries within one block, and iteration is a linear walk over the blocks.
+class SortedIdIndex
+{
+private:
+    using Entry = std::pair<int, const Profile*>;
+    using Block = std::vector<Entry>;
+
+    static constexpr std::size_t max_block = 512;
+
+    std::vector<Block> blocks_; // non-empty, each sorted, and every block's ids below the next block's
+    std::size_t size_ = 0;
+
+    std::size_t block_for(int id) const; // block that holds (or should hold) id
+
+public:
+    // Bidirectional iterator over const Profile& in id order
+    class const_iterator
+    {
+    private:
+        const std::vector<Block>* blocks_ = nullptr;
+        std::size_t block_ = 0;
+        std::size_t pos_ = 0;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Profile;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Profile*;
+        using reference = const Profile&;
+
+        const_iterator() = default;
+        const_iterator(const std::vector<Block>* blocks, std::size_t block, std::size_t pos)
+            : blocks_(blocks), block_(block), pos_(pos) {}
+
+        reference operator*() const { return *(*blocks_)[block_][pos_].second; }
+        pointer operator->() const { return (*blocks_)[block_][pos_].second; }
+        int id() const { return (*blocks_)[block_][pos_].first; }
+
+        const_iterator& operator++()
+        {
+            if (++pos_ == (*blocks_)[block_].size())
+            {
+                ++block_;
+                pos_ = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+
+        const_iterator& operator--()
+        {
+            if (pos_ == 0)
+            {
+                --block_;
+                pos_ = (*blocks_)[block_].size();
+            }
+            --pos_;
+            return *this;
+        }
+        const_iterator operator--(int) { const_iterator old = *this; --*this; return old; }
+
+        bool operator==(const const_iterator& other) const { return block_ == other.block_ && pos_ == other.pos_; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    void insert(int id, const Profile* profile); // id must not be present yet
+    void erase(int id);
+    void clear();
+    void reserve(std::size_t count); // room for count entries worth of blocks
+
+    std::size_t size() const;
+    bool empty() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator lower_bound(int id) const; // first entry with id >= `id`
+};
+
+#endif //PROFILEMANAGERCLI_SORTEDIDINDEX_HPP
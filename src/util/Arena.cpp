@@ -0,0 +1,46 @@
+#include "Arena.hpp"
+
+#include <algorithm> // std::max
+
+// Arena: slab bump allocation
+
+Arena::Arena(std::size_t slab_size) : slab_size_(slab_size == 0 ? default_slab_size : slab_size) {}
+
+void* Arena::allocate_slow(std::size_t bytes, std::size_t align)
+{
+    // Start a new slab; an allocation bigger than a slab gets a slab of its own size
+    const std::size_t size = std::max(slab_size_, bytes + align);
+    slabs_.push_back(Slab{std::unique_ptr<std::byte[]>(new std::byte[size]), size}); // not zero-filled
+    stats_.reserved_bytes += size;
+    ++stats_.slabs;
+
+    cursor_ = slabs_.back().memory.get();
+    limit_ = cursor_ + size;
+    return allocate(bytes, align);
+}
+
+void Arena::reset()
+{
+    if (slabs_.size() > 1)
+    {
+        // Keep the largest slab around for the next fill
+        auto largest = std::max_element(slabs_.begin(), slabs_.end(),
+                                        [](const Slab& a, const Slab& b) { return a.size < b.size; });
+        Slab kept = std::move(*largest);
+        slabs_.clear();
+        slabs_.push_back(std::move(kept));
+    }
+
+    stats_.slabs = slabs_.size();
+    stats_.reserved_bytes = slabs_.empty() ? 0 : slabs_.back().size;
+    stats_.used_bytes = 0;
+    stats_.allocations = 0;
+    ++stats_.resets;
+    cursor_ = slabs_.empty() ? nullptr : slabs_.back().memory.get();
+    limit_ = slabs_.empty() ? nullptr : cursor_ + slabs_.back().size;
+}
+
+ArenaStats Arena::stats() const
+{
+    return stats_;
+}
@@ -0,0 +1,115 @@
+#ifndef PROFILEMANAGERCLI_ARENA_HPP
+#define PROFILEMANAGERCLI_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Counters for checking how much an arena saved (and wasted)
+struct ArenaStats
+{
+    std::size_t slabs = 0;          // slabs currently held
+    std::size_t reserved_bytes = 0; // total size of those slabs
+    std::size_t used_bytes = 0;     // handed out since the last reset (freed blocks included)
+    std::size_t allocations = 0;    // allocate() calls since the last reset
+    std::size_t resets = 0;
+};
+
+// Bump allocator over large slabs. allocate() is a pointer increment; individual blocks are never
+// freed, everything goes at once in reset(). Not thread-safe: one arena belongs to one owner
+// (e.g. a ProfileStore), just like the data it holds.
+class Arena
+{
+private:
+    struct Slab
+    {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    std::vector<Slab> slabs_;
+    std::size_t slab_size_;
+    std::byte* cursor_ = nullptr; // next free byte in slabs_.back()
+    std::byte* limit_ = nullptr;
+    ArenaStats stats_;
+
+    void* allocate_slow(std::size_t bytes, std::size_t align);
+
+public:
+    static constexpr std::size_t default_slab_size = std::size_t(1) << 20; // 1 MiB
+
+    explicit Arena(std::size_t slab_size = default_slab_size);
+
+    // Pointers into the slabs are handed out, so the arena stays where it is
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align)
+    {
+        // Fast path: fits in the current slab
+        const auto address = reinterpret_cast<std::size_t>(cursor_);
+        const std::size_t padding = (align - (address & (align - 1))) & (align - 1);
+        if (cursor_ && bytes + padding <= static_cast<std::size_t>(limit_ - cursor_))
+        {
+            std::byte* block = cursor_ + padding;
+            cursor_ = block + bytes;
+            stats_.used_bytes += bytes;
+            ++stats_.allocations;
+            return block;
+        }
+        return allocate_slow(bytes, align);
+    }
+
+    // Forgets every allocation in O(slabs). Keeps one slab so a reload does not start from scratch.
+    // Nothing allocated from the arena may be touched afterwards (destructors included).
+    void reset();
+
+    ArenaStats stats() const;
+};
+
+// Standard allocator over an Arena, or over the global heap when constructed without one.
+// deallocate() is a no-op for arena memory (the arena frees it on reset).
+// Copying a container gives the copy a heap allocator, so copies never point into someone else's arena.
+template <typename T>
+class ArenaAllocator
+{
+private:
+    Arena* arena_ = nullptr;
+
+    template <typename U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (arena_) return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        if (!arena_) ::operator delete(p);
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    Arena* arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena_; }
+};
+
+#endif //PROFILEMANAGERCLI_ARENA_HPP
@@ -0,0 +1,54 @@
+#include "ThreadPool.hpp"
+
+// ThreadPool: N workers pulling std::function tasks from a shared queue
+
+ThreadPool::ThreadPool(unsigned thread_count)
+{
+    const unsigned count = resolve_thread_count(thread_count);
+    workers_.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+std::size_t ThreadPool::size() const
+{
+    return workers_.size();
+}
+
+unsigned ThreadPool::resolve_thread_count(unsigned requested)
+{
+    if (requested > 0) return requested;
+    const unsigned hardware = std::thread::hardware_concurrency(); // may return 0 if unknown
+    return hardware > 0 ? hardware : 1;
+}
+
+void ThreadPool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+            // Drain remaining work before exiting so no submitted future is left broken
+            if (tasks_.empty()) return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef PROFILEMANAGERCLI_THREADPOOL_HPP
+#define PROFILEMANAGERCLI_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size pool of worker threads draining a single FIFO task queue.
+// Used for CPU-bound batch work (parallel parsing etc.), not for long-lived background jobs.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    void worker_loop();
+
+public:
+    // thread_count == 0 means "one worker per hardware thread"
+    explicit ThreadPool(unsigned thread_count = 0);
+    ~ThreadPool(); // finishes queued tasks, then joins the workers
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const;
+
+    // Queue a callable and get a future for its result (exceptions are rethrown by future::get()).
+    template <typename Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<Fn>>;
+        // packaged_task is move-only but std::function needs copyable callables, hence the shared_ptr
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task]() { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    // Resolves a requested thread count (0 = auto) to an actual one, never less than 1
+    static unsigned resolve_thread_count(unsigned requested);
+};
+
+#endif //PROFILEMANAGERCLI_THREADPOOL_HPP
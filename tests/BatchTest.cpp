@@ -0,0 +1,182 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "cli/BatchRunner.hpp"
+#include "persistence/DeltaSegments.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+// BatchRunner: every command with its output and error lines, quoting, failure counts, hobby rules
+// (a refused hobby fails its line and a failed create leaves nothing behind), and the
+// save/load/delta/merge round trip.
+
+namespace
+{
+    struct Run
+    {
+        BatchStats stats;
+        std::string output;
+    };
+
+    Run run(ProfileStore& store, const std::string& script)
+    {
+        std::istringstream in(script);
+        std::ostringstream out;
+        BatchRunner runner(store);
+        Run result;
+        result.stats = runner.run(in, out);
+        result.output = out.str();
+        return result;
+    }
+
+    void check_commands()
+    {
+        ProfileStore store;
+        const Run result = run(store,
+            "# comment, then a blank line\n"
+            "\n"
+            "create Anna 30 Oslo Norway chess golf\n"
+            "create \"Bob \\\"B\\\" Berg\" 41 \"New York\" USA\r\n"
+            "update 1 age 31\n"
+            "update 2 city \"Los Angeles\"\n"
+            "update 1 name Anne\n"
+            "hobby add 2 sailing\n"
+            "hobby remove 1 chess\n"
+            "delete 2\n"
+            "update 9 age 5\n"
+            "update 1 age old\n"
+            "update 1 age 500\n"
+            "update 1 height 3\n"
+            "hobby remove 1 chess\n"
+            "delete 2\n"
+            "create Carl x Rome Italy\n"
+            "create Carl\n"
+            "fly away\n"
+            "create \"unterminated 3 c d\n");
+
+        CHECK(result.stats.commands == 18);
+        CHECK(result.stats.failed == 10);
+        CHECK(result.output ==
+              "created 1\n"
+              "created 2\n"
+              "error line 11: no such profile\n"
+              "error line 12: age is not a number\n"
+              "error line 13: invalid value\n"
+              "error line 14: unknown field\n"
+              "error line 15: hobby not found\n"
+              "error line 16: no such profile\n"
+              "error line 17: age is not a number\n"
+              "error line 18: usage: create <name> <age> <city> <country> [hobby...]\n"
+              "error line 19: unknown command\n"
+              "error line 20: unterminated quote\n");
+
+        CHECK(store.size() == 1 && !store.find(2));
+        const Profile* anne = store.find(1);
+        CHECK(anne && anne->name() == "Anne" && anne->age() == 31 && anne->city() == "Oslo");
+        CHECK(anne && anne->hobbies().size() == 1 && anne->hobbies()[0] == "golf");
+    }
+
+    // A hobby that is refused fails the line, like a hobby remove that finds nothing
+    void check_hobby_rules()
+    {
+        ProfileStore store;
+        Run result = run(store,
+            "create Anna 30 Oslo Norway chess\n"
+            "hobby add 1 \"\"\n"
+            "hobby add 1 chess\n"
+            "create Bob 40 Oslo Norway golf \"\" piano\n");
+        // Duplicates are allowed unless unique hobbies are on; an empty hobby never is
+        CHECK(result.stats.failed == 2);
+        CHECK(result.output ==
+              "created 1\n"
+              "error line 2: hobby not added (empty, or already present)\n"
+              "error line 4: hobby not added (empty, or listed twice)\n");
+        CHECK(store.size() == 1 && store.find(1)->hobbies().size() == 2);
+
+        store.set_unique_hobbies(true);
+        result = run(store,
+            "hobby add 1 golf\n"
+            "hobby add 1 golf\n"
+            "hobby add 1 chess\n"
+            "create Carl 50 Rome Italy chess chess\n"
+            "create Dina 60 Rome Italy chess golf\n"
+            "hobby add 7 golf\n"
+            "hobby add 1\n");
+        CHECK(result.stats.commands == 7 && result.stats.failed == 5);
+        CHECK(result.output ==
+              "error line 2: hobby not added (empty, or already present)\n"
+              "error line 3: hobby not added (empty, or already present)\n"
+              "error line 4: hobby not added (empty, or listed twice)\n"
+              "created 2\n"
+              "error line 6: no such profile\n"
+              "error line 7: usage: hobby add|remove <id> <hobby>\n");
+        // The failed create took no id and left no profile
+        CHECK(store.size() == 2 && store.find(2) && store.find(2)->name() == "Dina");
+        CHECK(store.find(1)->hobbies().size() == 3);
+    }
+
+    void check_files()
+    {
+        const std::string dir = test_support::scratch_dir("batch");
+        const std::string path = dir + "/people.txt";
+        const std::string binary = dir + "/people.pmb";
+
+        ProfileStore store;
+        Run result = run(store,
+            "create Anna 30 Oslo Norway chess\n"
+            "create Bob 40 Bergen Norway\n"
+            "save " + binary + " binary\n"
+            "save " + path + "\n"
+            "save " + dir + "/x.txt yaml\n"
+            "save\n"
+            "update 2 age 41\n"
+            "create Carl 50 Rome Italy\n"
+            "delete 1\n"
+            "save " + path + " delta\n"); // builds on the last full save
+        CHECK(result.stats.failed == 2);
+        CHECK(result.output ==
+              "created 1\n"
+              "created 2\n"
+              "saved 2 profiles to " + binary + "\n"
+              "saved 2 profiles to " + path + "\n"
+              "error line 5: format must be text, binary, compressed or delta\n"
+              "error line 6: usage: save <path> [text|binary|compressed|delta]\n"
+              "created 3\n"
+              "saved changes to " + path + " (2 written, 1 deleted)\n");
+        CHECK(std::filesystem::exists(DeltaSegments::path_for(path)));
+        const std::string expected = store_dump::dump(store);
+
+        // load replaces the contents (base plus delta); merge folds the delta in
+        ProfileStore loaded;
+        loaded.create_profile("replaced", 1, "c", "d");
+        result = run(loaded,
+            "load " + path + "\n"
+            "merge " + path + "\n"
+            "load " + dir + "/missing.txt\n"
+            "merge " + dir + "/missing.txt\n"
+            "load " + binary + "\n");
+        CHECK(result.stats.failed == 2);
+        CHECK(result.output ==
+              "loaded 2 profiles from " + path + "\n"
+              "merged " + path + ".delta into " + path + "\n"
+              "error line 3: load failed (missing file or invalid format)\n"
+              "error line 4: merge failed (missing file, invalid format or damaged delta)\n"
+              "loaded 2 profiles from " + binary + "\n");
+        CHECK(!std::filesystem::exists(DeltaSegments::path_for(path)));
+
+        ProfileStore merged;
+        result = run(merged, "load " + path + "\n");
+        CHECK(result.stats.failed == 0);
+        CHECK(store_dump::dump(merged) == expected);
+        std::filesystem::remove_all(dir);
+    }
+}
+
+int main()
+{
+    check_commands();
+    check_hobby_rules();
+    check_files();
+    return test_support::finish();
+}
@@ -0,0 +1,180 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "domain/StringPool.hpp"
+#include "persistence/CompressedSnapshot.hpp"
+#include "persistence/Lz.hpp"
+#include "persistence/ProfileSerializer.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// PMCLI3: the Lz block codec on its own (round trips, long lengths and offsets, every truncation and
+// corruption of a stream), then whole snapshots: round trip through load(), load_parallel() and
+// Reader::fetch() across block boundaries, and damaged files (rejected before the store is touched).
+
+namespace
+{
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    bool lz_round_trip(const std::string& raw)
+    {
+        std::string packed;
+        lz::compress(raw, packed);
+        if (packed.size() > lz::max_compressed_size(raw.size())) return false;
+        std::string back(raw.size(), '\0');
+        return lz::decompress(packed, back.data(), back.size()) && back == raw;
+    }
+
+    void check_lz()
+    {
+        std::mt19937 rng(1);
+        CHECK(lz_round_trip(""));
+        CHECK(lz_round_trip("a"));
+        CHECK(lz_round_trip(std::string(100000, 'x')));   // long match lengths (many 255 continuation bytes)
+
+        std::string noise(70000, '\0');
+        for (char& ch : noise) ch = static_cast<char>(rng());
+        CHECK(lz_round_trip(noise));                        // incompressible, long literal runs
+
+        // Repeats further apart than the 64 KiB window, and at every short distance
+        std::string far = noise.substr(0, 300) + noise.substr(1000, 66000) + noise.substr(0, 300);
+        CHECK(lz_round_trip(far));
+        for (int round = 0; round < 2000; ++round)
+        {
+            std::string s;
+            const std::size_t length = rng() % 600;
+            while (s.size() < length)
+            {
+                if (!s.empty() && rng() % 2) s += s.substr(rng() % s.size(), 1 + rng() % 40);
+                else s += static_cast<char>('a' + rng() % 4);
+            }
+            CHECK_MSG(lz_round_trip(s), "round " << round);
+        }
+
+        // Damaged streams decode to false or to some bytes, never past the output buffer
+        std::string raw;
+        for (int i = 0; i < 400; ++i) raw += "Oslo\tNorway\tchess|golf\n" + std::to_string(i);
+        std::string packed;
+        lz::compress(raw, packed);
+        std::string out(raw.size(), '\0');
+        for (std::size_t cut = 0; cut < packed.size(); ++cut)
+        {
+            CHECK_MSG(!lz::decompress(std::string_view(packed).substr(0, cut), out.data(), out.size()), "cut " << cut);
+        }
+        for (std::size_t at = 0; at < packed.size(); ++at)
+        {
+            std::string damaged = packed;
+            damaged[at] = static_cast<char>(damaged[at] ^ (1 + rng() % 255));
+            lz::decompress(damaged, out.data(), out.size());
+        }
+        CHECK(!lz::decompress(packed, out.data(), out.size() - 1)); // wrong raw size
+    }
+
+    void check_snapshot(const std::string& dir)
+    {
+        ProfileStore original;
+        store_dump::fill(original, 20000, 2); // many 64 KiB blocks
+        const std::string expected = store_dump::dump(original);
+        const std::string path = dir + "/round.pmz";
+        CHECK(ProfileSerializer::save(original, path, SnapshotFormat::Compressed));
+
+        ProfileStore sequential;
+        ProfileStore parallel;
+        CHECK(ProfileSerializer::load(sequential, path));
+        CHECK(ProfileSerializer::load_parallel(parallel, path, 4));
+        CHECK(store_dump::dump(sequential) == expected);
+        CHECK(store_dump::dump(parallel) == expected);
+
+        CompressedSnapshot::Reader reader;
+        CHECK(reader.open(path));
+        CHECK(reader.record_count() == original.size());
+        CHECK(reader.blocks().size() > 3);
+
+        // The first and last id of every block, and the ids on either side of the file's range
+        StringPool strings;
+        for (const CompressedSnapshot::Block& block : reader.blocks())
+        {
+            for (int id : {block.min_id, block.max_id})
+            {
+                const std::optional<Profile> fetched = reader.fetch(id, strings);
+                CHECK(fetched && store_dump::dump(*fetched) == store_dump::dump(*original.find(id)));
+            }
+        }
+        CHECK(!reader.fetch(0, strings));
+        CHECK(!reader.fetch(20001, strings));
+        CHECK(!reader.fetch(-5, strings));
+
+        // Conversions between all three formats keep every profile
+        CHECK(ProfileSerializer::convert(path, dir + "/converted.txt", SnapshotFormat::Text));
+        CHECK(ProfileSerializer::convert(dir + "/converted.txt", dir + "/converted.pmz", SnapshotFormat::Compressed));
+        ProfileStore converted;
+        CHECK(ProfileSerializer::load(converted, dir + "/converted.pmz"));
+        CHECK(store_dump::dump(converted) == expected);
+    }
+
+    void check_damaged_snapshot(const std::string& dir)
+    {
+        ProfileStore original;
+        store_dump::fill(original, 3000, 3);
+        const std::string path = dir + "/damaged.pmz";
+        CHECK(ProfileSerializer::save(original, path, SnapshotFormat::Compressed));
+        const std::string bytes = read_file(path);
+
+        ProfileStore previous;
+        previous.create_profile("keep me", 1, "c", "d");
+        const std::string before = store_dump::dump(previous);
+
+        std::mt19937 rng(9);
+        for (int round = 0; round < 300; ++round)
+        {
+            std::string damaged = bytes;
+            if (round % 2) damaged.resize(rng() % bytes.size());
+            else damaged[rng() % damaged.size()] ^= static_cast<char>(1 + rng() % 255);
+            write_file(path, damaged);
+
+            for (bool parallel : {false, true})
+            {
+                ProfileStore store;
+                store.create_profile("keep me", 1, "c", "d");
+                const bool loaded = parallel ? ProfileSerializer::load_parallel(store, path, 4)
+                                             : ProfileSerializer::load(store, path);
+                // A flipped byte inside a record may still decode; anything rejected leaves the store alone
+                if (round % 2) CHECK_MSG(!loaded, "truncated to " << damaged.size());
+                if (!loaded) CHECK(store_dump::dump(store) == before);
+            }
+
+            CompressedSnapshot::Reader reader;
+            StringPool strings;
+            if (reader.open(path))
+            {
+                for (int id = 1; id <= 3000; id += 97) reader.fetch(id, strings); // must not crash
+            }
+        }
+    }
+}
+
+int main()
+{
+    const std::string dir = test_support::scratch_dir("compressed");
+    check_lz();
+    check_snapshot(dir);
+    check_damaged_snapshot(dir);
+    std::filesystem::remove_all(dir);
+    return test_support::finish();
+}
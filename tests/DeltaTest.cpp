@@ -0,0 +1,249 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "persistence/DeltaSegments.hpp"
+#include "persistence/ProfileSerializer.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+// Delta saves (DeltaSegments): round trips in every base format through load(), load_parallel() and
+// open_lazy(), a delta cut anywhere (torn appends), damaged deltas (never applied in part), a delta
+// left over for a same-size base that changed in the middle, and merge.
+
+namespace
+{
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    // Creates, edits and removes a few profiles
+    void edit(ProfileStore& store, std::mt19937& rng)
+    {
+        for (int i = 0; i < 5; ++i) store.create_profile(store_dump::awkward_text(rng), 30, "Oslo", "Norway");
+        for (int i = 0; i < 5; ++i)
+        {
+            if (Profile* p = store.find(1 + static_cast<int>(rng() % 400)))
+            {
+                p->set_name(store_dump::awkward_text(rng));
+                p->add_hobby(store_dump::awkward_text(rng));
+            }
+        }
+        for (int i = 0; i < 5; ++i) store.remove(1 + static_cast<int>(rng() % 400));
+    }
+
+    std::string load_dump(const std::string& path, LoadStats* stats = nullptr)
+    {
+        ProfileStore store;
+        if (!ProfileSerializer::load(store, path, stats)) return "load failed";
+        return store_dump::dump(store);
+    }
+
+    // A base plus two segments. states[i] is the store after i segments, ends[i] the delta size then.
+    struct Fixture
+    {
+        std::string states[3];
+        std::uint64_t ends[3] = {0, 0, 0};
+    };
+
+    Fixture build(const std::string& path, SnapshotFormat format, unsigned seed)
+    {
+        Fixture fixture;
+        std::mt19937 rng(seed);
+        ProfileStore store;
+        store_dump::fill(store, 400, seed);
+        CHECK(ProfileSerializer::save(store, path, format));
+        store.mark_clean(path);
+        fixture.states[0] = store_dump::dump(store);
+
+        for (int segment = 1; segment <= 2; ++segment)
+        {
+            edit(store, rng);
+            DeltaStats stats;
+            CHECK(ProfileSerializer::save_delta(store, path, &stats));
+            CHECK(!stats.full_save && stats.written > 0 && stats.deleted > 0);
+            fixture.states[segment] = store_dump::dump(store);
+            fixture.ends[segment] = std::filesystem::file_size(DeltaSegments::path_for(path));
+        }
+        return fixture;
+    }
+
+    void check_round_trip(const std::string& dir)
+    {
+        const struct { const char* name; SnapshotFormat format; } bases[] = {
+            {"/base.txt", SnapshotFormat::Text}, {"/base.pmb", SnapshotFormat::Binary},
+            {"/base.pmz", SnapshotFormat::Compressed}};
+        for (const auto& base : bases)
+        {
+            const std::string path = dir + base.name;
+            const Fixture fixture = build(path, base.format, 1);
+            CHECK(fixture.states[2] != fixture.states[0]);
+
+            LoadStats stats;
+            CHECK_MSG(load_dump(path, &stats) == fixture.states[2], base.name);
+            CHECK(!stats.delta_ignored);
+            ProfileStore parallel;
+            ProfileStore lazy;
+            CHECK(ProfileSerializer::load_parallel(parallel, path, 4));
+            CHECK(ProfileSerializer::open_lazy(lazy, path));
+            CHECK(store_dump::dump(parallel) == fixture.states[2]);
+            CHECK(store_dump::dump(lazy) == fixture.states[2]);
+
+            // A store without changes writes nothing; a full save drops the delta
+            DeltaStats stats_after;
+            CHECK(ProfileSerializer::save_delta(parallel, path, &stats_after) && stats_after.written == 0);
+            CHECK(ProfileSerializer::save(parallel, path, base.format));
+            CHECK(!std::filesystem::exists(DeltaSegments::path_for(path)));
+            CHECK(load_dump(path) == fixture.states[2]);
+        }
+    }
+
+    // Cut anywhere, the delta applies exactly its complete segments, and the next append continues
+    // cleanly after them
+    void check_torn(const std::string& dir)
+    {
+        const std::string path = dir + "/torn.txt";
+        const std::string delta_path = DeltaSegments::path_for(path);
+        const Fixture fixture = build(path, SnapshotFormat::Text, 2);
+        const std::string delta = read_file(delta_path);
+        const std::size_t header = delta.find('\n') + 1;
+
+        for (std::size_t cut = header; cut < delta.size(); ++cut)
+        {
+            write_file(delta_path, delta.substr(0, cut));
+            const std::string& expected = fixture.states[cut >= fixture.ends[2] ? 2 : cut >= fixture.ends[1] ? 1 : 0];
+            LoadStats stats;
+            CHECK_MSG(load_dump(path, &stats) == expected && !stats.delta_ignored, "cut at " << cut);
+        }
+
+        // Torn inside the second segment: appending again replaces the torn bytes
+        write_file(delta_path, delta.substr(0, (fixture.ends[1] + fixture.ends[2]) / 2));
+        ProfileStore store;
+        CHECK(ProfileSerializer::load(store, path));
+        CHECK(store_dump::dump(store) == fixture.states[1]);
+        store.create_profile("after the tear", 1, "c", "d");
+        CHECK(ProfileSerializer::save_delta(store, path));
+        CHECK(load_dump(path) == store_dump::dump(store));
+    }
+
+    // A complete line that is malformed: nothing of the delta is applied, and it is not touched
+    void check_damaged(const std::string& dir)
+    {
+        const std::string path = dir + "/damaged.txt";
+        const std::string delta_path = DeltaSegments::path_for(path);
+        const Fixture fixture = build(path, SnapshotFormat::Text, 3);
+        const std::string delta = read_file(delta_path);
+        const std::string base = read_file(path);
+
+        // The second line of the first segment loses its "D\t"/"U\t" prefix
+        std::string damaged = delta;
+        const std::size_t second_line = damaged.find('\n', damaged.find("\nS\t") + 1) + 1;
+        damaged[second_line] = 'X';
+        write_file(delta_path, damaged);
+
+        for (bool parallel : {false, true})
+        {
+            ProfileStore store;
+            store.create_profile("replaced by the load", 1, "c", "d");
+            LoadStats stats;
+            CHECK(parallel ? ProfileSerializer::load_parallel(store, path, 4, &stats)
+                           : ProfileSerializer::load(store, path, &stats));
+            CHECK(stats.delta_ignored);
+            CHECK(store_dump::dump(store) == fixture.states[0]);
+
+            // Appending to it or folding it in would lose the segments it holds, so both refuse
+            store.create_profile("new", 1, "c", "d");
+            CHECK(!ProfileSerializer::save_delta(store, path));
+        }
+        CHECK(!ProfileSerializer::merge(path));
+        CHECK(read_file(delta_path) == damaged);
+        CHECK(read_file(path) == base);
+
+        // Random single-byte damage: whenever the delta is rejected, the base alone is loaded
+        std::mt19937 rng(7);
+        for (int round = 0; round < 300; ++round)
+        {
+            std::string flipped = delta;
+            const std::size_t at = delta.find('\n') + 1 + rng() % (delta.size() - delta.find('\n') - 1);
+            flipped[at] = static_cast<char>(flipped[at] ^ (1 + rng() % 255));
+            write_file(delta_path, flipped);
+
+            LoadStats stats;
+            const std::string loaded = load_dump(path, &stats);
+            if (stats.delta_ignored) CHECK_MSG(loaded == fixture.states[0], "byte " << at);
+        }
+    }
+
+    // The base is rewritten with the same size (and mtime), changed only in the middle: the delta
+    // belongs to another file and is dropped
+    void check_stale(const std::string& dir)
+    {
+        const std::string path = dir + "/stale.txt";
+        ProfileStore store;
+        store_dump::fill(store, 20000, 4); // well over the first and last 64 KiB
+        CHECK(ProfileSerializer::save(store, path));
+        store.mark_clean(path);
+        std::mt19937 rng(5);
+        edit(store, rng);
+        DeltaStats delta_stats;
+        CHECK(ProfileSerializer::save_delta(store, path, &delta_stats) && !delta_stats.full_save);
+
+        std::string base = read_file(path);
+        const std::size_t middle = base.find("Norway", base.size() / 2);
+        base.replace(middle, 6, "Sweden");
+        const auto mtime = std::filesystem::last_write_time(path);
+        write_file(path, base);
+        std::filesystem::last_write_time(path, mtime);
+
+        LoadStats stats;
+        const std::string loaded = load_dump(path, &stats);
+        CHECK(!stats.delta_ignored);
+        CHECK(!std::filesystem::exists(DeltaSegments::path_for(path)));
+        ProfileStore plain;
+        CHECK(ProfileSerializer::load(plain, path)); // the base alone, now that the delta is gone
+        CHECK(plain.find(1) && plain.size() == 20000);
+        CHECK(loaded == store_dump::dump(plain));
+        CHECK(loaded != store_dump::dump(store));
+    }
+
+    void check_merge(const std::string& dir)
+    {
+        const std::string path = dir + "/merge.pmb";
+        const Fixture fixture = build(path, SnapshotFormat::Binary, 6);
+
+        CHECK(ProfileSerializer::merge(path));
+        CHECK(!std::filesystem::exists(DeltaSegments::path_for(path)));
+        CHECK(!std::filesystem::exists(path + ".tmp"));
+        CHECK(read_file(path).compare(0, 6, "PMCLI2") == 0); // kept its format
+        CHECK(load_dump(path) == fixture.states[2]);
+
+        // Nothing to fold is fine; a missing base is not
+        CHECK(ProfileSerializer::merge(path));
+        CHECK(load_dump(path) == fixture.states[2]);
+        CHECK(!ProfileSerializer::merge(dir + "/missing.txt"));
+    }
+}
+
+int main()
+{
+    const std::string dir = test_support::scratch_dir("delta");
+    check_round_trip(dir);
+    check_torn(dir);
+    check_damaged(dir);
+    check_stale(dir);
+    check_merge(dir);
+    std::filesystem::remove_all(dir);
+    return test_support::finish();
+}
@@ -0,0 +1,89 @@
+#include "TestSupport.hpp"
+#include "domain/HobbyList.hpp"
+#include "util/Arena.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// HobbyList against a plain std::vector under random adds/removes, across the inline, heap and
+// hashed sizes, in unique and non-unique mode, with copies, moves and arena re-homing in between.
+
+namespace
+{
+    using Handle = HobbyList::Handle;
+
+    bool same(const HobbyList& list, const std::vector<Handle>& reference)
+    {
+        return list.size() == reference.size() && std::equal(list.begin(), list.end(), reference.begin());
+    }
+
+    bool reference_add(std::vector<Handle>& reference, Handle hobby, bool unique)
+    {
+        if (unique && std::find(reference.begin(), reference.end(), hobby) != reference.end()) return false;
+        reference.push_back(hobby);
+        return true;
+    }
+
+    bool reference_remove(std::vector<Handle>& reference, Handle hobby)
+    {
+        auto it = std::find(reference.begin(), reference.end(), hobby);
+        if (it == reference.end()) return false;
+        reference.erase(it);
+        return true;
+    }
+
+    void check_random_ops(bool unique, std::uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        Arena arena;
+        HobbyList list;
+        list.set_unique(unique);
+        std::vector<Handle> reference;
+
+        for (int op = 0; op < 20000; ++op)
+        {
+            // Few distinct hobbies early on (duplicates), more once the list is large (hashed path)
+            const Handle hobby = static_cast<Handle>(rng() % (reference.size() < 8 ? 6 : 60));
+            switch (rng() % 10)
+            {
+                case 0: case 1: case 2: case 3:
+                    CHECK(list.add(hobby) == reference_add(reference, hobby, unique));
+                    break;
+                case 4: case 5: case 6:
+                    CHECK(list.remove(hobby) == reference_remove(reference, hobby));
+                    break;
+                case 7:
+                    CHECK(list.contains(hobby) ==
+                          (std::find(reference.begin(), reference.end(), hobby) != reference.end()));
+                    break;
+                case 8:
+                {
+                    // Copies go to the global heap, moves keep the buffers
+                    HobbyList copy(list);
+                    CHECK(same(copy, reference));
+                    HobbyList moved(std::move(copy));
+                    CHECK(same(moved, reference));
+                    list = moved;
+                    break;
+                }
+                default:
+                    list.set_arena(rng() % 2 ? &arena : nullptr);
+                    break;
+            }
+            CHECK_MSG(same(list, reference), "op " << op << " size " << reference.size());
+            if (test_support::failures() > 20) return;
+        }
+        list.set_arena(nullptr);
+    }
+}
+
+int main()
+{
+    for (std::uint32_t seed = 1; seed <= 4; ++seed)
+    {
+        check_random_ops(false, seed);
+        check_random_ops(true, seed);
+    }
+    return test_support::finish();
+}
@@ -0,0 +1,179 @@
+#include "TestSupport.hpp"
+#include "service/ProfileStore.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ProfileIndex (ids_in_city/country, ids_with_hobby, ids_by_age, count_by_age) against a brute-force
+// filter over the store while profiles are edited, removed, created and re-inserted under old ids, so
+// changes are logged on the lists and merged by the queries; then the same queries from several threads
+// at once on lists with pending changes.
+
+namespace
+{
+    const char* const cities[] = {"Oslo", "Bergen", "Paris", "Lyon", "Rome", "Turin"};
+    const char* const countries[] = {"Norway", "France", "Italy"};
+    const char* const hobbies[] = {"chess", "golf", "piano", "running", "sailing"};
+
+    std::vector<int> ids_of(const IdRange& range)
+    {
+        return std::vector<int>(range.begin(), range.end());
+    }
+
+    template <typename Pred>
+    std::vector<int> brute_force(const ProfileStore& store, Pred&& pred)
+    {
+        std::vector<int> ids;
+        store.for_each_ordered([&](const Profile& p)
+        {
+            if (pred(p)) ids.push_back(p.id());
+        });
+        return ids;
+    }
+
+    bool has(const Profile& p, const std::string& hobby)
+    {
+        const auto list = p.hobbies();
+        return std::find(list.begin(), list.end(), hobby) != list.end();
+    }
+
+    std::vector<int> ages_of(const ProfileStore& store, int min_age, int max_age)
+    {
+        std::vector<int> ids;
+        for (const IdRange& range : store.ids_by_age(min_age, max_age))
+        {
+            CHECK(!range.empty());
+            ids.insert(ids.end(), range.begin(), range.end());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    void edit(ProfileStore& store, std::mt19937& rng, std::vector<int>& removed)
+    {
+        const int id = 1 + static_cast<int>(rng() % 3000);
+        Profile* p = store.find(id);
+        switch (rng() % 8)
+        {
+            case 0: if (p) p->set_age(static_cast<int>(rng() % 40)); break;
+            case 1: if (p) p->set_city(cities[rng() % 6]); break;
+            case 2: if (p) p->set_country(countries[rng() % 3]); break;
+            case 3: if (p) p->add_hobby(hobbies[rng() % 5]); break;
+            case 4: if (p) p->remove_hobby(hobbies[rng() % 5]); break;
+            case 5:
+                if (store.remove(id)) removed.push_back(id);
+                break;
+            case 6:
+                store.create_profile("new", static_cast<int>(rng() % 40), cities[rng() % 6], countries[rng() % 3]);
+                break;
+            default:
+                // An old id comes back: its index entries land in the middle of the lists
+                if (!removed.empty())
+                {
+                    const int old = removed[rng() % removed.size()];
+                    Profile back(old, "back", static_cast<int>(rng() % 40), cities[rng() % 6], countries[rng() % 3],
+                                 store.strings());
+                    back.add_hobby(hobbies[rng() % 5]);
+                    store.insert_profile(std::move(back));
+                }
+                break;
+        }
+    }
+
+    void check_edits()
+    {
+        std::mt19937 rng(3);
+        ProfileStore store;
+        for (int i = 0; i < 3000; ++i)
+        {
+            const int id = store.create_profile("p", static_cast<int>(rng() % 40), cities[rng() % 6],
+                                                countries[rng() % 3]);
+            for (std::size_t h = rng() % 3; h > 0; --h) store.find(id)->add_hobby(hobbies[rng() % 5]);
+        }
+
+        std::vector<int> removed;
+        for (int round = 0; round < 200; ++round)
+        {
+            // Some rounds make more changes than a quarter of a list, so mutators merge too
+            const int edits = round % 10 == 0 ? 2000 : static_cast<int>(rng() % 50);
+            for (int e = 0; e < edits; ++e) edit(store, rng, removed);
+
+            const std::string city = cities[rng() % 6];
+            const std::string country = countries[rng() % 3];
+            const std::string hobby = hobbies[rng() % 5];
+            const int min_age = static_cast<int>(rng() % 40);
+            const int max_age = min_age + static_cast<int>(rng() % 10);
+
+            const IdRange in_city = store.ids_in_city(city);
+            CHECK_MSG(ids_of(in_city) == brute_force(store, [&](const Profile& p) { return p.city() == city; }),
+                      "round " << round << " city " << city);
+            CHECK(ids_of(store.ids_in_country(country)) ==
+                  brute_force(store, [&](const Profile& p) { return p.country() == country; }));
+            CHECK(ids_of(store.ids_with_hobby(hobby)) == brute_force(store, [&](const Profile& p) { return has(p, hobby); }));
+
+            const std::vector<int> aged = brute_force(store, [&](const Profile& p)
+            {
+                return p.age() >= min_age && p.age() <= max_age;
+            });
+            CHECK_MSG(ages_of(store, min_age, max_age) == aged, "round " << round << " ages " << min_age << "-" << max_age);
+            CHECK(store.count_by_age(min_age, max_age) == aged.size());
+
+            // Reading other lists does not move the ids of a range handed out before
+            CHECK(ids_of(in_city) == ids_of(store.ids_in_city(city)));
+        }
+        CHECK(store.ids_in_city("Nowhere").empty());
+        CHECK(store.ids_by_age(50, 10).empty());
+    }
+
+    // Const queries from several threads, each list with changes still pending
+    void check_concurrent_queries()
+    {
+        std::mt19937 rng(4);
+        ProfileStore store;
+        for (int i = 0; i < 20000; ++i)
+        {
+            store.create_profile("p", static_cast<int>(rng() % 40), cities[rng() % 6], countries[rng() % 3]);
+        }
+        for (int i = 0; i < 500; ++i)
+        {
+            Profile* p = store.find(1 + static_cast<int>(rng() % 20000));
+            p->set_city(cities[rng() % 6]);
+            p->set_age(static_cast<int>(rng() % 40));
+        }
+
+        std::vector<std::vector<int>> expected;
+        for (const char* city : cities)
+        {
+            expected.push_back(brute_force(store, [&](const Profile& p) { return p.city() == city; }));
+        }
+        const std::size_t adults = brute_force(store, [](const Profile& p) { return p.age() >= 18; }).size();
+
+        const ProfileStore& reader = store;
+        std::vector<int> mismatches(4, 0);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < mismatches.size(); ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (std::size_t i = 0; i < 6; ++i)
+                {
+                    const std::size_t c = (i + t) % 6;
+                    if (ids_of(reader.ids_in_city(cities[c])) != expected[c]) ++mismatches[t];
+                    if (reader.count_by_age(18, 39) != adults) ++mismatches[t];
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        for (int count : mismatches) CHECK(count == 0);
+    }
+}
+
+int main()
+{
+    check_edits();
+    check_concurrent_queries();
+    return test_support::finish();
+}
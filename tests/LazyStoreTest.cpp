@@ -0,0 +1,319 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "persistence/IndexedSnapshot.hpp"
+#include "persistence/ProfileSerializer.hpp"
+#include "persistence/WriteAheadLog.hpp"
+#include "service/ProfileStoreListener.hpp"
+
+#include <algorithm> // std::lower_bound
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Lazy open (IndexedSnapshot + ProfileStore::open_lazy): the same contents as a full load, the .idx
+// sidecar rebuilt when it is damaged or belongs to another version of the snapshot (even one with the
+// same size and mtime), cursor paging over gaps, listeners on a lazy store, and concurrent const reads.
+
+namespace
+{
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    // Ids 1..count with every third one removed, so pages have gaps
+    std::vector<int> save_with_gaps(const std::string& path, std::size_t count, unsigned seed)
+    {
+        ProfileStore store;
+        store_dump::fill(store, count, seed);
+        std::vector<int> kept;
+        for (int id = 1; id <= static_cast<int>(count); ++id)
+        {
+            if (id % 3 == 0) store.remove(id);
+            else kept.push_back(id);
+        }
+        CHECK(ProfileSerializer::save(store, path));
+        return kept;
+    }
+
+    std::string full_load(const std::string& path)
+    {
+        ProfileStore store;
+        CHECK(ProfileSerializer::load(store, path));
+        return store_dump::dump(store);
+    }
+
+    // Opens lazily, looks a few records up one by one, then compares everything with a full load
+    bool lazy_matches(const std::string& path, const std::vector<int>& ids)
+    {
+        ProfileStore full;
+        ProfileSerializer::load(full, path);
+
+        ProfileStore lazy;
+        if (!ProfileSerializer::open_lazy(lazy, path) || lazy.size() != full.size()) return false;
+        for (std::size_t i = 0; i < ids.size(); i += 17)
+        {
+            const Profile* p = lazy.find(ids[i]);
+            if (!p || store_dump::dump(*p) != store_dump::dump(*full.find(ids[i]))) return false;
+        }
+        if (lazy.find(3) || lazy.find(0) || lazy.find(INT_MAX)) return false;
+        return store_dump::dump(lazy) == store_dump::dump(full);
+    }
+
+    void check_open(const std::string& dir)
+    {
+        const std::string path = dir + "/open.txt";
+        const std::vector<int> ids = save_with_gaps(path, 3000, 1);
+
+        IndexedSnapshot first;
+        CHECK(first.open(path) && first.index_rebuilt());
+        CHECK(first.size() == ids.size() && first.max_id() == ids.back());
+        IndexedSnapshot second;
+        CHECK(second.open(path) && !second.index_rebuilt()); // the sidecar written by the first open
+        CHECK(lazy_matches(path, ids));
+
+        ProfileStore store;
+        CHECK(ProfileSerializer::open_lazy(store, path));
+        CHECK(store.lazy());
+        CHECK(store.create_profile("new", 1, "c", "d") == ids.back() + 1);
+        CHECK(store.remove(ids[5]) && !store.find(ids[5]) && !store.remove(ids[5]));
+        CHECK(store.size() == ids.size());
+    }
+
+    // A snapshot rewritten in place with the same size and mtime: records are reordered, so every
+    // offset in the old sidecar is wrong
+    void check_stale_sidecar(const std::string& dir)
+    {
+        const std::string path = dir + "/stale.txt";
+        const std::vector<int> ids = save_with_gaps(path, 2000, 2);
+        IndexedSnapshot built;
+        CHECK(built.open(path));
+
+        const std::string bytes = read_file(path);
+        const std::size_t body = bytes.find('\n') + 1;
+        std::vector<std::string> lines;
+        for (std::size_t pos = body; pos < bytes.size();)
+        {
+            const std::size_t eol = bytes.find('\n', pos);
+            lines.push_back(bytes.substr(pos, eol + 1 - pos));
+            pos = eol + 1;
+        }
+        std::string reordered = bytes.substr(0, body);
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) reordered += *it;
+        CHECK(reordered.size() == bytes.size() && reordered != bytes);
+
+        const auto mtime = std::filesystem::last_write_time(path);
+        write_file(path, reordered);
+        std::filesystem::last_write_time(path, mtime);
+
+        IndexedSnapshot reopened;
+        CHECK(reopened.open(path) && reopened.index_rebuilt());
+        CHECK(lazy_matches(path, ids));
+    }
+
+    // Every truncation and a flipped byte anywhere in the sidecar: it is rebuilt, never trusted
+    void check_damaged_sidecar(const std::string& dir)
+    {
+        const std::string path = dir + "/damaged.txt";
+        const std::vector<int> ids = save_with_gaps(path, 200, 3);
+        IndexedSnapshot built;
+        CHECK(built.open(path));
+        const std::string index_path = IndexedSnapshot::index_path(path);
+        const std::string index = read_file(index_path);
+        const std::string expected = full_load(path);
+
+        std::mt19937 rng(4);
+        for (std::size_t at = 0; at < index.size(); ++at)
+        {
+            std::string damaged = index;
+            if (at % 2) damaged.resize(at);
+            else damaged[at] = static_cast<char>(damaged[at] ^ (1 + rng() % 255));
+            write_file(index_path, damaged);
+
+            IndexedSnapshot snapshot;
+            CHECK_MSG(snapshot.open(path) && snapshot.index_rebuilt(), "damaged at " << at);
+            ProfileStore store;
+            CHECK(ProfileSerializer::open_lazy(store, path));
+            CHECK_MSG(store_dump::dump(store) == expected, "damaged at " << at);
+        }
+
+        // A truncated snapshot is still opened (its complete lines count), with a fresh index
+        const std::string bytes = read_file(path);
+        write_file(path, bytes.substr(0, bytes.size() / 2));
+        CHECK(lazy_matches(path, {}));
+        write_file(path, "PMCLI9\n");
+        ProfileStore store;
+        CHECK(!ProfileSerializer::open_lazy(store, path));
+    }
+
+    // for_each_from/id_before on a lazy and an eager store against the id list
+    void check_paging(const std::string& dir)
+    {
+        const std::string path = dir + "/paging.txt";
+        const std::vector<int> ids = save_with_gaps(path, 100, 5);
+
+        ProfileStore empty;
+        CHECK(empty.for_each_from(INT_MIN, 10, [](const Profile&) {}) == 0);
+        CHECK(empty.id_before(7, 3) == 7);
+
+        for (bool lazy : {true, false})
+        {
+            ProfileStore store;
+            CHECK(lazy ? ProfileSerializer::open_lazy(store, path) : ProfileSerializer::load(store, path));
+            for (int first : {INT_MIN, 0, 1, 2, 3, 50, 51, ids.back(), ids.back() + 1, INT_MAX})
+            {
+                for (std::size_t limit : {std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(1000)})
+                {
+                    std::vector<int> expected;
+                    for (int id : ids)
+                    {
+                        if (id >= first && expected.size() < limit) expected.push_back(id);
+                    }
+                    std::vector<int> visited;
+                    const std::size_t count = store.for_each_from(first, limit, [&](const Profile& p)
+                    {
+                        visited.push_back(p.id());
+                    });
+                    CHECK_MSG(visited == expected && count == expected.size(), "from " << first << " limit " << limit);
+                }
+
+                // id_before steps back from the first id >= first, stopping at the smallest id
+                const auto at = std::lower_bound(ids.begin(), ids.end(), first);
+                for (std::size_t steps : {0, 1, 6, 500})
+                {
+                    const std::size_t position = static_cast<std::size_t>(at - ids.begin());
+                    std::size_t target = position > steps ? position - steps : 0;
+                    if (target == ids.size()) target = ids.size() - 1; // past the end: the last profile
+                    CHECK_MSG(store.id_before(first, steps) == ids[target], "before " << first << " steps " << steps);
+                }
+            }
+        }
+    }
+
+    class RecordingListener : public ProfileStoreListener
+    {
+        public:
+            std::vector<int> added;
+
+            void profile_added(const Profile& profile) override { added.push_back(profile.id()); }
+            void profile_removed(const Profile&) override {}
+            void store_cleared() override { added.clear(); }
+            void profile_changed(const Profile&, ProfileField, const std::string&) override {}
+    };
+
+    void check_listeners(const std::string& dir)
+    {
+        const std::string path = dir + "/listeners.txt";
+        const std::vector<int> ids = save_with_gaps(path, 500, 6);
+        const std::string expected = full_load(path);
+
+        // Attached before the lazy open: hears about every record, as with load()
+        {
+            ProfileStore store;
+            RecordingListener listener;
+            store.add_listener(&listener);
+            CHECK(ProfileSerializer::open_lazy(store, path));
+            CHECK(!store.lazy());
+            CHECK(listener.added == ids);
+            store.remove_listener(&listener);
+        }
+
+        // Attached afterwards: the store is read in full first, and a log started on it describes all of it
+        const std::string log_path = dir + "/listeners.wal";
+        {
+            ProfileStore store;
+            CHECK(ProfileSerializer::open_lazy(store, path));
+            CHECK(store.lazy());
+            WriteAheadLog log;
+            CHECK(log.open(log_path, store));
+            CHECK(!store.lazy());
+            CHECK(store.find(ids[0])->set_age(99));
+            log.close();
+        }
+        ProfileStore replayed;
+        WriteAheadLog log;
+        CHECK(log.open(log_path, replayed));
+        log.close();
+        ProfileStore direct;
+        CHECK(ProfileSerializer::load(direct, path));
+        CHECK(direct.find(ids[0])->set_age(99));
+        CHECK(store_dump::dump(replayed) == store_dump::dump(direct));
+        CHECK(store_dump::dump(replayed) != expected);
+    }
+
+    // Several threads reading one lazy store through const find() at once, and the pooled text of what
+    // they found. Every record has its own city, country and hobby, so each read grows the pool while
+    // other threads are reading strings out of it.
+    void check_concurrent_reads(const std::string& dir)
+    {
+        const std::string path = dir + "/threads.txt";
+        std::vector<int> ids;
+        {
+            ProfileStore store;
+            for (int i = 0; i < 4000; ++i)
+            {
+                const std::string tag = std::to_string(i);
+                const int id = store.create_profile("name " + tag, i % 100, "city " + tag, "country " + tag);
+                store.find(id)->add_hobby("hobby " + tag);
+                ids.push_back(id);
+            }
+            CHECK(ProfileSerializer::save(store, path));
+        }
+        ProfileStore full;
+        CHECK(ProfileSerializer::load(full, path));
+
+        ProfileStore store;
+        CHECK(ProfileSerializer::open_lazy(store, path));
+        const ProfileStore& reader = store;
+
+        std::vector<int> mismatches(4, 0);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < mismatches.size(); ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                // Different starting points, so threads race for the same records in different orders
+                for (std::size_t i = 0; i < ids.size(); ++i)
+                {
+                    const int id = ids[(i + t * ids.size() / 4) % ids.size()];
+                    const Profile* p = reader.find(id);
+                    const Profile* expected = full.find(id);
+                    if (!p || store_dump::dump(*p) != store_dump::dump(*expected)) ++mismatches[t];
+                    else if (p->city() != expected->city() || p->country() != expected->country()) ++mismatches[t];
+                    if (reader.size() != ids.size()) ++mismatches[t];
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        for (int count : mismatches) CHECK(count == 0);
+        CHECK(store.strings().size() == 3 * ids.size());
+        CHECK(store_dump::dump(store) == store_dump::dump(full));
+    }
+}
+
+int main()
+{
+    const std::string dir = test_support::scratch_dir("lazy");
+    check_open(dir);
+    check_stale_sidecar(dir);
+    check_damaged_sidecar(dir);
+    check_paging(dir);
+    check_listeners(dir);
+    check_concurrent_reads(dir);
+    std::filesystem::remove_all(dir);
+    return test_support::finish();
+}
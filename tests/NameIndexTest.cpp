@@ -0,0 +1,183 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "persistence/ProfileSerializer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// ProfileStore::search_names: the ranking (Exact < Prefix < WordPrefix < Substring < Similar, then
+// similarity, shorter name, id), an index that is ready straight after a load, and a brute-force
+// comparison while names are created, renamed and removed.
+
+namespace
+{
+    std::vector<int> ids_of(const std::vector<NameMatch>& matches)
+    {
+        std::vector<int> ids;
+        for (const NameMatch& match : matches) ids.push_back(match.id);
+        return ids;
+    }
+
+    void check_ranking()
+    {
+        ProfileStore store;
+        for (const char* name : {"Anna", "Annabel", "Annabella", "Lise Anna", "Marianna", "Anne", "Ana", "Annie",
+                                 "Hanna", "Bob", "anna", "Anna-Lise", "Joanna Berg", "Anya"})
+        {
+            store.create_profile(name, 30, "Oslo", "Norway");
+        }
+
+        const std::vector<NameMatch> matches = store.search_names("anna", 20);
+        // Exact (ties by id), Prefix (most similar first: Anna-Lise shares more of its grams, then the
+        // shorter Annabel), WordPrefix, Substring (Hanna is most similar), Similar
+        CHECK(ids_of(matches) == std::vector<int>({1, 11, 12, 2, 3, 4, 9, 5, 13, 6, 8}));
+        const NameMatchKind kinds[] = {NameMatchKind::Exact, NameMatchKind::Exact, NameMatchKind::Prefix,
+                                       NameMatchKind::Prefix, NameMatchKind::Prefix, NameMatchKind::WordPrefix,
+                                       NameMatchKind::Substring, NameMatchKind::Substring, NameMatchKind::Substring,
+                                       NameMatchKind::Similar, NameMatchKind::Similar};
+        for (std::size_t i = 0; i < matches.size() && i < 11; ++i)
+        {
+            CHECK_MSG(matches[i].kind == kinds[i], "rank " << i);
+            if (i > 0 && matches[i].kind == matches[i - 1].kind)
+            {
+                CHECK(matches[i].similarity <= matches[i - 1].similarity);
+            }
+        }
+
+        // Case and surrounding punctuation do not matter; a limit keeps the best ones
+        CHECK(ids_of(store.search_names("  ANNA! ", 20)) == ids_of(matches));
+        CHECK(ids_of(store.search_names("anna", 4)) == std::vector<int>({1, 11, 12, 2}));
+        CHECK(store.search_names("anna", 0).empty());
+        CHECK(store.search_names(" - ", 10).empty());
+        // Short queries match word prefixes only (the first word ranks as a prefix)
+        CHECK(ids_of(store.search_names("li", 10)) == std::vector<int>({4, 12}));
+
+        // Edits move names in and out of the results
+        CHECK(store.find(10)->set_name("Annabelle"));
+        CHECK(store.find(1)->set_name("Bob"));
+        CHECK(store.remove(11));
+        const int created = store.create_profile("Anna", 1, "c", "d");
+        const std::vector<int> after = ids_of(store.search_names("anna", 20));
+        CHECK(!after.empty() && after.front() == created);
+        CHECK(std::find(after.begin(), after.end(), 10) != after.end());
+        CHECK(std::find(after.begin(), after.end(), 1) == after.end());
+        CHECK(std::find(after.begin(), after.end(), 11) == after.end());
+        CHECK(ids_of(store.search_names("bob", 5)) == std::vector<int>({1}));
+
+        // Indexing off: no results; on again: rebuilt
+        store.set_indexing(false);
+        CHECK(store.search_names("anna", 20).empty());
+        store.set_indexing(true);
+        CHECK(ids_of(store.search_names("anna", 20)) == after);
+    }
+
+    // The index is filled during the load, in every loader
+    void check_after_load()
+    {
+        const std::string dir = test_support::scratch_dir("names");
+        ProfileStore original;
+        store_dump::fill(original, 3000, 8);
+        original.create_profile("Marianne Dahl", 40, "Oslo", "Norway");
+        const std::string path = dir + "/names.txt";
+        CHECK(ProfileSerializer::save(original, path));
+        const std::vector<int> expected = ids_of(original.search_names("marianne", 10));
+        CHECK(expected.size() == 1);
+
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            ProfileStore store;
+            if (mode == 0) CHECK(ProfileSerializer::load(store, path));
+            if (mode == 1) CHECK(ProfileSerializer::load_parallel(store, path, 4));
+            if (mode == 2) CHECK(ProfileSerializer::open_lazy(store, path));
+            CHECK_MSG(ids_of(store.search_names("marianne", 10)) == expected, "mode " << mode);
+            CHECK(ids_of(store.search_names("oslo", 3000)) == ids_of(original.search_names("oslo", 3000)));
+        }
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string lower(std::string s)
+    {
+        for (char& ch : s) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        return s;
+    }
+
+    // One to three words of a few syllables each, separated by ' ' or '-'
+    std::string random_name(std::mt19937& rng)
+    {
+        static const char* const syllables[] = {"an", "na", "ma", "ri", "el", "li", "jo", "Ha", "Be", "rg"};
+        std::string name;
+        for (std::size_t words = 1 + rng() % 3; words > 0; --words)
+        {
+            if (!name.empty()) name += rng() % 2 ? " " : "-";
+            for (std::size_t n = 1 + rng() % 3; n > 0; --n) name += syllables[rng() % 10];
+        }
+        return name;
+    }
+
+    // Queries are pieces of stored names. Every name containing the query must come back as a
+    // non-Similar match (with a limit above the store size), and nothing else may. The renames and
+    // removals between searches are enough for the index to compact its slots more than once.
+    void check_random()
+    {
+        std::mt19937 rng(21);
+        ProfileStore store;
+        for (int i = 0; i < 2000; ++i) store.create_profile(random_name(rng), 1, "c", "d");
+
+        for (int round = 0; round < 300; ++round)
+        {
+            // Edits between searches
+            for (int edit = 0; edit < 20; ++edit)
+            {
+                const int id = 1 + static_cast<int>(rng() % (2000 + round * 20));
+                switch (rng() % 3)
+                {
+                    case 0: store.create_profile(random_name(rng), 1, "c", "d"); break;
+                    case 1: if (Profile* p = store.find(id)) p->set_name(random_name(rng)); break;
+                    default: store.remove(id); break;
+                }
+            }
+
+            // A 3 to 6 letter piece of a random word of some stored name
+            std::string query;
+            while (query.size() < 3)
+            {
+                const Profile* p = store.find(1 + static_cast<int>(rng() % 2000));
+                if (!p) continue;
+                const std::string name = p->name_string();
+                const std::size_t start = rng() % name.size();
+                query = name.substr(start, 3 + rng() % 4);
+                query = query.substr(0, query.find_first_of(" -"));
+            }
+
+            std::set<int> expected;
+            store.for_each([&](const Profile& p)
+            {
+                if (lower(p.name_string()).find(lower(query)) != std::string::npos) expected.insert(p.id());
+            });
+
+            std::set<int> found;
+            NameMatchKind previous = NameMatchKind::Exact;
+            bool ordered = true;
+            for (const NameMatch& match : store.search_names(query, store.size() + 1))
+            {
+                ordered = ordered && match.kind >= previous;
+                previous = match.kind;
+                if (match.kind != NameMatchKind::Similar) found.insert(match.id);
+            }
+            CHECK_MSG(found == expected && ordered, "round " << round << " query " << query);
+        }
+    }
+}
+
+int main()
+{
+    check_ranking();
+    check_after_load();
+    check_random();
+    return test_support::finish();
+}
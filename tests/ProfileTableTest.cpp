@@ -0,0 +1,127 @@
+#include "TestSupport.hpp"
+#include "domain/StringPool.hpp"
+#include "service/ProfileTable.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+// ProfileTable against a std::map keyed like the table (ids as uint32, so negative ids come last):
+// dense ids, far-away and negative ids (sparse pages), erasing pages empty, and page migration when
+// the directory grows over pages that started out sparse.
+
+namespace
+{
+    using Reference = std::map<std::uint32_t, int>; // key -> age
+
+    bool same(const ProfileTable& table, const Reference& reference)
+    {
+        if (table.size() != reference.size()) return false;
+        auto expected = reference.begin();
+        bool ok = true;
+        table.for_each([&](const Profile& p)
+        {
+            if (expected == reference.end() || static_cast<std::uint32_t>(p.id()) != expected->first ||
+                p.age() != expected->second) ok = false;
+            else ++expected;
+        });
+        return ok && expected == reference.end();
+    }
+
+    void insert(ProfileTable& table, Reference& reference, StringPool& strings, int id, int age)
+    {
+        const bool fresh = reference.emplace(static_cast<std::uint32_t>(id), age).second;
+        CHECK(table.emplace(Profile(id, "n", age, "c", "d", strings)).second == fresh);
+    }
+
+    void check_outliers()
+    {
+        StringPool strings;
+        ProfileTable table;
+        Reference reference;
+        for (int id : {-1, INT_MAX, INT_MIN, 0, 5, -1024, 1 << 30})
+        {
+            insert(table, reference, strings, id, 1);
+        }
+        CHECK(same(table, reference));
+        // One page per outlier rather than a directory spanning the int range
+        CHECK(table.page_count() < 16);
+
+        for (int id : {-1, INT_MAX, INT_MIN})
+        {
+            CHECK(table.find(id) != nullptr && table.find(id)->id() == id);
+            CHECK(table.erase(id));
+            CHECK(table.find(id) == nullptr);
+            reference.erase(static_cast<std::uint32_t>(id));
+        }
+        CHECK(!table.erase(-1));
+        CHECK(same(table, reference));
+    }
+
+    // Ids starting far from 0: pages begin sparse and move into the directory once it is dense enough
+    void check_migration()
+    {
+        StringPool strings;
+        ProfileTable table;
+        Reference reference;
+        const int base = 3000 * static_cast<int>(ProfileTable::page_size);
+        for (int i = 0; i < 4000 * static_cast<int>(ProfileTable::page_size); i += 7)
+        {
+            insert(table, reference, strings, base + i, i % 100);
+        }
+        CHECK(same(table, reference));
+        for (int i = 0; i < 4000 * static_cast<int>(ProfileTable::page_size); i += 7 * 13)
+        {
+            const Profile* p = table.find(base + i);
+            CHECK(p && p->age() == i % 100);
+        }
+        // Parallel scans split on pages: every page visited exactly once
+        std::size_t visited = 0;
+        const std::size_t pages = table.page_count();
+        for (std::size_t first = 0; first < pages; first += 37)
+        {
+            table.for_each_in_pages(first, first + 37, [&](const Profile&) { ++visited; });
+        }
+        CHECK(visited == table.size());
+    }
+
+    void check_random(std::uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        StringPool strings;
+        ProfileTable table;
+        Reference reference;
+        for (int op = 0; op < 30000; ++op)
+        {
+            int id;
+            switch (rng() % 4)
+            {
+                case 0: id = static_cast<int>(rng()); break;             // anywhere in the int range
+                case 1: id = -static_cast<int>(rng() % 5000); break;     // near zero, negative
+                default: id = static_cast<int>(rng() % 20000); break;    // dense
+            }
+            if (rng() % 3 == 0)
+            {
+                const bool present = reference.erase(static_cast<std::uint32_t>(id)) > 0;
+                CHECK(table.erase(id) == present);
+            }
+            else
+            {
+                insert(table, reference, strings, id, static_cast<int>(rng() % 100));
+            }
+        }
+        CHECK(same(table, reference));
+        table.clear();
+        CHECK(table.size() == 0 && table.page_count() == 0);
+    }
+}
+
+int main()
+{
+    check_outliers();
+    check_migration();
+    for (std::uint32_t seed = 1; seed <= 3; ++seed) check_random(seed);
+    return test_support::finish();
+}
@@ -0,0 +1,98 @@
+#include "TestSupport.hpp"
+#include "service/ProfileStore.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// ProfileQueryEngine against a brute-force filter over the store, sequential and on several threads.
+// The store is large enough to take the parallel path and has gaps from removed profiles.
+
+namespace
+{
+    const char* const cities[] = {"Oslo", "Bergen", "Paris", "Lyon", "Rome"};
+    const char* const countries[] = {"Norway", "France", "Italy"};
+    const char* const hobbies[] = {"chess", "golf", "piano", "running"};
+    const char* const names[] = {"Anna", "Annabel", "Bob", "Bobby", "Carl"};
+
+    bool matches(const Profile& p, const ProfileQuery& q)
+    {
+        if (p.age() < q.min_age || p.age() > q.max_age) return false;
+        if (!q.city.empty() && p.city() != q.city) return false;
+        if (!q.country.empty() && p.country() != q.country) return false;
+        if (!q.name_prefix.empty() && p.name().substr(0, q.name_prefix.size()) != q.name_prefix) return false;
+        if (!q.hobby.empty())
+        {
+            const auto list = p.hobbies();
+            if (std::find(list.begin(), list.end(), q.hobby) == list.end()) return false;
+        }
+        return true;
+    }
+
+    ProfileQuery random_query(std::mt19937& rng)
+    {
+        ProfileQuery q;
+        if (rng() % 2) q.min_age = static_cast<int>(rng() % 60);
+        if (rng() % 2) q.max_age = static_cast<int>(rng() % 90);
+        if (rng() % 3 == 0) q.city = cities[rng() % 5];
+        if (rng() % 3 == 0) q.country = rng() % 4 ? countries[rng() % 3] : "Nowhere";
+        if (rng() % 3 == 0) q.name_prefix = std::string(names[rng() % 5]).substr(0, 1 + rng() % 4);
+        if (rng() % 3 == 0) q.hobby = hobbies[rng() % 4];
+        return q;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(11);
+    ProfileStore store;
+    for (int i = 0; i < 70000; ++i)
+    {
+        const int id = store.create_profile(names[rng() % 5], static_cast<int>(rng() % 90), cities[rng() % 5],
+                                            countries[rng() % 3]);
+        Profile* p = store.find(id);
+        for (std::size_t h = rng() % 3; h > 0; --h) p->add_hobby(hobbies[rng() % 4]);
+    }
+    for (int i = 0; i < 10000; ++i) store.remove(1 + static_cast<int>(rng() % 70000));
+
+    for (int round = 0; round < 40; ++round)
+    {
+        const ProfileQuery q = random_query(rng);
+
+        std::vector<int> expected;
+        std::map<std::string, std::size_t> per_country;
+        store.for_each_ordered([&](const Profile& p)
+        {
+            if (!matches(p, q)) return;
+            expected.push_back(p.id());
+            ++per_country[p.country()];
+        });
+
+        for (unsigned threads : {1u, 4u})
+        {
+            CHECK_MSG(store.query_ids(q, threads) == expected, "round " << round << " threads " << threads);
+            CHECK(store.query_count(q, threads) == expected.size());
+
+            const std::vector<QueryRow> rows = store.query(q, query_fields::id | query_fields::name, threads);
+            bool rows_ok = rows.size() == expected.size();
+            for (std::size_t i = 0; rows_ok && i < rows.size(); ++i)
+            {
+                rows_ok = rows[i].id == expected[i] && rows[i].name == store.find(rows[i].id)->name() &&
+                          rows[i].city.empty();
+            }
+            CHECK_MSG(rows_ok, "rows, round " << round);
+
+            std::size_t grouped = 0;
+            bool groups_ok = true;
+            for (const CountryCount& group : store.query_count_by_country(q, threads))
+            {
+                groups_ok = groups_ok && per_country[group.country] == group.profiles;
+                grouped += group.profiles;
+            }
+            CHECK_MSG(groups_ok && grouped == expected.size(), "groups, round " << round);
+        }
+    }
+    return test_support::finish();
+}
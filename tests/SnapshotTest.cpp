@@ -0,0 +1,175 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "persistence/ProfileSerializer.hpp"
+
+#include <algorithm> // std::count
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Text (PMCLI1) and binary (PMCLI2) snapshots: save/load round trips through load() and
+// load_parallel(), first-occurrence-wins for duplicate ids, malformed lines, and truncated or
+// corrupted files (a binary file that fails validation leaves the store untouched).
+
+namespace
+{
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    void check_round_trip(const ProfileStore& original, const std::string& path, SnapshotFormat format)
+    {
+        const std::string expected = store_dump::dump(original);
+        CHECK(ProfileSerializer::save(original, path, format));
+
+        ProfileStore sequential;
+        LoadStats stats;
+        CHECK(ProfileSerializer::load(sequential, path, &stats));
+        CHECK(store_dump::dump(sequential) == expected);
+        CHECK(stats.profiles == original.size());
+        // Ids handed out after a load continue after the highest loaded id
+        CHECK(sequential.create_profile("next", 1, "c", "d") == static_cast<int>(original.size()) + 1);
+
+        ProfileStore parallel;
+        CHECK(ProfileSerializer::load_parallel(parallel, path, 4));
+        CHECK(store_dump::dump(parallel) == expected);
+    }
+
+    void check_text_rules(const std::string& dir)
+    {
+        const std::string path = dir + "/rules.txt";
+        write_file(path, "PMCLI1\n"
+                         "1\t20\tAnna\tOslo\tNorway\tchess|golf\n"
+                         "1\t30\tDuplicate\tOslo\tNorway\t\n"
+                         "not a record\n"
+                         "\n"
+                         "2\tx\tBad age\tOslo\tNorway\t\n"
+                         "3\t40\tCarl\tRome\tItaly\tpiano\\|flute|\r\n"
+                         "4\t50\tDora\tLyon\n");
+        for (bool parallel : {false, true})
+        {
+            ProfileStore store;
+            CHECK(parallel ? ProfileSerializer::load_parallel(store, path, 4) : ProfileSerializer::load(store, path));
+            CHECK(store.size() == 2);
+            CHECK(store.find(1) && store.find(1)->name() == "Anna" && store.find(1)->hobbies().size() == 2);
+            CHECK(store.find(3) && store.find(3)->hobbies().size() == 1 && store.find(3)->hobbies()[0] == "piano|flute");
+        }
+
+        write_file(path, "PMCLI9\n1\t20\tAnna\tOslo\tNorway\t\n");
+        ProfileStore store;
+        CHECK(!ProfileSerializer::load(store, path));
+        CHECK(!ProfileSerializer::load(store, dir + "/missing.txt"));
+    }
+
+    // Duplicates far apart land in different parallel chunks; the earlier one still wins
+    void check_parallel_duplicates(const ProfileStore& original, const std::string& dir)
+    {
+        const std::string path = dir + "/dups.txt";
+        CHECK(ProfileSerializer::save(original, path));
+        write_file(path, read_file(path) + "5\t99\tLate duplicate\tOslo\tNorway\t\n");
+
+        ProfileStore sequential;
+        ProfileStore parallel;
+        CHECK(ProfileSerializer::load(sequential, path));
+        CHECK(ProfileSerializer::load_parallel(parallel, path, 4));
+        CHECK(store_dump::dump(sequential) == store_dump::dump(original));
+        CHECK(store_dump::dump(parallel) == store_dump::dump(original));
+    }
+
+    // A text file cut anywhere loads every complete line unchanged (the cut line may come back shortened)
+    void check_truncated_text(const std::string& dir)
+    {
+        ProfileStore original;
+        store_dump::fill(original, 50, 3);
+        const std::string path = dir + "/cut.txt";
+        CHECK(ProfileSerializer::save(original, path));
+        const std::string bytes = read_file(path);
+
+        for (std::size_t cut = 0; cut < bytes.size(); cut += 7)
+        {
+            write_file(path, bytes.substr(0, cut));
+            ProfileStore store;
+            if (!ProfileSerializer::load(store, path))
+            {
+                CHECK(cut < 7); // only a missing header fails
+                continue;
+            }
+            const std::string kept = bytes.substr(0, cut);
+            const std::size_t complete_lines = static_cast<std::size_t>(std::count(kept.begin(), kept.end(), '\n'));
+            bool ok = true;
+            store.for_each([&](const Profile& p)
+            {
+                if (static_cast<std::size_t>(p.id()) < complete_lines)
+                {
+                    ok = ok && store_dump::dump(p) == store_dump::dump(*original.find(p.id()));
+                }
+            });
+            CHECK_MSG(ok, "cut at " << cut);
+        }
+    }
+
+    // Every truncation and single-byte corruption of a binary file either loads or is rejected;
+    // a rejected load leaves the previous contents in place
+    void check_damaged_binary(const std::string& dir)
+    {
+        ProfileStore original;
+        store_dump::fill(original, 30, 4);
+        const std::string path = dir + "/damaged.pmb";
+        CHECK(ProfileSerializer::save(original, path, SnapshotFormat::Binary));
+        const std::string bytes = read_file(path);
+
+        ProfileStore previous;
+        previous.create_profile("keep me", 1, "c", "d");
+        const std::string before = store_dump::dump(previous);
+
+        for (std::size_t cut = 0; cut < bytes.size(); ++cut)
+        {
+            write_file(path, bytes.substr(0, cut));
+            ProfileStore store;
+            store.create_profile("keep me", 1, "c", "d");
+            CHECK_MSG(!ProfileSerializer::load(store, path), "truncated at " << cut);
+            CHECK(store_dump::dump(store) == before);
+        }
+
+        std::mt19937 rng(5);
+        for (std::size_t at = 0; at < bytes.size(); ++at)
+        {
+            std::string damaged = bytes;
+            damaged[at] = static_cast<char>(damaged[at] ^ (1 + rng() % 255));
+            write_file(path, damaged);
+            ProfileStore store;
+            store.create_profile("keep me", 1, "c", "d");
+            if (!ProfileSerializer::load(store, path)) CHECK(store_dump::dump(store) == before);
+        }
+    }
+}
+
+int main()
+{
+    const std::string dir = test_support::scratch_dir("snapshot");
+
+    // Large enough (> 1 MiB of text) for load_parallel to really split the file
+    ProfileStore original;
+    store_dump::fill(original, 40000, 1);
+
+    check_round_trip(original, dir + "/round.txt", SnapshotFormat::Text);
+    check_round_trip(original, dir + "/round.pmb", SnapshotFormat::Binary);
+    check_text_rules(dir);
+    check_parallel_duplicates(original, dir);
+    check_truncated_text(dir);
+    check_damaged_binary(dir);
+
+    std::filesystem::remove_all(dir);
+    return test_support::finish();
+}
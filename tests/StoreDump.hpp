@@ -0,0 +1,53 @@
+#ifndef PROFILEMANAGERCLI_STOREDUMP_HPP
+#define PROFILEMANAGERCLI_STOREDUMP_HPP
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "service/ProfileStore.hpp"
+
+// Helpers shared by the persistence tests: a canonical text dump of a store (every field, id order)
+// to compare stores with, and a generator of awkward profiles.
+namespace store_dump
+{
+    inline std::string dump(const Profile& p)
+    {
+        std::ostringstream out;
+        out << p.id() << "|" << p.age() << "|" << p.name() << "|" << p.city() << "|" << p.country() << "|";
+        for (const std::string& hobby : p.hobbies()) out << hobby << ",";
+        return out.str();
+    }
+
+    inline std::string dump(const ProfileStore& store)
+    {
+        std::ostringstream out;
+        out << store.size() << " profiles\n";
+        store.for_each_ordered([&](const Profile& p) { out << dump(p) << "\n"; });
+        return out.str();
+    }
+
+    // Text with the bytes the formats have to escape mixed in
+    inline std::string awkward_text(std::mt19937& rng)
+    {
+        static const char* const pieces[] = {"Oslo", "a|b", "tab\there", "line\nbreak", "back\\slash", "Åse", "x"};
+        std::string s = pieces[rng() % 7];
+        if (rng() % 3 == 0) s += pieces[rng() % 7];
+        return s;
+    }
+
+    // `count` profiles with ids 1..count, some text awkward, 0-3 hobbies each
+    inline void fill(ProfileStore& store, std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const int id = store.create_profile(awkward_text(rng), static_cast<int>(rng() % 100), awkward_text(rng),
+                                                rng() % 2 ? "Norway" : "France");
+            Profile* p = store.find(id);
+            for (std::size_t h = rng() % 4; h > 0; --h) p->add_hobby(awkward_text(rng));
+        }
+    }
+}
+
+#endif //PROFILEMANAGERCLI_STOREDUMP_HPP
@@ -0,0 +1,55 @@
+#ifndef PROFILEMANAGERCLI_TESTSUPPORT_HPP
+#define PROFILEMANAGERCLI_TESTSUPPORT_HPP
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Minimal test helpers: every test is a plain executable registered with ctest (see CMakeLists.txt).
+// CHECK records a failure and keeps going, so one run reports every broken case;
+// main returns test_support::finish() and ctest treats a non-zero exit as a failed test.
+namespace test_support
+{
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& what)
+    {
+        ++failures();
+        std::cerr << file << ":" << line << ": CHECK failed: " << what << "\n";
+    }
+
+    inline int finish()
+    {
+        if (failures() == 0) std::cout << "ok\n";
+        else std::cout << failures() << " check(s) failed\n";
+        return failures() == 0 ? 0 : 1;
+    }
+
+    // Fresh empty directory under the system temp dir, for tests that write files
+    inline std::string scratch_dir(const std::string& name)
+    {
+        const std::filesystem::path dir = std::filesystem::temp_directory_path() / ("pmcli_test_" + name);
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir.string();
+    }
+}
+
+#define CHECK(condition) \
+    do { if (!(condition)) test_support::fail(__FILE__, __LINE__, #condition); } while (false)
+
+// Like CHECK, with extra context printed on failure (anything streamable)
+#define CHECK_MSG(condition, message) \
+    do { \
+        if (!(condition)) \
+        { \
+            std::cerr << "  " << message << "\n"; \
+            test_support::fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (false)
+
+#endif //PROFILEMANAGERCLI_TESTSUPPORT_HPP
@@ -0,0 +1,275 @@
+#include "TestSupport.hpp"
+#include "domain/Profile.hpp"
+#include "domain/StringPool.hpp"
+#include "persistence/TextRecords.hpp"
+#include "persistence/TextScan.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Differential test: every text_scan kernel level against the original byte-by-byte code.
+// The searches are compared directly; escaping, unescaping and hobby splitting are compared through
+// text_records (append_record / decode_line / add_hobbies), which is where they live.
+
+namespace
+{
+    // ---- Reference implementations (the scalar loops the kernels replaced) ----
+
+    const char* reference_find(const char* first, const char* last, const std::string& specials)
+    {
+        for (; first != last; ++first)
+        {
+            if (specials.find(*first) != std::string::npos) return first;
+        }
+        return last;
+    }
+
+    std::string reference_escape(const std::string& s)
+    {
+        std::string out;
+        for (char ch : s)
+        {
+            switch (ch)
+            {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '|': out += "\\|"; break;
+                default: out += ch; break;
+            }
+        }
+        return out;
+    }
+
+    std::string reference_unescape(const std::string& s)
+    {
+        std::string out;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            const char ch = s[i];
+            if (ch == '\\' && i + 1 < s.size())
+            {
+                switch (s[i + 1])
+                {
+                    case '\\': out += '\\'; ++i; break;
+                    case 't': out += '\t'; ++i; break;
+                    case 'n': out += '\n'; ++i; break;
+                    case '|': out += '|'; ++i; break;
+                    default: out += ch; break;
+                }
+            }
+            else
+            {
+                out += ch;
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::string> reference_split(const std::string& s)
+    {
+        std::vector<std::string> parts;
+        std::string current;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] == '\\' && i + 1 < s.size())
+            {
+                current.push_back(s[i]);
+                current.push_back(s[i + 1]);
+                ++i;
+                continue;
+            }
+            if (s[i] == '|')
+            {
+                parts.push_back(current);
+                current.clear();
+            }
+            else
+            {
+                current.push_back(s[i]);
+            }
+        }
+        parts.push_back(current);
+        return parts;
+    }
+
+    // Hobbies a loader keeps for an escaped hobby field (empty hobbies are refused by add_hobby)
+    std::vector<std::string> reference_hobbies(const std::string& field)
+    {
+        std::vector<std::string> hobbies;
+        if (field.empty()) return hobbies;
+        for (const std::string& token : reference_split(field))
+        {
+            std::string hobby = reference_unescape(token);
+            if (!hobby.empty()) hobbies.push_back(hobby);
+        }
+        return hobbies;
+    }
+
+    // ---- Inputs ----
+
+    const std::string escapable = "\\\t\n|";
+    const std::string pipe_or_backslash = "\\|";
+    const char interesting[] = {'|', '\\', '\n', '\t', '\r', 't', 'n', 'a'};
+
+    // Random text that is mostly plain with the bytes above sprinkled in
+    std::string random_text(std::mt19937& rng, std::size_t max_length)
+    {
+        std::string s(rng() % (max_length + 1), 'x');
+        for (char& ch : s)
+        {
+            if (rng() % 4 == 0) ch = interesting[rng() % sizeof(interesting)];
+            else ch = static_cast<char>('a' + rng() % 26);
+        }
+        return s;
+    }
+
+    // ---- Checks ----
+
+    // One special byte at every offset of a buffer long enough to cross several 16/32-byte blocks,
+    // searched from every start offset (aligned and unaligned) up to every end
+    void check_every_offset(const char* level)
+    {
+        const std::size_t length = 80;
+        for (char special : interesting)
+        {
+            for (std::size_t at = 0; at < length; ++at)
+            {
+                std::string buffer(length, 'a');
+                buffer[at] = special;
+                const char* base = buffer.data();
+                for (std::size_t first = 0; first <= 40; ++first)
+                {
+                    for (std::size_t last = first; last <= length; last += (last < 70 ? 1 : 5))
+                    {
+                        CHECK_MSG(text_scan::find_escapable(base + first, base + last) ==
+                                  reference_find(base + first, base + last, escapable),
+                                  level << " escapable at=" << at << " [" << first << "," << last << ")");
+                        CHECK_MSG(text_scan::find_pipe_or_backslash(base + first, base + last) ==
+                                  reference_find(base + first, base + last, pipe_or_backslash),
+                                  level << " pipe at=" << at << " [" << first << "," << last << ")");
+                    }
+                }
+            }
+        }
+    }
+
+    void check_random_searches(const char* level, std::mt19937& rng)
+    {
+        for (int round = 0; round < 20000; ++round)
+        {
+            const std::string s = random_text(rng, 100);
+            const std::size_t first = s.empty() ? 0 : rng() % (s.size() + 1);
+            const char* begin = s.data() + first;
+            const char* end = s.data() + s.size();
+            CHECK_MSG(text_scan::find_escapable(begin, end) == reference_find(begin, end, escapable), level);
+            CHECK_MSG(text_scan::find_pipe_or_backslash(begin, end) == reference_find(begin, end, pipe_or_backslash), level);
+        }
+    }
+
+    // Records written by append_record must equal the old escaping, and decode back to the original
+    void check_round_trip(const char* level, std::mt19937& rng)
+    {
+        StringPool strings;
+        text_records::RecordScratch scratch;
+        for (int round = 0; round < 5000; ++round)
+        {
+            const std::string name = random_text(rng, 70);
+            const std::string city = random_text(rng, 40);
+            const std::string country = random_text(rng, 40);
+            Profile p(7, name, 33, city, country, strings);
+            std::vector<std::string> hobbies;
+            for (std::size_t h = rng() % 5; h > 0; --h)
+            {
+                const std::string hobby = random_text(rng, 40);
+                if (p.add_hobby(hobby)) hobbies.push_back(hobby);
+            }
+
+            std::string expected_field;
+            for (std::size_t i = 0; i < hobbies.size(); ++i)
+            {
+                if (i > 0) expected_field += '|';
+                expected_field += reference_escape(hobbies[i]);
+            }
+            const std::string expected = "7\t33\t" + reference_escape(name) + "\t" + reference_escape(city) + "\t" +
+                                         reference_escape(country) + "\t" + expected_field + "\n";
+
+            std::string line;
+            text_records::append_record(line, p);
+            CHECK_MSG(line == expected, level << " record for name '" << name << "'");
+
+            int id = 0;
+            int age = 0;
+            std::string_view hobby_field;
+            const bool decoded = text_records::decode_line(std::string_view(line).substr(0, line.size() - 1),
+                                                           scratch, id, age, hobby_field);
+            CHECK_MSG(decoded, level);
+            if (!decoded) continue;
+            CHECK(id == 7 && age == 33);
+            CHECK_MSG(scratch.name == name && scratch.city == city && scratch.country == country, level);
+
+            Profile back(id, scratch.name, age, scratch.city, scratch.country, strings);
+            text_records::add_hobbies(hobby_field, scratch, back);
+            std::vector<std::string> got(back.hobbies().begin(), back.hobbies().end());
+            // A '\r' ending the last hobby is read as a CRLF line end, as it always was
+            if (!expected_field.empty() && expected_field.back() == '\r') expected_field.pop_back();
+            CHECK_MSG(got == reference_hobbies(expected_field), level << " hobbies of '" << std::string(hobby_field) << "'");
+        }
+    }
+
+    // Arbitrary (possibly badly escaped) fields decode exactly like the old unescape/split did
+    void check_raw_fields(const char* level, std::mt19937& rng)
+    {
+        StringPool strings;
+        text_records::RecordScratch scratch;
+        const char raw[] = {'|', '\\', 't', 'n', 'a', 'b', '\r', ' '};
+        for (int round = 0; round < 20000; ++round)
+        {
+            std::string name(rng() % 70, 'a');
+            std::string hobby_field(rng() % 70, 'a');
+            for (char& ch : name) ch = raw[rng() % sizeof(raw)];
+            for (char& ch : hobby_field) ch = raw[rng() % sizeof(raw)];
+            const std::string line = "1\t2\t" + name + "\tc\td\t" + hobby_field;
+
+            int id = 0;
+            int age = 0;
+            std::string_view field;
+            if (!text_records::decode_line(line, scratch, id, age, field))
+            {
+                CHECK_MSG(false, level << " line rejected");
+                continue;
+            }
+            // decode_line strips one trailing '\r' from the whole line (CRLF files), like the original loader
+            std::string expected_field = hobby_field;
+            if (!expected_field.empty() && expected_field.back() == '\r') expected_field.pop_back();
+            CHECK_MSG(scratch.name == reference_unescape(name), level << " name '" << name << "'");
+
+            Profile p(id, "x", age, "c", "d", strings);
+            text_records::add_hobbies(field, scratch, p);
+            std::vector<std::string> got(p.hobbies().begin(), p.hobbies().end());
+            CHECK_MSG(got == reference_hobbies(expected_field), level << " hobby field '" << hobby_field << "'");
+        }
+    }
+}
+
+int main()
+{
+    for (text_scan::Level level : {text_scan::Level::Scalar, text_scan::Level::SSE2, text_scan::Level::AVX2})
+    {
+        text_scan::set_level(level);
+        const char* name = text_scan::level_name(text_scan::active_level());
+        if (text_scan::active_level() != level)
+        {
+            std::cout << text_scan::level_name(level) << " not supported here, testing " << name << " instead\n";
+        }
+
+        std::mt19937 rng(static_cast<unsigned>(level) + 1);
+        check_every_offset(name);
+        check_random_searches(name, rng);
+        check_round_trip(name, rng);
+        check_raw_fields(name, rng);
+    }
+    text_scan::set_level(text_scan::best_level());
+    return test_support::finish();
+}
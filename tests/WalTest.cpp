@@ -0,0 +1,327 @@
+#include "StoreDump.hpp"
+#include "TestSupport.hpp"
+#include "persistence/WriteAheadLog.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// WriteAheadLog: replay after reopen (every record kind), a log cut anywhere (torn tail dropped, appends
+// continue after the last good record), group commit (sync() and close() do not wait out the window),
+// compaction carrying over the records that arrive while it runs, and a crash between writing the new
+// snapshot and the rename that commits it.
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t header_size = 20; // magic + generation + name length, then the base name
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_file(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    // Generation field of the log header
+    std::uint64_t generation_of(const std::string& path)
+    {
+        const std::string bytes = read_file(path);
+        if (bytes.size() < header_size) return 0;
+        std::uint64_t generation = 0;
+        for (int i = 7; i >= 0; --i) generation = (generation << 8) | static_cast<unsigned char>(bytes[8 + i]);
+        return generation;
+    }
+
+    // Replays the log into a fresh store
+    std::string replay(const std::string& path, std::size_t* records = nullptr)
+    {
+        ProfileStore store;
+        WriteAheadLog log;
+        if (!log.open(path, store)) return "open failed";
+        if (records) *records = log.replayed_records();
+        log.close();
+        return store_dump::dump(store);
+    }
+
+    // One mutation of any kind the log records
+    void mutate(ProfileStore& store, std::mt19937& rng)
+    {
+        const int id = 1 + static_cast<int>(rng() % 60);
+        Profile* p = store.find(id);
+        switch (rng() % 9)
+        {
+            case 0:
+            case 1: store.create_profile(store_dump::awkward_text(rng), static_cast<int>(rng() % 90),
+                                         store_dump::awkward_text(rng), "Norway"); break;
+            case 2: store.remove(id); break;
+            case 3: if (p) p->set_name(store_dump::awkward_text(rng)); break;
+            case 4: if (p) p->set_age(static_cast<int>(rng() % 90)); break;
+            case 5: if (p) p->set_city(store_dump::awkward_text(rng)); break;
+            case 6: if (p) p->set_country(store_dump::awkward_text(rng)); break;
+            case 7: if (p) p->add_hobby(store_dump::awkward_text(rng)); break;
+            default:
+                if (p && !p->hobbies().empty()) p->remove_hobby(p->hobbies()[0]);
+                break;
+        }
+    }
+
+    // A fresh log describes what the store already held; every later mutation (clear() included) replays
+    void check_replay(const std::string& dir)
+    {
+        const std::string path = dir + "/replay.wal";
+        ProfileStore store;
+        store_dump::fill(store, 30, 1);
+        {
+            WriteAheadLog log;
+            CHECK(log.open(path, store));
+            CHECK(log.replayed_records() == 0);
+            std::mt19937 rng(2);
+            for (int i = 0; i < 300; ++i) mutate(store, rng);
+            log.close();
+        }
+        std::size_t records = 0;
+        CHECK(replay(path, &records) == store_dump::dump(store));
+        CHECK(records > 30); // the 30 profiles it started with, then every mutation that changed something
+
+        // Reopened: whatever the store held is replaced, and new records go after the replayed ones
+        ProfileStore reopened;
+        reopened.create_profile("replaced by the replay", 1, "c", "d");
+        {
+            WriteAheadLog log;
+            CHECK(log.open(path, reopened));
+            CHECK(store_dump::dump(reopened) == store_dump::dump(store));
+            reopened.clear();
+            reopened.create_profile("after clear", 5, "Oslo", "Norway");
+            CHECK(log.sync());
+        }
+        CHECK(replay(path) == store_dump::dump(reopened));
+        CHECK(reopened.size() == 1);
+
+        // Not a log
+        write_file(dir + "/garbage.wal", "PMWAL9\n");
+        ProfileStore untouched;
+        WriteAheadLog log;
+        CHECK(!log.open(dir + "/garbage.wal", untouched));
+    }
+
+    // Cut anywhere, the log replays exactly its complete records and drops the rest from the file
+    void check_torn_tail(const std::string& dir)
+    {
+        const std::string path = dir + "/torn.wal";
+        ProfileStore store;
+        std::vector<std::string> states;   // states[i]: the store after the i-th batch
+        std::vector<std::uint64_t> ends;   // log size then
+        {
+            WriteAheadLog log;
+            CHECK(log.open(path, store));
+            states.push_back(store_dump::dump(store));
+            ends.push_back(log.log_bytes());
+            std::mt19937 rng(3);
+            for (int batch = 0; batch < 40; ++batch)
+            {
+                mutate(store, rng);
+                CHECK(log.sync());
+                states.push_back(store_dump::dump(store));
+                ends.push_back(log.log_bytes());
+            }
+        }
+        const std::string bytes = read_file(path);
+        CHECK(bytes.size() == ends.back());
+
+        const std::string cut_path = dir + "/cut.wal";
+        for (std::size_t cut = ends.front(); cut < bytes.size(); ++cut)
+        {
+            std::size_t batch = 0;
+            while (batch + 1 < ends.size() && ends[batch + 1] <= cut) ++batch;
+            write_file(cut_path, bytes.substr(0, cut));
+            CHECK_MSG(replay(cut_path) == states[batch], "cut at " << cut);
+            CHECK_MSG(std::filesystem::file_size(cut_path) == ends[batch], "cut at " << cut);
+        }
+
+        // A damaged byte in the last record drops just that record (batches that changed nothing wrote none)
+        std::string damaged = bytes;
+        damaged[damaged.size() - 1] = static_cast<char>(damaged[damaged.size() - 1] ^ 0x5a);
+        write_file(cut_path, damaged);
+        std::size_t before_last = ends.size() - 1;
+        while (ends[before_last] == ends.back()) --before_last;
+        CHECK(replay(cut_path) == states[before_last]);
+
+        // Appending after a torn tail continues right after the last good record
+        write_file(cut_path, bytes.substr(0, (ends[20] + ends[21]) / 2));
+        ProfileStore resumed;
+        {
+            WriteAheadLog log;
+            CHECK(log.open(cut_path, resumed));
+            CHECK(store_dump::dump(resumed) == states[20]);
+            resumed.create_profile("after the tear", 1, "c", "d");
+        }
+        CHECK(replay(cut_path) == store_dump::dump(resumed));
+    }
+
+    // sync() and close() cut a long group-commit window short; records are never lost by closing
+    void check_group_commit(const std::string& dir)
+    {
+        const std::string path = dir + "/group.wal";
+        WalOptions options;
+        options.commit_interval = std::chrono::milliseconds(3000);
+        ProfileStore store;
+        {
+            WriteAheadLog log(options);
+            CHECK(log.open(path, store));
+            for (int i = 0; i < 100; ++i) store.create_profile("p" + std::to_string(i), i, "c", "d");
+
+            auto started = Clock::now();
+            CHECK(log.sync());
+            CHECK(Clock::now() - started < std::chrono::milliseconds(1500));
+            CHECK(log.log_bytes() == std::filesystem::file_size(path));
+            CHECK(replay(path) == store_dump::dump(store));
+
+            store.find(7)->set_age(70);
+            started = Clock::now();
+            log.close();
+            CHECK(Clock::now() - started < std::chrono::milliseconds(1500));
+        }
+        CHECK(replay(path) == store_dump::dump(store));
+    }
+
+    // Records that arrive while a compaction folds the log are carried over into the new log
+    void check_compaction(const std::string& dir)
+    {
+        const std::string path = dir + "/compact.wal";
+        ProfileStore store;
+        store_dump::fill(store, 20000, 4); // enough for the fold to take a while
+        std::mt19937 rng(5);
+        {
+            WriteAheadLog log(WalOptions{std::chrono::milliseconds(1), 0});
+            CHECK(log.open(path, store));
+            for (int i = 0; i < 200; ++i) mutate(store, rng);
+            CHECK(log.sync());
+
+            CHECK(log.compact());
+            // Keep logging until the new log is in place, so some records land after the folded part
+            std::size_t during = 0;
+            while (generation_of(path) == 0 && during < 1000000)
+            {
+                mutate(store, rng);
+                CHECK(log.sync());
+                ++during;
+            }
+            log.wait_for_compaction();
+            CHECK(generation_of(path) == 1);
+            CHECK(std::filesystem::exists(path + ".snap1"));
+            CHECK(during > 0);
+            CHECK(log.log_bytes() > header_size + std::string("compact.wal.snap1").size()); // a carried-over tail
+
+            for (int i = 0; i < 50; ++i) mutate(store, rng);
+            CHECK(log.sync());
+        }
+        std::size_t records = 0;
+        CHECK(replay(path, &records) == store_dump::dump(store));
+        CHECK(records < 200 + 50 + 1000000);
+
+        // A second compaction replaces the first snapshot
+        {
+            ProfileStore reopened;
+            WriteAheadLog log;
+            CHECK(log.open(path, reopened));
+            CHECK(log.compact());
+            log.wait_for_compaction();
+        }
+        CHECK(generation_of(path) == 2);
+        CHECK(std::filesystem::exists(path + ".snap2") && !std::filesystem::exists(path + ".snap1"));
+        CHECK(replay(path, &records) == store_dump::dump(store));
+        CHECK(records == 0);
+
+        // Automatic compaction once the log passes the threshold
+        const std::string auto_path = dir + "/auto.wal";
+        ProfileStore automatic;
+        {
+            WriteAheadLog log(WalOptions{std::chrono::milliseconds(1), 4096});
+            CHECK(log.open(auto_path, automatic));
+            for (int i = 0; i < 2000; ++i)
+            {
+                mutate(automatic, rng);
+                if (i % 50 == 0) CHECK(log.sync());
+            }
+        }
+        CHECK(generation_of(auto_path) > 0);
+        CHECK(replay(auto_path) == store_dump::dump(automatic));
+    }
+
+    // Crash after the new snapshot is written but before the rename: the old log and its snapshot are
+    // still the current pair, and the leftovers of the interrupted compaction do not get in the way
+    void check_crash_before_rename(const std::string& dir)
+    {
+        const std::string path = dir + "/crash.wal";
+        ProfileStore store;
+        store_dump::fill(store, 500, 6);
+        std::mt19937 rng(7);
+        {
+            WriteAheadLog log;
+            CHECK(log.open(path, store));
+            CHECK(log.compact());
+            log.wait_for_compaction();
+            for (int i = 0; i < 100; ++i) mutate(store, rng);
+            CHECK(log.sync());
+        }
+        CHECK(generation_of(path) == 1);
+        const std::string old_log = read_file(path);
+        const std::string old_snapshot = read_file(path + ".snap1");
+        const std::string expected = store_dump::dump(store);
+
+        {
+            ProfileStore reopened;
+            WriteAheadLog log;
+            CHECK(log.open(path, reopened));
+            CHECK(log.compact());
+            log.wait_for_compaction();
+        }
+        CHECK(generation_of(path) == 2);
+
+        // Back to the state just before the rename: old log, old snapshot, new snapshot, half-written temp log
+        write_file(path, old_log);
+        write_file(path + ".snap1", old_snapshot);
+        write_file(path + ".tmp", old_log.substr(0, old_log.size() / 3));
+        CHECK(std::filesystem::exists(path + ".snap2"));
+        CHECK(replay(path) == expected);
+
+        // Compacting again from there commits cleanly over the leftovers
+        ProfileStore recovered;
+        {
+            WriteAheadLog log;
+            CHECK(log.open(path, recovered));
+            CHECK(log.compact());
+            log.wait_for_compaction();
+            recovered.create_profile("after recovery", 1, "c", "d");
+        }
+        CHECK(generation_of(path) == 2);
+        CHECK(!std::filesystem::exists(path + ".snap1") && !std::filesystem::exists(path + ".tmp"));
+        CHECK(replay(path) == store_dump::dump(recovered));
+        CHECK(store_dump::dump(recovered) != expected);
+    }
+}
+
+int main()
+{
+    const std::string dir = test_support::scratch_dir("wal");
+    check_replay(dir);
+    check_torn_tail(dir);
+    check_group_commit(dir);
+    check_compaction(dir);
+    check_crash_before_rename(dir);
+    std::filesystem::remove_all(dir);
+    return test_support::finish();
+}